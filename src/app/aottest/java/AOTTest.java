@@ -0,0 +1,232 @@
+/*
+ * AOTTest.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import javax.darjeeling.aottest.AOTKernels;
+
+/**
+ * Checks the C code the infuser generates for the aottest library (built with aotCompile = true) against the
+ * interpreter. Application infusions are never compiled, so this class holds an interpreted copy of each kernel in
+ * AOTKernels; both are run on the same arguments and must give the same result or throw the same exception. Every
+ * line should end in "ok". The loop kernel is also timed both ways.
+ *
+ * Run it on a config with EXECUTION_AOT defined, with app = 'aottest' in the config's sub.gradle. Without
+ * EXECUTION_AOT both sides are interpreted, so it passes trivially.
+ */
+public class AOTTest
+{
+	private static final int ITERATIONS = 20000;
+
+	private static int failures = 0;
+	private static int counter;
+
+	private static void check(String name, long value, long expected)
+	{
+		System.out.print(name);
+		if (value==expected)
+			System.out.println(": ok");
+		else
+		{
+			System.out.print(": FAILED, got ");
+			System.out.print(String.valueOf(value));
+			System.out.print(", expected ");
+			System.out.println(String.valueOf(expected));
+			failures++;
+		}
+	}
+
+	private static int loop(int n)
+	{
+		int a = 0, b = 1;
+		for (int i=0; i<n; i++)
+		{
+			a += b ^ i;
+			b = (b << 1) | (a & 1);
+		}
+		return a + b;
+	}
+
+	private static short shorts(short a, short b)
+	{
+		short r = (short)(a * b + (a >> 2) - (b << 3));
+		r ^= (short)(a >>> 1);
+		if (b != 0)
+			r += (short)(a / b + a % b);
+		return (short)-r;
+	}
+
+	private static long longs(long a, int n)
+	{
+		long r = 1;
+		for (int i=0; i<n; i++)
+		{
+			r = r * 31 + (a >>> (i & 63)) - (a << 3);
+			if (r < a)
+				r ^= a;
+		}
+		return r;
+	}
+
+	private static int conversions(int a)
+	{
+		byte b = (byte)a;
+		char c = (char)a;
+		short s = (short)a;
+		long l = (long)a * 100000;
+		return b + c + s + (int)(l >> 16);
+	}
+
+	private static int select(int k)
+	{
+		switch (k)
+		{
+			case 0: return 10;
+			case 1: return 11;
+			case 2: return 12;
+			case 3: return 13;
+			default: break;
+		}
+		switch (k)
+		{
+			case -1000: return 1;
+			case 7: return 2;
+			case 100000: return 3;
+			default: return -1;
+		}
+	}
+
+	private static int sum(int[] a)
+	{
+		int s = 0;
+		for (int i=0; i<a.length; i++)
+			s += a[i];
+		return s;
+	}
+
+	private static void fill(byte[] a, byte value)
+	{
+		for (int i=0; i<a.length; i++)
+			a[i] = (byte)(value + i);
+	}
+
+	private static int bump(int d)
+	{
+		counter += d;
+		return counter;
+	}
+
+	// exception codes for checkThrows, so the results can be compared as numbers
+	private static final int NONE = 0, ARITHMETIC = 1, NULL_POINTER = 2, INDEX = 3;
+
+	private static int divideThrows(boolean compiled, int a, int b)
+	{
+		try
+		{
+			if (compiled) AOTKernels.divide(a, b); else { int r = a / b; }
+			return NONE;
+		} catch (ArithmeticException e)
+		{
+			return ARITHMETIC;
+		}
+	}
+
+	private static int sumThrows(boolean compiled, int[] a)
+	{
+		try
+		{
+			if (compiled) AOTKernels.sum(a); else sum(a);
+			return NONE;
+		} catch (NullPointerException e)
+		{
+			return NULL_POINTER;
+		}
+	}
+
+	private static int getThrows(boolean compiled, int[] a, int i)
+	{
+		try
+		{
+			if (compiled) AOTKernels.get(a, i); else { int r = a[i]; }
+			return NONE;
+		} catch (IndexOutOfBoundsException e)
+		{
+			return INDEX;
+		}
+	}
+
+	private static void report(String name, long start)
+	{
+		long time = System.currentTimeMillis() - start;
+		System.out.print(name);
+		System.out.print(": ");
+		System.out.print(String.valueOf(time));
+		System.out.println(" ms");
+	}
+
+	public static void main(String args[])
+	{
+		int i;
+		long start;
+		int[] ints = new int[16];
+		byte[] compiledBytes = new byte[16], interpretedBytes = new byte[16];
+
+		for (i=0; i<ints.length; i++)
+			ints[i] = i * 40000 - 300000;
+
+		check("loop", AOTKernels.loop(1000), loop(1000));
+		check("shorts", AOTKernels.shorts((short)-12345, (short)77), shorts((short)-12345, (short)77));
+		check("shorts, zero divisor", AOTKernels.shorts((short)32767, (short)0), shorts((short)32767, (short)0));
+		check("longs", AOTKernels.longs(5000000000L, 100), longs(5000000000L, 100));
+		check("conversions", AOTKernels.conversions(-123456789), conversions(-123456789));
+		check("conversions, positive", AOTKernels.conversions(98765), conversions(98765));
+		for (i=-2; i<9; i++)
+			check("tableswitch", AOTKernels.select(i), select(i));
+		check("lookupswitch", AOTKernels.select(-1000), select(-1000));
+		check("lookupswitch, int key", AOTKernels.select(100000), select(100000));
+		check("array sum", AOTKernels.sum(ints), sum(ints));
+
+		AOTKernels.fill(compiledBytes, (byte)120);
+		fill(interpretedBytes, (byte)120);
+		for (i=0; i<compiledBytes.length; i++)
+			check("array fill", compiledBytes[i], interpretedBytes[i]);
+
+		AOTKernels.counter = 0;
+		counter = 0;
+		AOTKernels.bump(70000);
+		bump(70000);
+		check("static field", AOTKernels.bump(-3), bump(-3));
+
+		check("division by zero", divideThrows(true, 1, 0), divideThrows(false, 1, 0));
+		check("division", AOTKernels.divide(-7, 2), -7 / 2);
+		check("null array", sumThrows(true, null), sumThrows(false, null));
+		check("index out of bounds", getThrows(true, ints, 16), getThrows(false, ints, 16));
+		check("negative index", getThrows(true, ints, -1), getThrows(false, ints, -1));
+
+		start = System.currentTimeMillis();
+		AOTKernels.loop(ITERATIONS);
+		report("loop compiled", start);
+
+		start = System.currentTimeMillis();
+		loop(ITERATIONS);
+		report("loop interpreted", start);
+
+		System.out.println(failures==0 ? "aottest passed" : "aottest FAILED");
+	}
+}
@@ -0,0 +1,211 @@
+/*
+ * ArrayBench.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import javax.darjeeling.Arrays;
+
+/**
+ * Compares the bulk array natives in javax.darjeeling.Arrays against the
+ * equivalent Java loops. Each pair of kernels runs over the same data and
+ * should print the same result; only the elapsed time should differ.
+ *
+ * To run it on the native config, set app = 'arraybench' in
+ * config/native/sub.gradle, run gradle -b ../../build.gradle from
+ * config/native, and start build/native/darjeeling/darjeeling.elf. The java
+ * line of each pair is the time before the natives, the native line the time
+ * with them.
+ */
+public class ArrayBench
+{
+	private static final int LENGTH = 256;
+	private static final int REPEAT = 50;
+
+	private static int javaFill(byte[] a)
+	{
+		for (int r=0; r<REPEAT; r++)
+			for (int i=0; i<a.length; i++)
+				a[i] = (byte)r;
+		return a[a.length - 1];
+	}
+
+	private static int nativeFill(byte[] a)
+	{
+		for (int r=0; r<REPEAT; r++)
+			Arrays.fill(a, (byte)r);
+		return a[a.length - 1];
+	}
+
+	private static int javaSum(short[] a)
+	{
+		int s = 0;
+		for (int r=0; r<REPEAT; r++)
+			for (int i=0; i<a.length; i++)
+				s += a[i];
+		return s;
+	}
+
+	private static int nativeSum(short[] a)
+	{
+		int s = 0;
+		for (int r=0; r<REPEAT; r++)
+			s += Arrays.sum(a, 0, a.length);
+		return s;
+	}
+
+	private static int javaMax(int[] a)
+	{
+		int m = 0;
+		for (int r=0; r<REPEAT; r++)
+		{
+			m = a[0];
+			for (int i=1; i<a.length; i++)
+				if (a[i] > m) m = a[i];
+		}
+		return m;
+	}
+
+	private static int nativeMax(int[] a)
+	{
+		int m = 0;
+		for (int r=0; r<REPEAT; r++)
+			m = Arrays.max(a, 0, a.length);
+		return m;
+	}
+
+	private static int javaIndexOf(byte[] a, byte v)
+	{
+		int idx = -1;
+		for (int r=0; r<REPEAT; r++)
+		{
+			idx = -1;
+			for (int i=0; i<a.length; i++)
+				if (a[i] == v) { idx = i; break; }
+		}
+		return idx;
+	}
+
+	private static int nativeIndexOf(byte[] a, byte v)
+	{
+		int idx = -1;
+		for (int r=0; r<REPEAT; r++)
+			idx = Arrays.indexOf(a, v);
+		return idx;
+	}
+
+	private static int javaEquals(int[] a, int[] b)
+	{
+		int n = 0;
+		for (int r=0; r<REPEAT; r++)
+		{
+			boolean eq = a.length == b.length;
+			for (int i=0; eq && i<a.length; i++)
+				eq = a[i] == b[i];
+			if (eq) n++;
+		}
+		return n;
+	}
+
+	private static int nativeEquals(int[] a, int[] b)
+	{
+		int n = 0;
+		for (int r=0; r<REPEAT; r++)
+			if (Arrays.equals(a, b)) n++;
+		return n;
+	}
+
+	private static int javaDot(short[] a, short[] b)
+	{
+		int s = 0;
+		for (int r=0; r<REPEAT; r++)
+			for (int i=0; i<a.length; i++)
+				s += a[i] * b[i];
+		return s;
+	}
+
+	private static int nativeDot(short[] a, short[] b)
+	{
+		int s = 0;
+		for (int r=0; r<REPEAT; r++)
+			s += Arrays.dot(a, b);
+		return s;
+	}
+
+	private static void report(String name, long start, int result)
+	{
+		long time = System.currentTimeMillis() - start;
+		System.out.print(name);
+		System.out.print(": ");
+		System.out.print(String.valueOf(time));
+		System.out.print(" ms (");
+		System.out.print(String.valueOf(result));
+		System.out.println(")");
+	}
+
+	public static void main(String args[])
+	{
+		long start;
+
+		byte[] bytes = new byte[LENGTH];
+		short[] shorts = new short[LENGTH];
+		short[] shorts2 = new short[LENGTH];
+		int[] ints = new int[LENGTH];
+		int[] ints2 = new int[LENGTH];
+
+		for (int i=0; i<LENGTH; i++)
+		{
+			shorts[i] = (short)(i * 31 - 4000);
+			shorts2[i] = (short)(LENGTH - i);
+			ints[i] = i * 7919 - 100000;
+			ints2[i] = ints[i];
+		}
+
+		start = System.currentTimeMillis();
+		report("fill byte java", start, javaFill(bytes));
+		start = System.currentTimeMillis();
+		report("fill byte native", start, nativeFill(bytes));
+
+		bytes[LENGTH - 2] = 42;
+
+		start = System.currentTimeMillis();
+		report("indexOf byte java", start, javaIndexOf(bytes, (byte)42));
+		start = System.currentTimeMillis();
+		report("indexOf byte native", start, nativeIndexOf(bytes, (byte)42));
+
+		start = System.currentTimeMillis();
+		report("sum short java", start, javaSum(shorts));
+		start = System.currentTimeMillis();
+		report("sum short native", start, nativeSum(shorts));
+
+		start = System.currentTimeMillis();
+		report("dot short java", start, javaDot(shorts, shorts2));
+		start = System.currentTimeMillis();
+		report("dot short native", start, nativeDot(shorts, shorts2));
+
+		start = System.currentTimeMillis();
+		report("max int java", start, javaMax(ints));
+		start = System.currentTimeMillis();
+		report("max int native", start, nativeMax(ints));
+
+		start = System.currentTimeMillis();
+		report("equals int java", start, javaEquals(ints, ints2));
+		start = System.currentTimeMillis();
+		report("equals int native", start, nativeEquals(ints, ints2));
+	}
+}
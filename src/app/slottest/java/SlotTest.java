@@ -0,0 +1,82 @@
+/*
+ * SlotTest.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Checks the integer stack instructions that shuffle slots (IDUP_X1, IDUP_X2 and IDUP_X) with values that don't
+ * fit in 16 bits. With EXECUTION_32BIT_SLOTS an int takes one slot, so the infuser emits the short forms for ints
+ * that need the whole slot to be moved. Run it on a config with EXECUTION_32BIT_SLOTS and slotWidth = 32, and on a
+ * default config; every line should end in "ok".
+ */
+public class SlotTest
+{
+	private static int failures = 0;
+
+	private static void check(String name, long value, long expected)
+	{
+		System.out.print(name);
+		if (value==expected)
+			System.out.println(": ok");
+		else
+		{
+			System.out.print(": FAILED, got ");
+			System.out.print(String.valueOf(value));
+			System.out.print(", expected ");
+			System.out.println(String.valueOf(expected));
+			failures++;
+		}
+	}
+
+	public static void main(String args[])
+	{
+		int[] a = new int[4];
+		long[] la = new long[4];
+		int i = 1, j = 2, y, z;
+		long ly;
+
+		// dup_x2 over an array reference and an int index
+		y = a[i] = 100000;
+		check("array store result", y, 100000);
+		check("array store", a[i], 100000);
+
+		y = a[i] = -70000;
+		check("negative array store result", y, -70000);
+
+		// dup_x2 on the value loaded by a post increment of an array element
+		a[j] = 65535;
+		y = a[j]++;
+		check("array post increment result", y, 65535);
+		check("array post increment", a[j], 65536);
+
+		z = ++a[j];
+		check("array pre increment result", z, 65537);
+
+		// chained stores
+		a[0] = a[3] = 123456;
+		check("chained array store", a[0] + a[3], 246912);
+
+		// dup2_x2 of a long over an int index
+		ly = la[i] = 5000000000L;
+		check("long array store result", ly, 5000000000L);
+		check("long array store", la[i], 5000000000L);
+
+		System.out.println(failures==0 ? "slottest passed" : "slottest FAILED");
+	}
+}
@@ -0,0 +1,155 @@
+/*
+ * VMBench.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Small interpreter micro benchmarks. Each kernel is run for a fixed number
+ * of iterations and the elapsed wall clock time is printed, so that different
+ * VM build options (dispatch mode, caches, etc.) can be compared on the same
+ * platform.
+ *
+ * To run it on the native config, set app = 'vmbench' in
+ * config/native/sub.gradle, run gradle -b ../../build.gradle from
+ * config/native, and start build/native/darjeeling/darjeeling.elf. To compare
+ * an option, rebuild with it toggled in config/native/include/config.h (for
+ * example EXECUTION_THREADED_DISPATCH) and run again. The result in brackets
+ * must not change between builds.
+ */
+public class VMBench
+{
+	private static final int ITERATIONS = 20000;
+
+	private static int loopKernel(int n)
+	{
+		int a = 0, b = 1;
+		for (int i=0; i<n; i++)
+		{
+			a += b ^ i;
+			b = (b << 1) | (a & 1);
+		}
+		return a + b;
+	}
+
+	private static int add(int a, int b)
+	{
+		return a + b;
+	}
+
+	/**
+	 * Creates, enters and leaves a frame per iteration, so the time is mostly
+	 * frame setup, loading the callee's local state and returning.
+	 */
+	private static int callKernel(int n)
+	{
+		int r = 0;
+		for (int i=0; i<n; i++)
+			r = add(r, i);
+		return r;
+	}
+
+	private static class Shape
+	{
+		public int area() { return 0; }
+	}
+
+	private static class Square extends Shape
+	{
+		private int side;
+		public Square(int side) { this.side = side; }
+		public int area() { return side * side; }
+	}
+
+	private static class Rect extends Shape
+	{
+		private int w, h;
+		public Rect(int w, int h) { this.w = w; this.h = h; }
+		public int area() { return w * h; }
+	}
+
+	private static int virtualKernel(int n)
+	{
+		Shape a = new Square(3);
+		Shape b = new Rect(2, 5);
+		int r = 0;
+		for (int i=0; i<n; i++)
+			r += a.area() + b.area();
+		return r;
+	}
+
+	private static class Node
+	{
+		public Node next;
+	}
+
+	private static final int GC_LIST_LENGTH = 64;
+	private static final int GC_ROUNDS = 50;
+
+	/**
+	 * Collects the heap repeatedly while a linked list is live. Marking a
+	 * list takes one visit per node with GC_MARK_STACK, and up to one sweep of the
+	 * heap per node without it.
+	 */
+	private static int gcKernel(int rounds)
+	{
+		Node head = null;
+		for (int i=0; i<GC_LIST_LENGTH; i++)
+		{
+			Node node = new Node();
+			node.next = head;
+			head = node;
+		}
+
+		for (int i=0; i<rounds; i++)
+			System.gc();
+
+		int r = 0;
+		for (Node node=head; node!=null; node=node.next)
+			r++;
+		return r;
+	}
+
+	private static void report(String name, long start, int result)
+	{
+		long time = System.currentTimeMillis() - start;
+		System.out.print(name);
+		System.out.print(": ");
+		System.out.print(String.valueOf(time));
+		System.out.print(" ms (");
+		System.out.print(String.valueOf(result));
+		System.out.println(")");
+	}
+
+	public static void main(String args[])
+	{
+		long start;
+
+		start = System.currentTimeMillis();
+		report("loop", start, loopKernel(ITERATIONS));
+
+		start = System.currentTimeMillis();
+		report("call", start, callKernel(ITERATIONS));
+
+		start = System.currentTimeMillis();
+		report("virtual", start, virtualKernel(ITERATIONS));
+
+		start = System.currentTimeMillis();
+		report("gc", start, gcKernel(GC_ROUNDS));
+	}
+}
@@ -33,7 +33,7 @@
 
 typedef uint16_t ref_t;
 
-extern char * ref_t_base_address;
+extern DJ_VM_LOCAL char * ref_t_base_address;
 
 // ref_t is now  only 16-bits wide for everyone. Thus,  we need a base
 // address  to resolve  ref_t references  into 32-bits  pointers. This
@@ -31,22 +31,26 @@
 // The null java reference
 #define nullref ((ref_t)0)
 
+#ifdef HEAP_32BIT
+typedef uint32_t ref_t;
+#else
 typedef uint16_t ref_t;
+#endif
 
-extern char * ref_t_base_address;
+extern DJ_VM_LOCAL char * ref_t_base_address;
 
-// ref_t is now  only 16-bits wide for everyone. Thus,  we need a base
+// ref_t is  16-bits wide unless HEAP_32BIT is defined. Thus,  we need a base
 // address  to resolve  ref_t references  into 32-bits  pointers. This
 // pointer is  actually declared in linux/main.c, and  assigned to the
 // base address  of the heap *minus  a small quantity* to  allow us to
 // distinguish  between null references  (ref_t ==  0) and  "the first
 // object of the heap"
 
-static inline void* REF_TO_VOIDP(ref_t ref) {return (ref != nullref ? (void*)((uint16_t)ref + ref_t_base_address) : NULL ) ;}
-static inline ref_t VOIDP_TO_REF(void* ref) {return (ref != NULL ? (uint16_t)((char*)ref - ref_t_base_address) : nullref ) ;}
+static inline void* REF_TO_VOIDP(ref_t ref) {return (ref != nullref ? (void*)((ref_t)ref + ref_t_base_address) : NULL ) ;}
+static inline ref_t VOIDP_TO_REF(void* ref) {return (ref != NULL ? (ref_t)((char*)ref - ref_t_base_address) : nullref ) ;}
 
 #define REF_TO_UINT32(ref) ((uint32_t)ref)
-#define UINT32_TO_REF(ref) ((uint16_t)ref)
+#define UINT32_TO_REF(ref) ((ref_t)ref)
 
 
 #endif // __pointerwidth_h
@@ -32,6 +32,7 @@
 #include "djarchive.h"
 #include "wkpf_main.h"
 #include "posix_utils.h"
+#include "posix_poll.h"
 
 int main(int argc,char* argv[])
 {
@@ -41,10 +42,11 @@ int main(int argc,char* argv[])
 	di_app_archive = posix_load_infusion_archive(posix_app_infusion_filename);
 
 	// initialise memory manager
-	void *mem = malloc(HEAPSIZE);
+	void *mem = malloc(posix_heap_size);
 	ref_t_base_address = (char*)mem - 42;
 
-	core_init(mem, HEAPSIZE);
+	core_init(mem, posix_heap_size);
+	posix_poll_init();
 	dj_exec_setRunlevel(RUNLEVEL_RUNNING);
 	wkpf_picokong(di_app_archive);
 
@@ -20,11 +20,16 @@
  */
  
 
+#define _GNU_SOURCE // for pthread_setaffinity_np
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <getopt.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "core.h"
 #include "types.h"
@@ -33,14 +38,82 @@
 #include "djarchive.h"
 
 #include "posix_utils.h"
+#include "posix_poll.h"
 
 // From GENERATEDlibinit.c, which is generated during build based on the libraries in this config's libs.
 extern dj_named_native_handler java_library_native_handlers[];
 extern uint8_t java_library_native_handlers_length;
 
 // di_app_archive is defined in djarchive.c
+// The lib archive is never written to, so all nodes share the same copy
 dj_di_pointer di_lib_archive;
 
+static void run_node()
+{
+	// Read the app infusion archive from file
+	di_app_archive = posix_load_infusion_archive(posix_app_infusion_filename);
+
+	// initialise memory manager
+	void *mem = malloc(posix_heap_size);
+	ref_t_base_address = (char*)mem - 42;
+
+	core_init(mem, posix_heap_size);
+	posix_poll_init();
+	dj_vm_main(di_lib_archive, di_app_archive, java_library_native_handlers, java_library_native_handlers_length);
+
+	// Listen to the radio
+	while(true) {
+		dj_hook_call(dj_core_pollingHook, NULL);
+		dj_core_idle(-1);
+	}
+}
+
+#ifdef DJ_MULTI_VM
+// Settings parsed from the command line by the main thread. The per node copies
+// of these globals are thread local, so each node thread starts from these.
+static uint32_t first_network_id;
+static bool arg_addnode;
+
+static void *node_thread(void *arg)
+{
+	int node = (int)(intptr_t)arg;
+
+	posix_local_network_id = first_network_id + node;
+	posix_arg_addnode = arg_addnode;
+	posix_determine_app_archive_and_config_file();
+
+	run_node();
+	return NULL;
+}
+
+static void run_nodes()
+{
+	pthread_t threads[posix_nr_nodes];
+	long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nr_cpus < 1)
+		nr_cpus = 1;
+
+	first_network_id = posix_local_network_id;
+	arg_addnode = posix_arg_addnode;
+
+	for (int i=0; i<posix_nr_nodes; i++) {
+		if (pthread_create(&threads[i], NULL, node_thread, (void *)(intptr_t)i) != 0) {
+			printf("Unable to start the thread for node %d.\n", i);
+			exit(1);
+		}
+
+		// Keep each node on one core so its VM state stays in that core's cache
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(i % nr_cpus, &cpus);
+		pthread_setaffinity_np(threads[i], sizeof(cpu_set_t), &cpus);
+	}
+
+	for (int i=0; i<posix_nr_nodes; i++)
+		pthread_join(threads[i], NULL);
+}
+#endif // DJ_MULTI_VM
+
 int main(int argc,char* argv[])
 {
 	// Disable buffering of stdout.
@@ -49,20 +122,17 @@ int main(int argc,char* argv[])
 
 	posix_parse_command_line(argc, argv);
 
-	// Read the lib and app infusion archives from file
+	// Read the lib infusion archive from file
 	di_lib_archive = posix_load_infusion_archive("lib_infusions.dja");
-	di_app_archive = posix_load_infusion_archive(posix_app_infusion_filename);
-
-	// initialise memory manager
-	void *mem = malloc(HEAPSIZE);
-	ref_t_base_address = (char*)mem - 42;
 
-	core_init(mem, HEAPSIZE);
-	dj_vm_main(di_lib_archive, di_app_archive, java_library_native_handlers, java_library_native_handlers_length);
+#ifdef DJ_MULTI_VM
+	if (posix_nr_nodes > 1) {
+		run_nodes();
+		return 0;
+	}
+#endif
 
-	// Listen to the radio
-	while(true)
-		dj_hook_call(dj_core_pollingHook, NULL);
+	run_node();
 
 	return 0;
 }
@@ -66,4 +66,8 @@
 // #define RADIO_USE_XBEE
 #define RADIO_USE_NETWORKSERVER
 
+// Allow running several nodes in one process (-N/--nodes), each VM in its own thread with
+// its own copy of the VM state. Only supported with ROUTING_USE_NONE and the network server radio.
+#define DJ_MULTI_VM
+
 #endif
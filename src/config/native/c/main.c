@@ -33,6 +33,7 @@
 #include "djarchive.h"
 
 #include "posix_utils.h"
+#include "posix_poll.h"
 
 // From GENERATEDlibinit.c, which is generated during build based on the libraries in this config's libs.
 extern dj_named_native_handler java_library_native_handlers[];
@@ -50,15 +51,18 @@ int main(int argc,char* argv[])
 	di_app_archive = posix_load_infusion_archive(posix_app_infusion_filename);
 
 	// initialise memory manager
-	void *mem = malloc(HEAPSIZE);
+	void *mem = malloc(posix_heap_size);
 	ref_t_base_address = (char*)mem - 42;
 
-	core_init(mem, HEAPSIZE);
+	core_init(mem, posix_heap_size);
+	posix_poll_init();
 	dj_vm_main(di_lib_archive, di_app_archive, java_library_native_handlers, java_library_native_handlers_length);
 
 	// Listen to the radio
-	while(true)
+	while(true) {
 		dj_hook_call(dj_core_pollingHook, NULL);
+		dj_core_idle(-1);
+	}
 
 	return 0;
 }
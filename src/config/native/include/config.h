@@ -24,12 +24,101 @@
 #include <sys/types.h>
 #include <stdio.h>
 
-// Allocate 4k heap for the VM
+// Allocate 4k heap for the VM, unless overridden with --heap-size
 #define HEAPSIZE 4096
 
+// Use 32-bit references and chunk sizes, so the heap can be larger than 64 KB and hold chunks larger
+// than 16 KB. Costs 2 extra bytes per reference and 6 per chunk header. Native (posix) builds only.
+// #define HEAP_32BIT
+
 // 'Time slices' are 32 instructions
 #define RUNSIZE 32
 
+// Use GCC computed-goto threaded dispatch in the interpreter loop. RUNSIZE
+// then counts backward branches and method calls instead of instructions.
+// #define EXECUTION_THREADED_DISPATCH
+
+// Let arithmetic instructions overwrite their first operand on top of the integer stack instead of popping it
+// and pushing the result. The top of the stack stays in memory, it is not cached in a register. Off until the loop
+// kernel of the vmbench app shows a gain with it.
+// #define EXECUTION_TOS_INPLACE
+
+// Use 32-bit integer operand stack and local variable slots instead of 16-bit ones, so ints take one aligned slot and
+// longs two. The infusions have to be built for this layout: set slotWidth = 32 in the config's sub.gradle.
+// #define EXECUTION_32BIT_SLOTS
+
+// Execute the fused instructions (load and branch on zero, ALOAD_0 and GETFIELD) that the infuser emits for common
+// opcode sequences, saving a dispatch each. The infusions have to be built for it: set superInstructions = true in the
+// config's sub.gradle.
+// #define EXECUTION_SUPERINSTRUCTIONS
+
+// Cache the resolved method of virtual/interface call sites, keyed on the receiver's class.
+// EXECUTION_INLINE_CACHE_SIZE is the number of call site slots, EXECUTION_INLINE_CACHE_WAYS the number of receiver
+// classes remembered per call site (RAM use is ~4 bytes per slot plus ~6 bytes per way, more on 32-bit targets).
+#define EXECUTION_INLINE_CACHE
+#define EXECUTION_INLINE_CACHE_SIZE 32
+#define EXECUTION_INLINE_CACHE_WAYS 4
+
+// Record the resolved target of INVOKESTATIC, INVOKESPECIAL, GETSTATIC and PUTSTATIC instructions
+// in a RAM side table the first time they execute. EXECUTION_QUICKENING_SIZE is the number of slots.
+#define EXECUTION_QUICKENING
+#define EXECUTION_QUICKENING_SIZE 32
+
+// Call the C code the infuser generates for library methods built with aotCompile = true, instead of interpreting
+// their bytecode. Only leaf methods without exception handlers are compiled, the rest stays interpreted. Off until
+// the aottest app, which compares the compiled methods of the aottest library against the interpreter, has passed.
+// #define EXECUTION_AOT
+
+// Flatten inherited method tables into one table per class at infusion load time, so virtual
+// method lookup doesn't have to walk the superclass chain. Costs 4 bytes of heap per inherited
+// or declared method per class; leave undefined on RAM-tight platforms to keep scanning.
+#define VM_FLATTENED_VTABLES
+
+// Precompute supertype displays and interface bitsets per class at infusion load time, so INSTANCEOF,
+// CHECKCAST and exception dispatch are constant time. Costs roughly 6 bytes of heap per class plus
+// one bit per class per implemented interface.
+#define VM_TYPE_DISPLAYS
+
+// Intern string constants, so LDS returns the same String object each time instead of creating a new one. The
+// strings are held weakly in a direct mapped table of VM_INTERN_STRINGS_SIZE entries.
+#define VM_INTERN_STRINGS
+#define VM_INTERN_STRINGS_SIZE 16
+
+// Allocate the frames of each thread in a contiguous, growable stack segment instead of
+// a heap chunk per frame. THREAD_FRAME_STACK_SIZE is the initial segment size in bytes.
+// #define THREAD_FRAME_STACK
+#define THREAD_FRAME_STACK_SIZE 128
+
+// Keep gray chunks on a bounded stack during GC marking instead of sweeping the heap for gray chunks
+// until none are left. GC_MARK_STACK_SIZE is the number of entries (2 bytes each, 4 with HEAP_32BIT; at most 65535);
+// when the stack overflows, marking falls back to sweeping for the chunks that didn't fit.
+#define GC_MARK_STACK
+#define GC_MARK_STACK_SIZE 32
+
+// Reuse freed and dead chunks through segregated free lists, and only compact the heap (moving
+// objects) when fragmentation prevents an allocation from succeeding.
+#define HEAP_FREE_LISTS
+
+// Collect garbage incrementally between time slices. A collection starts when less than
+// GC_INCREMENTAL_START bytes are free, and each step visits at most GC_INCREMENTAL_STEP_SIZE
+// objects, which bounds the pause. Reference stores go through a write barrier while marking.
+// Requires GC_MARK_STACK and HEAP_FREE_LISTS.
+// #define GC_INCREMENTAL
+#define GC_INCREMENTAL_START 1024
+#define GC_INCREMENTAL_STEP_SIZE 16
+
+// Count allocations and bytes per type and per allocating method, and print a report at shutdown.
+// ALLOC_PROFILER_SIZE is the number of types and of methods that are tracked (8 bytes each).
+// #define ALLOC_PROFILER
+#define ALLOC_PROFILER_SIZE 32
+
+// Count the opcode pairs and triples executed by the interpreter, and print the most executed ones at shutdown. Used
+// to pick the sequences the infuser fuses into superinstructions. OPCODE_PROFILER_SIZE is the number of distinct
+// pairs and of distinct triples that are tracked (8 bytes each), OPCODE_PROFILER_TOP the number printed of each.
+// #define OPCODE_PROFILER
+#define OPCODE_PROFILER_SIZE 1024
+#define OPCODE_PROFILER_TOP 32
+
 // #define PACK_STRUCTS
 // #define ALIGN_16
 
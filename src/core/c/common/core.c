@@ -5,13 +5,19 @@
 #include "djtimer.h"
 
 // Runlevel. Used to pause the VM when reprogramming and reset it afterwards.
-uint8_t dj_exec_runlevel;
+DJ_VM_LOCAL uint8_t dj_exec_runlevel;
 
 // For libraries that need frequent polling. Currently just for radios, but maybe there are other uses. Should be fast.
-dj_hook *dj_core_pollingHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_core_pollingHook = NULL;
 
 // To notify components we're shutting down so things can be cleaned up nicely. (useful for the network server radio so it can properly close the connection)
-dj_hook *dj_core_shutdownHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_core_shutdownHook = NULL;
+
+// To block until there is something to do, see dj_core_idle.
+DJ_VM_LOCAL dj_hook *dj_core_idleHook = NULL;
+
+// The earliest time at which a component asked to be polled again, or -1.
+static DJ_VM_LOCAL dj_time_t dj_core_wakeupTime = -1;
 
 extern void dj_libraries_init(); // Generated during build based on the included libraries
 
@@ -25,3 +31,28 @@ void core_init(void *mem, uint32_t memsize) {
 	// initialise libraries
 	dj_libraries_init();
 }
+
+// Called from a polling hook by components that need to be polled again at a certain time, even if no I/O happens,
+// for instance to send a heartbeat. The request only holds until the next call to dj_core_idle, so components should
+// repeat it every time they are polled.
+void dj_core_requestWakeup(dj_time_t time) {
+	if (dj_core_wakeupTime == -1 || time < dj_core_wakeupTime)
+		dj_core_wakeupTime = time;
+}
+
+// Called by main loops when they have nothing to do for the next [timeout] milliseconds (or -1 if they don't need to
+// wake up by themselves). Blocks until the timeout expires, a wakeup requested through dj_core_requestWakeup is due,
+// or the platform's idle hook sees I/O. The caller should call the polling hook afterwards.
+void dj_core_idle(dj_time_t timeout) {
+	if (dj_core_wakeupTime != -1) {
+		dj_time_t wakeup = dj_core_wakeupTime - dj_timer_getTimeMillis();
+		if (wakeup < 0)
+			wakeup = 0;
+		if (timeout == -1 || wakeup < timeout)
+			timeout = wakeup;
+		dj_core_wakeupTime = -1;
+	}
+
+	if (timeout != 0)
+		dj_hook_call(dj_core_idleHook, &timeout);
+}
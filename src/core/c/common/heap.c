@@ -40,8 +40,13 @@
  * marked directly by following these reference values. This means that there are no false positives in the root set
  * and that marking the root set is done efficiently.
  *
- * Eventually the code from this garbage collector should be merged with the code from the old mark & sweep collector
- * so that allocation is done using a free list and compaction is only triggered when absolutely neccesairy.
+ * When GC_MARK_STACK is defined, chunks are pushed onto a bounded mark stack as they turn gray, and the heap is only
+ * sweeped for gray chunks when that stack overflows.
+ *
+ * When HEAP_FREE_LISTS is defined, freed and dead chunks are kept on segregated free lists (one per power-of-two size
+ * class) and reused by later allocations, and a collection only sweeps dead chunks into those lists. Chunks are only
+ * moved when fragmentation prevents an allocation from succeeding, in which case the heap is compacted as described
+ * above.
  *
  * Because calls to dj_mem_alloc() can trigger garbage compaction, pointers (in the C code) may be made invalid as the
  * element they were pointing to may have been moved. A C pointer can be added to the 'safe pointer pool' which will cause
@@ -76,30 +81,220 @@
 #include "debug.h"
 #include "panic.h"
 #include "hooks.h"
+#include "djtimer.h"
 
-static char *heap_base;
-static uint16_t heap_size;
+static DJ_VM_LOCAL char *heap_base;
+static DJ_VM_LOCAL heap_size_t heap_size;
 
-static void ** safePointerPool[SAFE_POINTER_POOL_SIZE];
+static DJ_VM_LOCAL void ** safePointerPool[SAFE_POINTER_POOL_SIZE];
 
-static void *left_pointer, *right_pointer;
+static DJ_VM_LOCAL void *left_pointer, *right_pointer;
 
 #ifdef DARJEELING_DEBUG_MEM_TRACE
-static int nrTrace = 0;
+static DJ_VM_LOCAL int nrTrace = 0;
+#endif
+
+// statistics of the last collection, passed to the dj_mem_postGCHook callbacks
+static DJ_VM_LOCAL dj_mem_gc_info gcInfo;
+
+#ifdef HEAP_FREE_LISTS
+// number of free lists. List i holds chunks of up to 8 << i bytes, the last one holds all larger chunks
+#define HEAP_NR_SIZE_CLASSES 6
+
+// marks the end of a free list. Free chunks are linked through the shift field in their header, which
+// holds the offset of the next free chunk from the heap base
+#define FREELIST_END ((heap_size_t)~0)
+
+static DJ_VM_LOCAL heap_size_t freeLists[HEAP_NR_SIZE_CLASSES];
+static DJ_VM_LOCAL heap_size_t freeListBytes;
+#endif
+
+#ifdef GC_MARK_STACK
+// gray chunks waiting to be visited, stored as offsets from the heap base
+#if GC_MARK_STACK_SIZE>UINT16_MAX
+#error "GC_MARK_STACK_SIZE must be at most 65535"
+#endif
+static DJ_VM_LOCAL heap_size_t markStack[GC_MARK_STACK_SIZE];
+#if GC_MARK_STACK_SIZE>UINT8_MAX
+static DJ_VM_LOCAL uint16_t markStackTop;
+#else
+static DJ_VM_LOCAL uint8_t markStackTop;
+#endif
+static DJ_VM_LOCAL bool markStackOverflow;
+#endif
+
+#ifdef GC_INCREMENTAL
+#if !defined(GC_MARK_STACK) || !defined(HEAP_FREE_LISTS)
+#error "GC_INCREMENTAL requires GC_MARK_STACK and HEAP_FREE_LISTS"
+#endif
+
+// true while an incremental collection is marking, see dj_mem_writeBarrier()
+DJ_VM_LOCAL bool dj_mem_gcMarking = false;
+
+// bytes allocated since the last collection, so no collection is started while nothing changes
+static DJ_VM_LOCAL heap_size_t bytesAllocatedSinceGC;
+
+// Pause time histograms for incremental marking steps, for the final step of an incremental collection (which
+// finalises and sweeps the whole heap), and for full (stop-the-world) collections. Bucket 0 counts pauses under
+// 1 ms, bucket i pauses of [2^(i-1), 2^i) ms, and the last bucket all longer pauses.
+#define GC_PAUSE_HISTOGRAM_SIZE 8
+static DJ_VM_LOCAL uint16_t gcStepPauses[GC_PAUSE_HISTOGRAM_SIZE];
+static DJ_VM_LOCAL uint16_t gcFinalPauses[GC_PAUSE_HISTOGRAM_SIZE];
+static DJ_VM_LOCAL uint16_t gcFullPauses[GC_PAUSE_HISTOGRAM_SIZE];
+static DJ_VM_LOCAL uint16_t gcMaxStepPause, gcMaxFinalPause, gcMaxFullPause;
+static DJ_VM_LOCAL uint16_t gcNrIncrementalCycles;
+
+static void dj_mem_shutdown(void *data);
+static DJ_VM_LOCAL dj_hook dj_mem_shutdownHook = { dj_mem_shutdown, NULL };
 #endif
 
 // To let other libraries hook into the garbage collector.
-dj_hook *dj_mem_markRootSetHook = NULL;
-dj_hook *dj_mem_markObjectHook = NULL;
-dj_hook *dj_mem_updateReferenceHook = NULL;
-dj_hook *dj_mem_postGCHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_mem_markRootSetHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_mem_markObjectHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_mem_updateReferenceHook = NULL;
+DJ_VM_LOCAL dj_hook *dj_mem_postGCHook = NULL;
+#ifdef ALLOC_PROFILER
+DJ_VM_LOCAL dj_hook *dj_mem_allocHook = NULL;
+#endif
+
+#ifdef HEAP_FREE_LISTS
+static void dj_mem_collect(heap_size_t size);
+
+/**
+ * @param size chunk size including the header
+ * @return the index of the free list that holds chunks of the given size
+ */
+static inline uint8_t dj_mem_getSizeClass(heap_size_t size)
+{
+	uint8_t ret = 0;
+	heap_size_t bound = 8;
+
+	while (ret<HEAP_NR_SIZE_CLASSES-1 && size>bound)
+	{
+		ret++;
+		bound <<= 1;
+	}
+
+	return ret;
+}
+
+static inline heap_chunk * dj_mem_getFreeChunk(heap_size_t offset)
+{
+	return (heap_chunk*)(heap_base + offset);
+}
+
+/**
+ * Adds a chunk to the free list of its size class.
+ * @param chunk the chunk, which must have id CHUNKID_FREE
+ */
+static inline void dj_mem_addFreeChunk(heap_chunk *chunk)
+{
+	uint8_t sizeClass = dj_mem_getSizeClass(chunk->size);
+
+	chunk->shift = freeLists[sizeClass];
+	freeLists[sizeClass] = (heap_size_t)((char*)chunk - heap_base);
+	freeListBytes += chunk->size;
+}
+
+/**
+ * Empties the free lists.
+ */
+static inline void dj_mem_resetFreeLists()
+{
+	uint8_t i;
+
+	for (i=0; i<HEAP_NR_SIZE_CLASSES; i++)
+		freeLists[i] = FREELIST_END;
+
+	freeListBytes = 0;
+}
+
+/**
+ * Finds a free chunk of at least the given size. The size class of the request is searched first fit. Every chunk
+ * in a larger size class is large enough, so for those only the head of the list is checked.
+ * @param size the chunk size including the header
+ * @param sizeClass set to the size class the chunk was found in
+ * @param prev set to the offset of the chunk before it in the free list, or FREELIST_END if it's at the head
+ * @return the offset of the chunk from the heap base, or FREELIST_END if there is none
+ */
+static heap_size_t dj_mem_findFreeChunk(heap_size_t size, uint8_t *sizeClass, heap_size_t *prev)
+{
+	uint8_t i;
+	heap_size_t offset;
+
+	for (i=dj_mem_getSizeClass(size); i<HEAP_NR_SIZE_CLASSES; i++)
+	{
+		*prev = FREELIST_END;
+		for (offset=freeLists[i]; offset!=FREELIST_END; offset=dj_mem_getFreeChunk(offset)->shift)
+		{
+			if (dj_mem_getFreeChunk(offset)->size>=size)
+			{
+				*sizeClass = i;
+				return offset;
+			}
+			*prev = offset;
+		}
+	}
+
+	return FREELIST_END;
+}
+
+/**
+ * Takes a chunk of the given size from the free lists, or from the end of the heap if no free chunk is large enough.
+ * Free chunks are split if the remainder can hold a chunk header.
+ * @param size the chunk size including the header
+ * @return a chunk with its size set, or NULL if there is not enough contiguous free space
+ */
+static heap_chunk * dj_mem_allocChunk(heap_size_t size)
+{
+	heap_chunk *ret, *remainder;
+	uint8_t sizeClass;
+	heap_size_t offset, prev;
+
+	offset = dj_mem_findFreeChunk(size, &sizeClass, &prev);
+	if (offset!=FREELIST_END)
+	{
+		ret = dj_mem_getFreeChunk(offset);
+
+		// unlink
+		if (prev==FREELIST_END)
+			freeLists[sizeClass] = ret->shift;
+		else
+			dj_mem_getFreeChunk(prev)->shift = ret->shift;
+		freeListBytes -= ret->size;
+
+		// return what's left to the free lists
+		if (ret->size-size>=sizeof(heap_chunk))
+		{
+			remainder = (heap_chunk*)((char*)ret + size);
+			remainder->size = ret->size - size;
+			remainder->id = CHUNKID_FREE;
+			remainder->color = TCM_BLACK;
+			dj_mem_addFreeChunk(remainder);
+
+			ret->size = size;
+		}
+
+		return ret;
+	}
+
+	if (right_pointer-left_pointer<size)
+		return NULL;
+
+	ret = (heap_chunk*)left_pointer;
+	ret->size = size;
+	left_pointer += size;
+
+	return ret;
+}
+#endif
 
 /**
  * Initialises the memory manager. A call to this function may trigger garbage collection.
  * @param mem_pointer pointer to where Darjeeling can manage its heap
  * @param mem_size size of the heap
  */
-void dj_mem_init(void *mem_pointer, uint16_t mem_size)
+void dj_mem_init(void *mem_pointer, heap_size_t mem_size)
 {
 	uint16_t i;
 
@@ -114,6 +309,14 @@ void dj_mem_init(void *mem_pointer, uint16_t mem_size)
     left_pointer = heap_base;
     right_pointer = heap_base + heap_size;
 
+#ifdef HEAP_FREE_LISTS
+    dj_mem_resetFreeLists();
+#endif
+
+#ifdef GC_INCREMENTAL
+    dj_hook_add(&dj_core_shutdownHook, &dj_mem_shutdownHook);
+#endif
+
 }
 
 /**
@@ -121,7 +324,7 @@ void dj_mem_init(void *mem_pointer, uint16_t mem_size)
  * @param size size in bytes
  * @param id chunk ID.
  */
-void * dj_mem_alloc(uint16_t size, uint16_t id)
+void * dj_mem_alloc(heap_size_t size, runtime_id_t id)
 {
 	heap_chunk *ret;
 
@@ -132,8 +335,42 @@ void * dj_mem_alloc(uint16_t size, uint16_t id)
 #endif
 
 	// we need to accommodate for a chunk header
+	if (size>HEAP_MAX_CHUNK_SIZE-sizeof(heap_chunk))
+	{
+        DEBUG_LOG(DBG_DARJEELING, "dj_mem_alloc: chunk too large\n");
+        return NULL;
+	}
 	size += sizeof(heap_chunk);
 
+#ifdef HEAP_FREE_LISTS
+	ret = dj_mem_allocChunk(size);
+
+	if (ret==NULL)
+	{
+		// not enough memory
+        DEBUG_LOG(DBG_DARJEELING, "dj_mem_alloc: no free chunk large enough, triggering a collection\n");
+		dj_mem_collect(size);
+		ret = dj_mem_allocChunk(size);
+	}
+
+	if (ret==NULL)
+	{
+		// still not enough memory, return null
+        DEBUG_LOG(DBG_DARJEELING, "dj_mem_alloc: NULL!\n");
+        return NULL;
+	}
+
+	ret->id = id;
+
+#ifdef GC_INCREMENTAL
+	// chunks allocated while an incremental collection is marking are live
+	if (dj_mem_gcMarking)
+		ret->color = TCM_BLACK;
+
+	if (bytesAllocatedSinceGC<=(heap_size_t)~0-size)
+		bytesAllocatedSinceGC += size;
+#endif
+#else
 	if (right_pointer-left_pointer<size)
 	{
 		// not enough memory
@@ -153,6 +390,11 @@ void * dj_mem_alloc(uint16_t size, uint16_t id)
 	ret->id = id;
 
 	left_pointer += size;
+#endif
+
+#ifdef ALLOC_PROFILER
+	dj_hook_call(dj_mem_allocHook, (void*)((size_t)ret + sizeof(heap_chunk)));
+#endif
 
 	return (void*)((size_t)ret + sizeof(heap_chunk));
 }
@@ -165,17 +407,27 @@ void dj_mem_free(void * ptr)
 {
 	heap_chunk *chunk = (heap_chunk*)(ptr - sizeof(heap_chunk));
 
+#ifdef GC_INCREMENTAL
+	// the mark stack may still hold the offset of this chunk, so don't let a new chunk start inside it
+	if (((void*)chunk + chunk->size)==left_pointer && !dj_mem_gcMarking)
+#else
 	if (((void*)chunk + chunk->size)==left_pointer)
+#endif
 		left_pointer = (void*)chunk;
 	else
+	{
 		chunk->id = CHUNKID_FREE;
+#ifdef HEAP_FREE_LISTS
+		dj_mem_addFreeChunk(chunk);
+#endif
+	}
 
 }
 
 /**
  * @return the total number of bytes on the heap.
  */
-uint16_t dj_mem_getSize()
+heap_size_t dj_mem_getSize()
 {
 	return heap_size;
 }
@@ -183,9 +435,13 @@ uint16_t dj_mem_getSize()
 /**
  * @return the number of bytes left on the heap.
  */
-uint16_t dj_mem_getFree()
+heap_size_t dj_mem_getFree()
 {
+#ifdef HEAP_FREE_LISTS
+	return right_pointer - left_pointer + freeListBytes;
+#else
 	return right_pointer - left_pointer;
+#endif
 }
 
 /**
@@ -280,17 +536,94 @@ static inline void dj_finalise(heap_chunk * chunk)
 	}
 }
 
+#ifdef GC_MARK_STACK
 /**
- * Implements the marking phase using stop-the-world tri-color marking
+ * Pushes a chunk that has just been colored gray onto the mark stack. If the stack is full the chunk stays gray
+ * and is found later by sweeping the heap.
+ * @param chunk the gray chunk
  */
-static inline void dj_mem_mark()
+void dj_mem_pushGrayChunk(heap_chunk *chunk)
+{
+	if (markStackTop<GC_MARK_STACK_SIZE)
+		markStack[markStackTop++] = (heap_size_t)((char*)chunk - heap_base);
+	else
+		markStackOverflow = true;
+}
+
+/**
+ * Visits the chunks on the mark stack until it is empty. Visiting a chunk may push its children.
+ */
+static inline void dj_mem_drainMarkStack()
+{
+	heap_chunk *chunk;
+
+	while (markStackTop>0)
+	{
+		chunk = (heap_chunk*)(heap_base + markStack[--markStackTop]);
+
+		// a chunk may be pushed more than once, only visit it while it's still gray
+		if (chunk->color==TCM_GRAY)
+			dj_hook_call(dj_mem_markObjectHook, (void *)chunk);
+	}
+}
+#endif
+
+#ifdef GC_INCREMENTAL
+/**
+ * Visits chunks on the mark stack until it is empty or the given number of chunks has been visited.
+ * @param maxVisits the maximum number of chunks to visit
+ * @return true if the mark stack is empty
+ */
+static inline bool dj_mem_markStep(uint16_t maxVisits)
+{
+	heap_chunk *chunk;
+
+	while (markStackTop>0 && maxVisits>0)
+	{
+		chunk = (heap_chunk*)(heap_base + markStack[--markStackTop]);
+
+		if (chunk->color==TCM_GRAY)
+		{
+			dj_hook_call(dj_mem_markObjectHook, (void *)chunk);
+			maxVisits--;
+		}
+	}
+
+	return markStackTop==0;
+}
+
+/**
+ * Pushes the gray chunks that didn't fit on the mark stack onto it, as far as they fit now. If the stack fills up
+ * again the overflow flag is set again, and the rest is pushed by a later call.
+ */
+static void dj_mem_pushGrayChunks()
+{
+	heap_chunk *chunk;
+	void * loc = heap_base;
+
+	markStackOverflow = false;
+
+	while (loc<left_pointer && !markStackOverflow)
+	{
+		chunk = (heap_chunk*)loc;
+
+		if (chunk->color==TCM_GRAY)
+			dj_mem_pushGrayChunk(chunk);
+
+		loc += chunk->size;
+	}
+}
+#endif
+
+/**
+ * Initialises chunk colors to white for managed objects (Java objects, infusions), and black for built-in objects
+ * (frames, threads).
+ */
+static inline void dj_mem_markInit()
 {
 	heap_chunk *chunk;
 	void * loc = heap_base;
-	uint8_t i;
 
-	// Initialise chunk colors to white for managed objects (Java objects, infusions), and
-	// black for built-in objects (frames, threads)
 	while (loc<left_pointer)
 	{
 		chunk = (heap_chunk*)loc;
@@ -298,6 +631,19 @@ static inline void dj_mem_mark()
 		loc += chunk->size;
 	}
 
+#ifdef GC_MARK_STACK
+	markStackTop = 0;
+	markStackOverflow = false;
+#endif
+}
+
+/**
+ * Marks the root set and the safe pointer pool gray.
+ */
+static inline void dj_mem_markRoots()
+{
+	uint8_t i;
+
 	DEBUG_LOG(DBG_DARJEELING, "\tmark root set\n");
 
 	// mark the root set (set all elements in the root set to 'gray')
@@ -309,7 +655,40 @@ static inline void dj_mem_mark()
 	for (i=0; i<SAFE_POINTER_POOL_SIZE; i++)
 		if (safePointerPool[i]!=NULL)
 			dj_mem_setPointerGrayIfWhite(*(safePointerPool[i]));
+}
+
+/**
+ * Visits gray chunks until there are none left.
+ */
+static inline void dj_mem_markGray()
+{
+	heap_chunk *chunk;
+	void * loc;
+
+#ifdef GC_MARK_STACK
+	// visit the gray chunks on the mark stack. If it overflowed, some gray chunks were not pushed,
+	// so sweep the heap for them and visit them the same way
+	dj_mem_drainMarkStack();
+	while (markStackOverflow)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "\tmark stack overflow, sweeping for gray chunks\n");
+
+		markStackOverflow = false;
+		loc = heap_base;
+		while (loc<left_pointer)
+		{
+			chunk = (heap_chunk*)loc;
+
+			if (chunk->color==TCM_GRAY)
+			{
+				dj_hook_call(dj_mem_markObjectHook, (void *)chunk);
+				dj_mem_drainMarkStack();
+			}
 
+			loc += chunk->size;
+		}
+	}
+#else
 	// iterate over the chunks, make every gray chunk black
 	int nrGray;
 	do
@@ -333,9 +712,17 @@ static inline void dj_mem_mark()
 		}
 
 	} while (nrGray>0);
+#endif
+}
+
+/**
+ * Calls finalise on each of the chunks that are still white after marking.
+ */
+static inline void dj_mem_finaliseWhite()
+{
+	heap_chunk *chunk;
+	void * loc = heap_base;
 
-	// Call finalise on each of the chunks
-	loc = heap_base;
 	while (loc<left_pointer)
 	{
 		chunk = (heap_chunk*)loc;
@@ -345,6 +732,17 @@ static inline void dj_mem_mark()
 	}
 }
 
+/**
+ * Implements the marking phase using stop-the-world tri-color marking
+ */
+static inline void dj_mem_mark()
+{
+	dj_mem_markInit();
+	dj_mem_markRoots();
+	dj_mem_markGray();
+	dj_mem_finaliseWhite();
+}
+
 heap_chunk * dj_mem_getFirstChunk() {
 	return (heap_chunk *)heap_base;
 }
@@ -357,6 +755,57 @@ heap_chunk * dj_mem_getNextChunk(heap_chunk *currentChunk) {
 		return NULL;
 }
 
+/**
+ * Starts collecting the statistics of a collection.
+ * @return the time the collection started
+ */
+static inline dj_time_t dj_mem_startGCInfo()
+{
+	gcInfo.nr_moved = 0;
+	gcInfo.flags = 0;
+
+	return dj_timer_getTimeMillis();
+}
+
+/**
+ * Fills in the statistics of the collection that just finished.
+ * @param start the time the collection started
+ * @param freeBefore the number of free bytes before the collection
+ */
+static void dj_mem_finishGCInfo(dj_time_t start, heap_size_t freeBefore)
+{
+	heap_chunk *chunk;
+	void * loc = heap_base;
+
+	gcInfo.live = 0;
+	gcInfo.nr_chunks = 0;
+	gcInfo.largest_free = right_pointer - left_pointer;
+
+	while (loc<left_pointer)
+	{
+		chunk = (heap_chunk*)loc;
+
+		if (chunk->id==CHUNKID_FREE)
+		{
+			if (chunk->size>gcInfo.largest_free)
+				gcInfo.largest_free = chunk->size;
+		} else
+		{
+			gcInfo.live += chunk->size;
+			gcInfo.nr_chunks++;
+		}
+
+		loc += chunk->size;
+	}
+
+	gcInfo.free = dj_mem_getFree();
+	gcInfo.reclaimed = (gcInfo.free>freeBefore) ? gcInfo.free - freeBefore : 0;
+	gcInfo.pause = (uint16_t)(dj_timer_getTimeMillis() - start);
+
+	if (gcInfo.nr_moved>0)
+		gcInfo.flags |= DJ_MEM_GC_COMPACTED;
+}
+
 void dj_mem_compact()
 {
 	int i;
@@ -394,8 +843,11 @@ void dj_mem_compact()
 		chunk = (heap_chunk*)loc;
 		chunkSize = chunk->size;
 
-		if (chunk->id!=CHUNKID_FREE)
+		if (chunk->id!=CHUNKID_FREE && chunk->shift>0)
+		{
 			memmove(loc-chunk->shift, loc, chunkSize);
+			gcInfo.nr_moved++;
+		}
 
 		loc += chunkSize;
 	}
@@ -403,18 +855,229 @@ void dj_mem_compact()
 	left_pointer-=shift;
 }
 
+#ifdef GC_INCREMENTAL
+/**
+ * Adds a pause to a pause time histogram.
+ * @param histogram the histogram
+ * @param max the longest pause so far, updated if this pause is longer
+ * @param start the time the pause started
+ */
+static void dj_mem_recordPause(uint16_t *histogram, uint16_t *max, dj_time_t start)
+{
+	uint16_t pause = (uint16_t)(dj_timer_getTimeMillis() - start);
+	uint8_t bucket = 0;
+
+	while (bucket<GC_PAUSE_HISTOGRAM_SIZE-1 && (pause>>bucket)>0)
+		bucket++;
+
+	if (histogram[bucket]<0xffff)
+		histogram[bucket]++;
+
+	if (pause>*max)
+		*max = pause;
+}
+#endif
+
+#ifdef HEAP_FREE_LISTS
+/**
+ * Merges runs of free chunks and puts them on the free lists. A free run at the end of the heap is returned to the
+ * bump allocation area instead.
+ */
+static void dj_mem_sweep()
+{
+	heap_chunk *chunk, *next;
+	void * loc = heap_base;
+
+	dj_mem_resetFreeLists();
+
+	while (loc<left_pointer)
+	{
+		chunk = (heap_chunk*)loc;
+
+		if (chunk->id==CHUNKID_FREE)
+		{
+			// merge with the free chunks that follow
+			next = (heap_chunk*)(loc + chunk->size);
+			while ((void*)next<left_pointer && next->id==CHUNKID_FREE && chunk->size+next->size<=HEAP_MAX_CHUNK_SIZE)
+			{
+				chunk->size += next->size;
+				next = (heap_chunk*)(loc + chunk->size);
+			}
+
+			if (loc + chunk->size==left_pointer)
+			{
+				left_pointer = loc;
+				break;
+			}
+
+			dj_mem_addFreeChunk(chunk);
+		}
+
+		loc += chunk->size;
+	}
+}
+
+/**
+ * Collects garbage. Dead chunks are swept onto the free lists, and the heap is only compacted if that still doesn't
+ * leave a contiguous block for the allocation that triggered the collection.
+ * @param size the chunk size (including header) of the allocation that triggered the collection, or 0 if none
+ */
+static void dj_mem_collect(heap_size_t size)
+{
+	uint8_t sizeClass;
+	heap_size_t prev;
+	heap_size_t freeBefore = dj_mem_getFree();
+	dj_time_t start = dj_mem_startGCInfo();
+
+#ifdef GC_INCREMENTAL
+	// a full collection supersedes an incremental one that is still marking
+	dj_mem_gcMarking = false;
+#endif
+
+	DEBUG_LOG(DBG_DARJEELING_GC, "(GC)");
+
+	DEBUG_LOG(DBG_DARJEELING, "GC start\n");
+
+	dj_mem_mark();
+	dj_mem_sweep();
+
+	if (size>0
+			&& right_pointer-left_pointer<size
+			&& dj_mem_findFreeChunk(size, &sizeClass, &prev)==FREELIST_END
+			&& dj_mem_getFree()>=size)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "\theap too fragmented, compacting\n");
+		dj_mem_compact();
+		dj_mem_resetFreeLists();
+	}
+
+	dj_mem_finishGCInfo(start, freeBefore);
+	dj_hook_call(dj_mem_postGCHook, &gcInfo);
+
+#ifdef GC_INCREMENTAL
+	bytesAllocatedSinceGC = 0;
+	dj_mem_recordPause(gcFullPauses, &gcMaxFullPause, start);
+#endif
+
+	DEBUG_LOG(DBG_DARJEELING, "GC done\n");
+}
+
+void dj_mem_gc()
+{
+	dj_mem_collect(0);
+}
+
+#ifdef GC_INCREMENTAL
+/**
+ * Does a bounded amount of incremental garbage collection work. Called by the scheduler between time slices. A
+ * collection starts when less than GC_INCREMENTAL_START bytes are free, by marking the root set gray. Each following
+ * step visits at most GC_INCREMENTAL_STEP_SIZE gray chunks. While marking, dj_mem_writeBarrier() keeps references
+ * stored into heap objects from being missed. Gray chunks that didn't fit on the mark stack are pushed onto it again
+ * once it is empty. Stacks and other roots are not covered by the barrier, so once there are no gray chunks left
+ * the roots are marked again, and any chunk that this colors gray is visited in the following steps like the others.
+ * Marking is finished when marking the roots again finds no new gray chunks. In that same final step the white
+ * chunks are finalised and swept onto the free lists, which takes a pass over the whole heap, so its pause is
+ * recorded separately from the marking steps. The heap is never compacted here.
+ */
+void dj_mem_gcStep()
+{
+	dj_time_t start;
+	heap_size_t freeBefore;
+
+	if (!dj_mem_gcMarking && (dj_mem_getFree()>=GC_INCREMENTAL_START || bytesAllocatedSinceGC==0))
+		return;
+
+	start = dj_timer_getTimeMillis();
+
+	if (!dj_mem_gcMarking)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "incremental GC start\n");
+
+		dj_mem_markInit();
+		dj_mem_markRoots();
+		dj_mem_gcMarking = true;
+	} else if (dj_mem_markStep(GC_INCREMENTAL_STEP_SIZE))
+	{
+		if (markStackOverflow)
+			dj_mem_pushGrayChunks();
+		else
+			dj_mem_markRoots();
+	}
+
+	// keep marking in the next steps while there are gray chunks left
+	if (markStackTop>0 || markStackOverflow)
+	{
+		dj_mem_recordPause(gcStepPauses, &gcMaxStepPause, start);
+		return;
+	}
+
+	freeBefore = dj_mem_getFree();
+	dj_mem_startGCInfo();
+	gcInfo.flags = DJ_MEM_GC_INCREMENTAL;
+
+	dj_mem_finaliseWhite();
+	dj_mem_gcMarking = false;
+
+	dj_mem_sweep();
+	bytesAllocatedSinceGC = 0;
+	gcNrIncrementalCycles++;
+
+	dj_mem_finishGCInfo(start, freeBefore);
+	dj_hook_call(dj_mem_postGCHook, &gcInfo);
+
+	DEBUG_LOG(DBG_DARJEELING, "incremental GC done\n");
+
+	dj_mem_recordPause(gcFinalPauses, &gcMaxFinalPause, start);
+}
+
+/**
+ * Prints the number of incremental collections and the pause time histograms.
+ */
+void dj_mem_printGCStats()
+{
+	int i;
+
+	DARJEELING_PRINTF("GC: %d incremental collections, max step pause %d ms, max final step pause %d ms, max full collection pause %d ms\n",
+			gcNrIncrementalCycles, gcMaxStepPause, gcMaxFinalPause, gcMaxFullPause);
+	DARJEELING_PRINTF("GC pauses (incremental steps / final incremental steps / full collections):\n");
+
+	for (i=0; i<GC_PAUSE_HISTOGRAM_SIZE; i++)
+	{
+		if (i==0)
+			DARJEELING_PRINTF("\t<1 ms: %d / %d / %d\n", gcStepPauses[i], gcFinalPauses[i], gcFullPauses[i]);
+		else if (i==1)
+			DARJEELING_PRINTF("\t1 ms: %d / %d / %d\n", gcStepPauses[i], gcFinalPauses[i], gcFullPauses[i]);
+		else if (i<GC_PAUSE_HISTOGRAM_SIZE-1)
+			DARJEELING_PRINTF("\t%d-%d ms: %d / %d / %d\n", 1<<(i-1), (1<<i)-1, gcStepPauses[i], gcFinalPauses[i], gcFullPauses[i]);
+		else
+			DARJEELING_PRINTF("\t>=%d ms: %d / %d / %d\n", 1<<(i-1), gcStepPauses[i], gcFinalPauses[i], gcFullPauses[i]);
+	}
+}
+
+static void dj_mem_shutdown(void *data)
+{
+	dj_mem_printGCStats();
+}
+#endif
+#else
 void dj_mem_gc()
 {
 	DEBUG_LOG(DBG_DARJEELING_GC, "(GC)");
 
+	heap_size_t freeBefore = dj_mem_getFree();
+	dj_time_t start = dj_mem_startGCInfo();
+
 	DEBUG_LOG(DBG_DARJEELING, "GC start\n");
 
 	dj_mem_mark();
 	dj_mem_compact();
-	dj_hook_call(dj_mem_postGCHook, NULL);
+
+	dj_mem_finishGCInfo(start, freeBefore);
+	dj_hook_call(dj_mem_postGCHook, &gcInfo);
 
 	DEBUG_LOG(DBG_DARJEELING, "GC done\n");
 }
+#endif
 
 //void dj_mem_thread_dump()
 //{
@@ -486,8 +1149,8 @@ void dj_mem_dump()
             case CHUNKID_INVALID:
                 chunk_type_pretty_print="INV";
                 break;
-            case CHUNKID_MONITOR_BLOCK:
-                chunk_type_pretty_print="MTBK";
+            case CHUNKID_MONITOR_TABLE:
+                chunk_type_pretty_print="MTBL";
                 break;
             case CHUNKID_VM:
                 chunk_type_pretty_print="  VM";
@@ -498,6 +1161,19 @@ void dj_mem_dump()
             case CHUNKID_FRAME:
                 chunk_type_pretty_print="STKF";
                 break;
+#ifdef THREAD_FRAME_STACK
+            case CHUNKID_FRAME_STACK:
+                chunk_type_pretty_print="STKS";
+                break;
+#endif
+            case CHUNKID_CLASS_TABLE:
+                chunk_type_pretty_print="CTBL";
+                break;
+#ifdef VM_TYPE_DISPLAYS
+            case CHUNKID_TYPE_TABLE:
+                chunk_type_pretty_print="TTBL";
+                break;
+#endif
              case CHUNKID_THREAD:
                  chunk_type_pretty_print="THRD";
                  break;
@@ -63,8 +63,10 @@ void dj_panic(int32_t panictype)
     }
     if (dj_exec_getRunlevel() < RUNLEVEL_PANIC) {
         dj_exec_setRunlevel(panictype);
-        while (true) // Still allow remote access through wkcomm when in panic state.
+        while (true) { // Still allow remote access through wkcomm when in panic state.
             dj_hook_call(dj_core_pollingHook, NULL);
+            dj_core_idle(-1);
+        }
     } else {
         exit(panictype); // To avoid getting into a recursive panic.
     }
@@ -0,0 +1,73 @@
+#include <poll.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "core.h"
+#include "types.h"
+#include "hooks.h"
+#include "debug.h"
+#include "posix_poll.h"
+
+// Lets the main loops sleep in poll() until one of the registered file descriptors becomes readable or the timeout
+// passed to dj_core_idle expires, instead of spinning on the polling hook. Radios register the sockets or serial
+// ports they read from their polling functions.
+
+static DJ_VM_LOCAL struct pollfd posix_poll_fds[POSIX_POLL_MAX_FDS];
+static DJ_VM_LOCAL int posix_poll_nr_fds = 0;
+static DJ_VM_LOCAL dj_hook posix_poll_idleHook;
+// Set when a file descriptor couldn't be registered. Data arriving on it wouldn't wake us up, so we never sleep for
+// longer than POSIX_POLL_FALLBACK_TIMEOUT after that.
+static DJ_VM_LOCAL bool posix_poll_incomplete = false;
+
+// Registers a file descriptor to wake up on when it becomes readable. Returns false if there's no room left.
+bool posix_poll_register(int fd) {
+	for (int i=0; i<posix_poll_nr_fds; i++)
+		if (posix_poll_fds[i].fd == fd)
+			return true;
+
+	if (posix_poll_nr_fds == POSIX_POLL_MAX_FDS) {
+		DEBUG_LOG(DBG_DARJEELING, "posix_poll_register: no room for fd %d\n", fd);
+		posix_poll_incomplete = true;
+		return false;
+	}
+
+	posix_poll_fds[posix_poll_nr_fds].fd = fd;
+	posix_poll_fds[posix_poll_nr_fds].events = POLLIN;
+	posix_poll_fds[posix_poll_nr_fds].revents = 0;
+	posix_poll_nr_fds++;
+	return true;
+}
+
+// Stops waking up on a file descriptor. Call this before closing it.
+void posix_poll_unregister(int fd) {
+	for (int i=0; i<posix_poll_nr_fds; i++) {
+		if (posix_poll_fds[i].fd == fd) {
+			posix_poll_fds[i] = posix_poll_fds[--posix_poll_nr_fds];
+			return;
+		}
+	}
+}
+
+static void posix_poll_idle(void *data) {
+	dj_time_t timeout = *((dj_time_t *)data);
+	int msec;
+
+	if (timeout < 0)
+		msec = -1;
+	else if (timeout > INT_MAX)
+		msec = INT_MAX;
+	else
+		msec = (int)timeout;
+
+	if (posix_poll_incomplete && (msec < 0 || msec > POSIX_POLL_FALLBACK_TIMEOUT))
+		msec = POSIX_POLL_FALLBACK_TIMEOUT;
+
+	// The result doesn't matter: whatever woke us up, the caller polls all radios next.
+	if (poll(posix_poll_fds, posix_poll_nr_fds, msec) < 0 && errno != EINTR)
+		DEBUG_LOG(DBG_DARJEELING, "posix_poll_idle: poll failed: %d\n", errno);
+}
+
+void posix_poll_init() {
+	posix_poll_idleHook.function = posix_poll_idle;
+	dj_hook_add(&dj_core_idleHook, &posix_poll_idleHook);
+}
@@ -13,20 +13,22 @@
 #include "djarchive.h"
 #include "pointerwidth.h"
 
-char * ref_t_base_address;
+DJ_VM_LOCAL char * ref_t_base_address;
 
 char** posix_argv;
 char* posix_uart_filenames[4];
-bool posix_arg_addnode = false;
-uint32_t posix_local_network_id = 0;
+DJ_VM_LOCAL bool posix_arg_addnode = false;
+DJ_VM_LOCAL uint32_t posix_local_network_id = 0;
 char* posix_pc_network_directory = "./djnetwork";
 bool posix_pc_network_directory_specified = false;
 char* posix_network_server_address = "127.0.0.1";
 int posix_network_server_port = 10008;
 char* posix_interface_name = "wlan0";
 char* posix_enabled_wuclasses_xml = NULL;
-char posix_config_filename[1024];
-char posix_app_infusion_filename[1024];
+DJ_VM_LOCAL char posix_config_filename[1024];
+DJ_VM_LOCAL char posix_app_infusion_filename[1024];
+uint32_t posix_heap_size = HEAPSIZE;
+int posix_nr_nodes = 1;
 
 void posix_print_commandline_help() {
 	printf(
@@ -42,6 +44,8 @@ void posix_print_commandline_help() {
 "  -s, --network_server address[:port]    Connect to the WuKongNetworkServer running at address. The port is optional, and is 10008 by default.\n"
 "  -i, --network_server_id id             Set the id this client will use to connect to WuKongNetworkServer.java\n"
 "  -n, --interface_name name              The network interface name to connect to gateway\n"
+"  -m, --heap-size size                   Set the size of the VM heap in bytes, optionally followed by k or m. The default is set by HEAPSIZE in config.h.\n"
+"                                         Heaps over 64 KB need a build with HEAP_32BIT defined in config.h.\n"
 "\n"
 "OPTIONS FOR POSIX_PC PLATFORM ONLY:\n"
 "  -d, --network_directory dir            Set the directory to use to simulate sensors and actuators. A subdirectory node_id will be created for each node.\n"
@@ -53,6 +57,9 @@ void posix_print_commandline_help() {
 "                                         This is to make sure each node in a simulated network has it's own application and configuration settings.\n"
 "  -e, --enabled_wuclasses_xml file       Instead of using the generated wkpf_native_wuclasses_init, read the configuration from file at startup.\n"
 "                                         (needs to be enabled in config.h by defining LOAD_ENABLED_WUCLASSES_AT_STARTUP)\n"
+"  -N, --nodes count                      Run count nodes in this process, each in its own thread, with network ids starting at the one set by -i.\n"
+"                                         Requires -d so each node gets its own application and configuration.\n"
+"                                         (needs to be enabled in config.h by defining DJ_MULTI_VM)\n"
 	);
 }
 
@@ -92,12 +99,44 @@ void posix_parse_interface_name_arg(char *arg){
 	printf("[posix platform parameters] Interface name: %s\n", posix_interface_name);
 }
 
+void posix_parse_heap_size_arg(char *arg) {
+	char *end;
+	unsigned long size = strtoul(arg, &end, 10);
+	if (*end == 'k' || *end == 'K') {
+		size *= 1024;
+		end++;
+	} else if (*end == 'm' || *end == 'M') {
+		size *= 1024*1024;
+		end++;
+	}
+	// Leave room for the offset between ref_t_base_address and the heap, so the last object can still be referenced
+	if (end == arg || *end != 0 || size < 1024 || size > (heap_size_t)~0 - 64) {
+		printf("option -m/--heap-size: size must be between 1024 and %lu bytes.\n", (unsigned long)((heap_size_t)~0 - 64));
+		abort();
+	}
+	posix_heap_size = size;
+	printf("[posix platform parameters] Heap size: %u\n", posix_heap_size);
+}
+
 void posix_parse_network_directory_arg(char *arg) {
 	posix_pc_network_directory = optarg;
 	posix_pc_network_directory_specified = true;
 	printf("[posix platform parameters] Sensor IO file system at: %s\n", posix_pc_network_directory);
 }
 
+void posix_parse_nodes_arg(char *arg) {
+	posix_nr_nodes = atoi(arg);
+#ifdef DJ_MULTI_VM
+	if (posix_nr_nodes < 1) {
+#else
+	if (posix_nr_nodes != 1) {
+#endif
+		printf("option -N/--nodes: this build can only run 1 node per process (define DJ_MULTI_VM in config.h to run more).\n");
+		abort();
+	}
+	printf("[posix platform parameters] Number of nodes: %d\n", posix_nr_nodes);
+}
+
 void posix_get_node_directory(char* dest, int maxlen) {
 	snprintf(dest, maxlen, "%s/node_%d", posix_pc_network_directory, posix_local_network_id);
 	if (access(dest, F_OK) == -1) {
@@ -152,13 +191,15 @@ void posix_parse_command_line(int argc, char* argv[]) {
 			{"network_server_id",      required_argument, 0, 'i'},
 			{"network_directory",      required_argument, 0, 'd'},
 			{"interface_name", 		required_argument, 0, 'n'},
+			{"heap-size",      required_argument, 0, 'm'},
+			{"nodes",      required_argument, 0, 'N'},
 			{0, 0, 0, 0}
 		};
 
 		/* getopt_long stores the option index here. */
 		int option_index = 0;
 
-		c = getopt_long (argc, argv, "hau:s:i:d:e:n:",
+		c = getopt_long (argc, argv, "hau:s:i:d:e:n:m:N:",
 		    long_options, &option_index);
 
 		/* Detect the end of the options. */
@@ -187,6 +228,12 @@ void posix_parse_command_line(int argc, char* argv[]) {
 			case 'n':
 				posix_parse_interface_name_arg(optarg);
 				break;
+			case 'm':
+				posix_parse_heap_size_arg(optarg);
+				break;
+			case 'N':
+				posix_parse_nodes_arg(optarg);
+				break;
 			case 'e':
 				posix_enabled_wuclasses_xml = optarg;
 				printf("[posix platform parameters] Using enabled wuclasses xml in: %s\n", posix_enabled_wuclasses_xml);
@@ -195,6 +242,10 @@ void posix_parse_command_line(int argc, char* argv[]) {
 				abort ();
 		}
 	}
+	if (posix_nr_nodes > 1 && !posix_pc_network_directory_specified) {
+		printf("option -N/--nodes: running more than 1 node requires a network directory (-d).\n");
+		abort();
+	}
 	posix_determine_app_archive_and_config_file();
 }
 
@@ -9,13 +9,19 @@
 #define RUNLEVEL_PANIC             3 // All runlevels higher than this, as defined in panic.h, are panic runlevels.
 
 // For libraries that need frequent polling. Currently just for radios, but maybe there are other uses. Should be fast.
-extern dj_hook *dj_core_pollingHook;
-extern dj_hook *dj_core_shutdownHook;
+extern DJ_VM_LOCAL dj_hook *dj_core_pollingHook;
+extern DJ_VM_LOCAL dj_hook *dj_core_shutdownHook;
+// Called by dj_core_idle when there is nothing to do. data points to a dj_time_t holding the maximum number of
+// milliseconds to wait, or -1 to wait until some event happens. Platforms that can block until I/O is ready register
+// a hook here, on other platforms dj_core_idle returns immediately and the main loops keep polling.
+extern DJ_VM_LOCAL dj_hook *dj_core_idleHook;
 
-extern uint8_t dj_exec_runlevel;
+extern DJ_VM_LOCAL uint8_t dj_exec_runlevel;
 #define dj_exec_setRunlevel(runlevel)			(dj_exec_runlevel = runlevel)
 #define dj_exec_getRunlevel()					(dj_exec_runlevel)
 
 extern void core_init(void *mem, uint32_t memsize);
+extern void dj_core_requestWakeup(dj_time_t time);
+extern void dj_core_idle(dj_time_t timeout);
 
 #endif // COREH
\ No newline at end of file
@@ -65,6 +65,7 @@
 
 // platform-specific header file
 #include "config.h"
+#include "types.h"
 
 // Turn of debug traces by default, unless turned on in config.h
 #ifndef DBG_DARJEELING
@@ -128,8 +129,8 @@
  * beeing stored  in RAM on the AVR,  but hey, this is  debug code)
  */
 
-/*extern*/ int  darjeeling_debug_nesting_level;
-/*extern*/ int  darjeeling_debug_indent_index;
+extern DJ_VM_LOCAL int  darjeeling_debug_nesting_level;
+extern DJ_VM_LOCAL int  darjeeling_debug_indent_index;
 
 #define DEBUG_LOG(type, format, args...) if (type) do {                 \
         DEBUG_PRINT_INDENT;                                             \
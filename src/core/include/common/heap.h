@@ -27,10 +27,14 @@
 #include "hooks.h"
 
 // To let other libraries hook into the garbage collector.
-extern dj_hook *dj_mem_markRootSetHook;
-extern dj_hook *dj_mem_markObjectHook;
-extern dj_hook *dj_mem_updateReferenceHook;
-extern dj_hook *dj_mem_postGCHook;
+extern DJ_VM_LOCAL dj_hook *dj_mem_markRootSetHook;
+extern DJ_VM_LOCAL dj_hook *dj_mem_markObjectHook;
+extern DJ_VM_LOCAL dj_hook *dj_mem_updateReferenceHook;
+extern DJ_VM_LOCAL dj_hook *dj_mem_postGCHook;
+#ifdef ALLOC_PROFILER
+// Called with a pointer to every new chunk. Callbacks must not allocate.
+extern DJ_VM_LOCAL dj_hook *dj_mem_allocHook;
+#endif
 
 #define SAFE_POINTER_POOL_SIZE 4
 
@@ -45,7 +49,7 @@ enum chunk_id
 	CHUNKID_FREE=0,
 	CHUNKID_INVALID=1,
 
-	CHUNKID_MONITOR_BLOCK=2,
+	CHUNKID_MONITOR_TABLE=2,
 	CHUNKID_VM=3,
 	CHUNKID_FRAME=4,
 	CHUNKID_THREAD=5,
@@ -59,12 +63,38 @@ enum chunk_id
 	CHUNKID_WUCLASS=9,
 	CHUNKID_WUOBJECT=10,
 
-	CHUNKID_JAVA_START=11
+	CHUNKID_CLASS_TABLE=11,
+
+	// only allocate ids for the optional tables that are compiled in: the runtime class ids start at
+	// CHUNKID_JAVA_START and share the 8-bit id space, so every id reserved here is one Java class less
+#ifdef VM_FLATTENED_VTABLES
+	CHUNKID_VTABLES,
+#endif
+#ifdef THREAD_FRAME_STACK
+	CHUNKID_FRAME_STACK,
+#endif
+#ifdef VM_TYPE_DISPLAYS
+	CHUNKID_TYPE_TABLE,
+#endif
+
+	CHUNKID_JAVA_START
 
 };
 
 typedef struct _heap_chunk heap_chunk;
 
+/**
+ * Sizes of and offsets into the heap. With HEAP_32BIT these are 32 bits wide, as are references, so that the heap
+ * can be larger than 64 KB and chunks larger than 16 KB.
+ */
+#ifdef HEAP_32BIT
+typedef uint32_t heap_size_t;
+#define HEAP_MAX_CHUNK_SIZE 0x3fffffff
+#else
+typedef uint16_t heap_size_t;
+#define HEAP_MAX_CHUNK_SIZE 0x3fff
+#endif
+
 /**
  *
  */
@@ -78,9 +108,15 @@ enum
 // TODO the size:14 bit field notation is a GCC extension - refactor for compatibility with other compilers
 struct _heap_chunk
 {
+#ifdef HEAP_32BIT
+	uint32_t color:2;
+	uint32_t size:30;
+	uint32_t shift;
+#else
 	uint16_t color:2;
 	uint16_t size:14;
 	uint16_t shift;
+#endif
 	uint8_t id;
 #ifdef ALIGN_16
 	uint8_t PADDING;
@@ -91,10 +127,29 @@ __attribute__ ((__packed__))
 #endif
 ;
 
-void dj_mem_init(void *mem_pointer, uint16_t mem_size);
-void * dj_mem_alloc(uint16_t size, runtime_id_t id);
-uint16_t dj_mem_getFree();
-uint16_t dj_mem_getSize();
+/**
+ * Statistics of a garbage collection. A pointer to this struct is passed to the dj_mem_postGCHook callbacks.
+ * For incremental collections the pause is that of the final step, in which dead chunks are reclaimed.
+ */
+typedef struct _dj_mem_gc_info
+{
+	uint16_t pause;			// duration in milliseconds
+	heap_size_t reclaimed;	// bytes reclaimed
+	heap_size_t live;		// bytes in use after the collection, including chunk headers
+	heap_size_t nr_chunks;	// chunks in use after the collection
+	heap_size_t free;		// bytes free after the collection
+	heap_size_t largest_free;	// largest contiguous free block after the collection
+	heap_size_t nr_moved;	// chunks moved by compaction
+	uint8_t flags;			// DJ_MEM_GC_COMPACTED, DJ_MEM_GC_INCREMENTAL
+} dj_mem_gc_info;
+
+#define DJ_MEM_GC_COMPACTED 1
+#define DJ_MEM_GC_INCREMENTAL 2
+
+void dj_mem_init(void *mem_pointer, heap_size_t mem_size);
+void * dj_mem_alloc(heap_size_t size, runtime_id_t id);
+heap_size_t dj_mem_getFree();
+heap_size_t dj_mem_getSize();
 
 void dj_mem_free(void *ptr);
 
@@ -107,6 +162,10 @@ heap_chunk * dj_mem_getNextChunk(heap_chunk *currentChunk);
 
 void dj_mem_gc();
 
+#ifdef GC_MARK_STACK
+void dj_mem_pushGrayChunk(heap_chunk *chunk);
+#endif
+
 void * dj_mem_getPointer();
 
 void dj_mem_shiftRuntimeIDs(runtime_id_t start, uint16_t range);
@@ -134,12 +193,12 @@ static inline void dj_mem_setChunkId(void *ptr, uint8_t id)
 	((heap_chunk*)((size_t)ptr-sizeof(heap_chunk)))->id = id;
 }
 
-static inline uint16_t dj_mem_getChunkSize(void *ptr)
+static inline heap_size_t dj_mem_getChunkSize(void *ptr)
 {
 	return ((heap_chunk*)((size_t)ptr-sizeof(heap_chunk)))->size;
 }
 
-static inline uint16_t dj_mem_getChunkShift(void *ptr)
+static inline heap_size_t dj_mem_getChunkShift(void *ptr)
 {
 	return ((heap_chunk*)((size_t)ptr-sizeof(heap_chunk)))->shift;
 }
@@ -157,6 +216,9 @@ static inline ref_t dj_mem_getUpdatedReference(ref_t ref)
 static inline void dj_mem_setChunkColor(void *ptr, int color)
 {
 	((heap_chunk*)((size_t)ptr - sizeof(heap_chunk)))->color = color;
+#ifdef GC_MARK_STACK
+	if (color==TCM_GRAY) dj_mem_pushGrayChunk((heap_chunk*)((size_t)ptr - sizeof(heap_chunk)));
+#endif
 }
 
 static inline int dj_mem_getChunkColor(void *ptr)
@@ -168,14 +230,26 @@ static inline void dj_mem_setRefGrayIfWhite(ref_t ref)
 {
 	if (ref==nullref) return;
 	heap_chunk * chunk = ((heap_chunk*)((size_t)REF_TO_VOIDP(ref) - sizeof(heap_chunk)));
-	if (chunk->color==TCM_WHITE) chunk->color=TCM_GRAY;
+	if (chunk->color==TCM_WHITE)
+	{
+		chunk->color=TCM_GRAY;
+#ifdef GC_MARK_STACK
+		dj_mem_pushGrayChunk(chunk);
+#endif
+	}
 }
 
 static inline void dj_mem_setPointerGrayIfWhite(void * ptr)
 {
 	if (ptr == NULL) return;
 	heap_chunk * chunk = ((heap_chunk*)((size_t)ptr - sizeof(heap_chunk)));
-	if (chunk->color==TCM_WHITE) chunk->color=TCM_GRAY;
+	if (chunk->color==TCM_WHITE)
+	{
+		chunk->color=TCM_GRAY;
+#ifdef GC_MARK_STACK
+		dj_mem_pushGrayChunk(chunk);
+#endif
+	}
 }
 
 static inline void dj_mem_setRefColor(ref_t ref, int color)
@@ -184,4 +258,23 @@ static inline void dj_mem_setRefColor(ref_t ref, int color)
 	dj_mem_setChunkColor(REF_TO_VOIDP(ref), color);
 }
 
+#ifdef GC_INCREMENTAL
+extern DJ_VM_LOCAL bool dj_mem_gcMarking;
+
+void dj_mem_gcStep();
+void dj_mem_printGCStats();
+
+/**
+ * Write barrier for incremental collection. Must be called with every reference that is stored into a heap object
+ * (object fields, array elements, static fields), so that a reference stored into an object that has already been
+ * marked is not missed.
+ * @param ref the reference being stored
+ */
+static inline void dj_mem_writeBarrier(ref_t ref)
+{
+	if (dj_mem_gcMarking)
+		dj_mem_setRefGrayIfWhite(ref);
+}
+#endif
+
 #endif
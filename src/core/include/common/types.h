@@ -28,6 +28,16 @@
 
 // platform-specific header files
 #include "config.h"
+
+// Storage class of global variables that hold the state of a single VM instance. Normally
+// there is only one VM per process and this expands to nothing. With DJ_MULTI_VM each thread
+// gets its own copy of these variables, so several nodes can run side by side in one process.
+#ifdef DJ_MULTI_VM
+#define DJ_VM_LOCAL __thread
+#else
+#define DJ_VM_LOCAL
+#endif
+
 #include "program_mem.h"
 #include "pointerwidth.h"
 
@@ -40,8 +50,8 @@
 typedef uint16_t runtime_id_t;
 typedef long long int dj_time_t;
 
-// keep this a multiple of 2, to keep the size of the blocks a multiple of 2 (for 16-bit architectures)
-#define MONITOR_BLOCK_SIZE 8
+// initial number of slots in the monitor hash table. Must be a power of two, the table doubles when it fills up
+#define MONITOR_TABLE_INITIAL_SIZE 8
 
 typedef struct _dj_local_id dj_local_id;
 typedef struct _dj_global_id dj_global_id;
@@ -51,12 +61,18 @@ typedef struct _dj_object dj_object;
 typedef struct _dj_thread dj_thread;
 typedef struct _dj_frame dj_frame;
 typedef struct _dj_monitor dj_monitor;
-typedef struct _dj_monitor_block dj_monitor_block;
+typedef struct _dj_monitor_table dj_monitor_table;
 
 typedef struct _dj_infusion dj_infusion;
 typedef struct _dj_vm dj_vm;
 typedef struct _dj_named_native_handler dj_named_native_handler;
 
+typedef struct _dj_vtable_entry dj_vtable_entry;
+typedef struct _dj_vtables dj_vtables;
+typedef struct _dj_class_table dj_class_table;
+typedef struct _dj_type_table_entry dj_type_table_entry;
+typedef struct _dj_type_table dj_type_table;
+
 /**
  * A two-byte typle that references entities. The infusion_id points to an infusion and the entity_id indexes
  * a certain entity within that infusion. The local ID is called 'local' because it only makes sense within the context of
@@ -113,8 +129,11 @@ struct _dj_frame
 //	dj_infusion * infusion;						// for resolving references
 //	dj_di_pointer method;						// method that is executing in this frame
 	dj_global_id method;
+	dj_di_pointer methodImplementation;			// resolved method implementation, cached at frame creation
 
 	uint16_t pc;								// program counter, return adress
+	uint16_t local_ref_offset;					// offset of the reference local variables (end of the operand stack)
+	uint16_t local_int_offset;					// offset of the integer local variables
 	uint8_t nr_int_stack;						// the number of values on the integer stack
 	uint8_t nr_ref_stack;						// the number of values on the reference stack
 }
@@ -141,6 +160,26 @@ struct _dj_thread
 	// threads are stored as a linked list
 	dj_thread * next;
 
+	// link in the ready queue, or in the entry or wait queue of a monitor
+	dj_thread * queueNext;
+
+	// links in the timer heap (pairing heap ordered on scheduleTime). heapPrev points to the parent for the first
+	// child, and to the previous sibling otherwise
+	dj_thread * heapChild;
+	dj_thread * heapSibling;
+	dj_thread * heapPrev;
+
+	// DJ_THREAD_QUEUED_* flags, see scheduler.h
+	uint8_t queued;
+
+	// recursion count of the monitor to restore when the thread gets it back, see dj_scheduler_releaseMonitor
+	uint8_t monitorCount;
+
+#ifdef THREAD_FRAME_STACK
+	// contiguous segment that holds the frames of this thread
+	void * frameSegment;
+#endif
+
 }
 #ifdef PACK_STRUCTS
 __attribute__ ((__packed__))
@@ -151,22 +190,109 @@ struct _dj_monitor
 {
 	dj_object * object;
 	dj_thread * owner;
+	dj_thread * blocked;						// tail of the circular FIFO of threads blocked on entering the monitor
+	dj_thread * waiting;						// tail of the circular FIFO of threads in wait()
 	uint8_t count;
 	uint8_t waiting_threads;
+	uint8_t rehashed;							// used while rehashing the monitor table after compaction
 }
 #ifdef PACK_STRUCTS
 __attribute__ ((__packed__))
 #endif
 ;
 
-struct _dj_monitor_block
+/**
+ * Open-addressed hash table of monitors, keyed on the address of the lock object and probed linearly. Empty slots
+ * have a NULL object. Since compaction moves the lock objects, the table is rehashed in place when pointers are
+ * updated, see dj_monitor_table_updatePointers.
+ */
+struct _dj_monitor_table
 {
-	dj_monitor_block *next;
-	dj_monitor monitors[MONITOR_BLOCK_SIZE];
-	uint8_t count;
-#ifdef ALIGN_16
-	uint8_t PADDING;
+	uint16_t capacity;
+	dj_monitor monitors[];
+}
+#ifdef PACK_STRUCTS
+__attribute__ ((__packed__))
 #endif
+;
+
+/**
+ * An entry in a flattened virtual method table. The definition key holds the vtable index of the infusion that
+ * contains the method definition in the high byte and the definition's entity id in the low byte.
+ */
+struct _dj_vtable_entry
+{
+	uint16_t definition;
+	uint8_t implementation_infusion;
+	uint8_t implementation_entity;
+}
+#ifdef PACK_STRUCTS
+__attribute__ ((__packed__))
+#endif
+;
+
+/**
+ * Flattened virtual method tables for all loaded classes, stored in a single heap chunk. The header is followed by
+ * nr_infusions infusion pointers, an index of nr_classes+1 entry offsets (one for each runtime class id starting at
+ * CHUNKID_JAVA_START), and the entries, sorted by definition key for each class.
+ */
+struct _dj_vtables
+{
+	uint16_t nr_classes;
+	uint16_t nr_entries;
+	uint8_t nr_infusions;
+	dj_infusion * infusions[];
+}
+#ifdef PACK_STRUCTS
+__attribute__ ((__packed__))
+#endif
+;
+
+/**
+ * Maps runtime class ids to the infusions that hold the class definitions. The header is followed by nr_infusions
+ * infusion pointers and, for each runtime class id starting at CHUNKID_JAVA_START, the index of its infusion in that
+ * array.
+ */
+struct _dj_class_table
+{
+	uint16_t nr_classes;
+	uint8_t nr_infusions;
+	dj_infusion * infusions[];
+}
+#ifdef PACK_STRUCTS
+__attribute__ ((__packed__))
+#endif
+;
+
+/**
+ * Type information for one runtime class. display is the offset of the class's ancestor list in the display area of
+ * the type table, and depth the number of superclasses between the class and java.lang.Object. interface_index is the
+ * bit assigned to the class in the interface bitsets, or 0xff if no class implements it.
+ */
+struct _dj_type_table_entry
+{
+	uint16_t display;
+	uint8_t depth;
+	uint8_t interface_index;
+}
+#ifdef PACK_STRUCTS
+__attribute__ ((__packed__))
+#endif
+;
+
+/**
+ * Supertype displays and interface bitsets for all loaded classes, stored in a single heap chunk. The header is
+ * followed by display_size bytes holding the ancestors of each class (class indices relative to CHUNKID_JAVA_START,
+ * from java.lang.Object down to the class itself), and then a bitset of bitset_size bytes per class holding the
+ * interfaces it implements.
+ */
+struct _dj_type_table
+{
+	uint16_t nr_classes;
+	uint16_t display_size;
+	uint8_t nr_interfaces;
+	uint8_t bitset_size;
+	dj_type_table_entry entries[];
 }
 #ifdef PACK_STRUCTS
 __attribute__ ((__packed__))
@@ -194,6 +320,11 @@ struct _dj_infusion
 	// nr of referenced infusions
 	uint8_t nr_referenced_infusions;
 
+#ifdef VM_FLATTENED_VTABLES
+	// index of this infusion in the flattened method tables
+	uint8_t vtable_index;
+#endif
+
 	// Infusions are stored as a linked list
 	dj_infusion * next;
 
@@ -231,7 +362,24 @@ struct _dj_vm
 
 	dj_infusion *infusions;
 	dj_thread *threads;
-	dj_monitor_block *monitors;
+	dj_monitor_table *monitors;
+
+	// scheduler state, see scheduler.c
+	dj_thread *readyHead;
+	dj_thread *readyTail;
+	dj_thread *timerHeap;
+	uint16_t nrReady;
+
+	// runtime class id lookup table
+	dj_class_table *classTable;
+
+#ifdef VM_FLATTENED_VTABLES
+	dj_vtables *vtables;
+#endif
+
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table *typeTable;
+#endif
 
 }
 #ifdef PACK_STRUCTS
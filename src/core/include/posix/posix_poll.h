@@ -0,0 +1,16 @@
+#ifndef POSIX_POLLH
+#define POSIX_POLLH
+
+#include "types.h"
+
+// Maximum number of file descriptors that can be registered with posix_poll_register.
+#define POSIX_POLL_MAX_FDS 8
+
+// Longest time in milliseconds to sleep once a file descriptor couldn't be registered, since we can't wake up for it.
+#define POSIX_POLL_FALLBACK_TIMEOUT 10
+
+extern void posix_poll_init();
+extern bool posix_poll_register(int fd);
+extern void posix_poll_unregister(int fd);
+
+#endif // POSIX_POLLH
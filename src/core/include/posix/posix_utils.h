@@ -6,17 +6,20 @@
 extern dj_di_pointer posix_load_infusion_archive(char *filename);
 extern void posix_parse_command_line(int argc, char* argv[]);
 extern void posix_get_node_directory(char* dest, int maxlen);
+extern void posix_determine_app_archive_and_config_file();
 
 extern char** posix_argv;
 extern char* posix_uart_filenames[4];
-extern bool posix_arg_addnode;
-extern uint32_t posix_local_network_id;
+extern DJ_VM_LOCAL bool posix_arg_addnode;
+extern DJ_VM_LOCAL uint32_t posix_local_network_id;
 extern char* posix_pc_network_directory;
 extern char* posix_network_server_address;
 extern char* posix_interface_name;
 extern int posix_network_server_port;
 extern char* posix_enabled_wuclasses_xml;
-extern char posix_config_filename[1024];
-extern char posix_app_infusion_filename[1024];
+extern DJ_VM_LOCAL char posix_config_filename[1024];
+extern DJ_VM_LOCAL char posix_app_infusion_filename[1024];
+extern uint32_t posix_heap_size;
+extern int posix_nr_nodes;
 
 #endif // POSIX_UTILSH
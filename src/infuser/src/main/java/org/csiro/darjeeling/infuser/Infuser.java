@@ -38,6 +38,7 @@ import javax.xml.transform.TransformerFactory;
 import javax.xml.transform.dom.DOMSource;
 import javax.xml.transform.stream.StreamResult;
 
+import org.csiro.darjeeling.infuser.bytecode.transformations.SuperInstructions;
 import org.csiro.darjeeling.infuser.checkphase.ClassResolveVisitor;
 import org.csiro.darjeeling.infuser.checkphase.InstructionsImplementedCheckVisitor;
 import org.csiro.darjeeling.infuser.checkphase.JavaClassCheckVisitor;
@@ -50,12 +51,14 @@ import org.csiro.darjeeling.infuser.outputphase.DebugVisitor;
 import org.csiro.darjeeling.infuser.outputphase.HeaderVisitor;
 import org.csiro.darjeeling.infuser.processingphase.ClassInitialiserResolutionVisitor;
 import org.csiro.darjeeling.infuser.processingphase.CodeBlockVisitor;
+import org.csiro.darjeeling.infuser.processingphase.CompileMethodsVisitor;
 import org.csiro.darjeeling.infuser.processingphase.FieldMapVisitor;
 import org.csiro.darjeeling.infuser.processingphase.FindEntryPointVisitor;
 import org.csiro.darjeeling.infuser.processingphase.HeaderResolutionVisitor;
 import org.csiro.darjeeling.infuser.processingphase.IndexVisitor;
 import org.csiro.darjeeling.infuser.processingphase.InterfaceListFlattenVisitor;
 import org.csiro.darjeeling.infuser.processingphase.StringTableVisitor;
+import org.csiro.darjeeling.infuser.structure.TypeClass;
 import org.csiro.darjeeling.infuser.structure.elements.internal.InternalInfusion;
 import org.w3c.dom.Document;
 
@@ -70,7 +73,7 @@ import org.w3c.dom.Document;
 public class Infuser
 {
 	// Version of the infusion format. VM should check if it matches the VM's format
-	public static int infusionFormatVersion = 3; // 1: original, 2: RTC, 3: 32 bit addresses
+	public static int infusionFormatVersion = 3; // 1: original, 2: RTC, 3: 32 bit addresses, 4: 3 with 32 bit operand slots
 
 	// never start with version 1.0.0 :-)
 	public static final String version = "1.1.12";
@@ -284,6 +287,10 @@ public class Infuser
 		
 		// process bytecode
 		infusion.accept(new CodeBlockVisitor(infusion));
+		
+		// compile method implementations to C (optional)
+		if (infuserArguments.isCompileMethods())
+			infusion.accept(new CompileMethodsVisitor());
 
 		// some profiling output for the SenSys paper
 		// infusion.accept(new StackSizeVisitor());
@@ -308,6 +315,13 @@ public class Infuser
 		
 		// Logging.instance.addVerbose(VerboseOutputType.ARGUMENTS_PARSING);
 		
+		// select the operand slot layout of the target VM, the slot counts in the infusion depend on it
+		TypeClass.setSlotWidth(infuserArguments.getSlotWidth());
+		infusionFormatVersion = (infuserArguments.getSlotWidth()==32) ? 4 : 3;
+		
+		// fused instructions need a VM built with EXECUTION_SUPERINSTRUCTIONS
+		SuperInstructions.setEnabled(infuserArguments.isSuperInstructions());
+		
 		// create an infusion
 		InternalInfusion infusion = infuserArguments.createInfusion();
 
@@ -67,6 +67,15 @@ public class InfuserArguments
 	// Lists of input files
 	private ArrayList<String> classFiles, headerFiles;
 	
+	// When set, methods that can be compiled ahead of time are written to the native (.c) output file
+	private boolean compileMethods;
+	
+	// Width of the integer operand stack slots of the target VM in bits (16 or 32)
+	private int slotWidth = 16;
+	
+	// When set, common instruction sequences are replaced by fused instructions
+	private boolean superInstructions;
+	
 	// Used for caching the last modified time so that it is not recalculated
 	// for every getLastModified call
 	private long lastModified = 0;
@@ -153,6 +162,17 @@ public class InfuserArguments
 		if (name.equals("h")) { this.headerOutputFile = value; return; }
 		if (name.equals("d")) { this.cHeaderOutputFile = value; return; }
 		if (name.equals("n")) { this.cCodeOutputFile = value; return; }
+		if (name.equals("aot")) { this.compileMethods = Boolean.parseBoolean(value); return; }
+		if (name.equals("superinstructions")) { this.superInstructions = Boolean.parseBoolean(value); return; }
+		
+		// operand slot width
+		if (name.equals("slotwidth"))
+		{
+			if (!value.equals("16") && !value.equals("32"))
+				throw new ArgumentParseException("The value for option 'slotwidth' should be 16 or 32");
+			this.slotWidth = Integer.parseInt(value);
+			return;
+		}
 	
 		// infusion version
 		if (name.equals("infusionversion"))
@@ -371,5 +391,37 @@ public class InfuserArguments
 	{
 		return debugOutputFile;
 	}
+	
+	public void setCompileMethods(boolean compileMethods)
+	{
+		this.compileMethods = compileMethods;
+	}
+	
+	public boolean isCompileMethods()
+	{
+		return compileMethods;
+	}
+	
+	public void setSlotWidth(int slotWidth)
+	{
+		if (slotWidth!=16 && slotWidth!=32)
+			throw new ArgumentParseException("The slot width should be 16 or 32");
+		this.slotWidth = slotWidth;
+	}
+	
+	public int getSlotWidth()
+	{
+		return slotWidth;
+	}
+	
+	public void setSuperInstructions(boolean superInstructions)
+	{
+		this.superInstructions = superInstructions;
+	}
+	
+	public boolean isSuperInstructions()
+	{
+		return superInstructions;
+	}
 
 }
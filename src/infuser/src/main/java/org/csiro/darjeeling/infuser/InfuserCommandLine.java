@@ -36,6 +36,9 @@ public class InfuserCommandLine
 		System.out.println("\t-d=<file>\t\t\t\tOutput c definitions header file (.h)");
 		System.out.println("\t-name=<arg>\t\t\t\tInfusion name");
 		System.out.println("\t-infusionversion=<arg>\t\t\tInfusion version (integer)");
+		System.out.println("\t-aot=<true|false>\t\t\tCompile methods to C in the native file (-n)");
+		System.out.println("\t-slotwidth=<16|32>\t\t\tOperand stack slot width of the VM in bits");
+		System.out.println("\t-superinstructions=<true|false>\t\tFuse common instruction sequences");
 		System.out.println("");
 		System.out.println("Examples:");
 		System.out.println("\tinfuser include/sys.dih HelloWorld.class -name=hello -o test.di");
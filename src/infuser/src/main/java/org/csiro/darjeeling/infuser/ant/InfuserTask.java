@@ -162,4 +162,19 @@ public class InfuserTask extends Task
 		infuserArguments.setDebugOutputFile(debug);
 	}
 	
+	public void setAot(boolean aot)
+	{
+		infuserArguments.setCompileMethods(aot);
+	}
+	
+	public void setSlotwidth(int slotWidth)
+	{
+		infuserArguments.setSlotWidth(slotWidth);
+	}
+	
+	public void setSuperinstructions(boolean superInstructions)
+	{
+		infuserArguments.setSuperInstructions(superInstructions);
+	}
+	
 }
@@ -36,6 +36,7 @@ import org.csiro.darjeeling.infuser.bytecode.transformations.InsertExplicitCasts
 import org.csiro.darjeeling.infuser.bytecode.transformations.OptimizeByteCode;
 import org.csiro.darjeeling.infuser.bytecode.transformations.ReMapLocalVariables;
 import org.csiro.darjeeling.infuser.bytecode.transformations.ReplaceStackInstructions;
+import org.csiro.darjeeling.infuser.bytecode.transformations.SuperInstructions;
 import org.csiro.darjeeling.infuser.structure.BaseType;
 import org.csiro.darjeeling.infuser.structure.LocalId;
 import org.csiro.darjeeling.infuser.structure.elements.AbstractClassDefinition;
@@ -296,6 +297,10 @@ public class CodeBlock
 		// assign indices to the local variables
 		new ReMapLocalVariables(ret).transform();
 
+		// fuse common instruction sequences (optional)
+		if (SuperInstructions.isEnabled())
+			new SuperInstructions(ret).transform();
+
 		// fix the branch addresses in the branch instructions
 		ret.instructions.fixBranchAddresses();
 		
@@ -0,0 +1,962 @@
+/*
+ * CodeBlockCompiler.java
+ *
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ *
+ * This file is part of Darjeeling.
+ *
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package org.csiro.darjeeling.infuser.bytecode;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.TreeMap;
+
+import org.csiro.darjeeling.infuser.bytecode.instructions.FieldInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.IncreaseInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LoadBranchInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LoadStoreInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LocalIdInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LocalVariableInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LookupSwitchInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.PushInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.TableSwitchInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.WideIncreaseInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.WideStackInstruction;
+import org.csiro.darjeeling.infuser.structure.BaseType;
+import org.csiro.darjeeling.infuser.structure.LocalId;
+import org.csiro.darjeeling.infuser.structure.elements.internal.InternalMethodImplementation;
+
+/**
+ * Translates the DVM byte code of a method implementation into the body of a C function, so that the method can
+ * run without the interpreter. The generated function follows the calling convention of native methods: it pops
+ * its parameters (including the object reference for virtual methods) off the caller's operand stacks, and pushes
+ * the return value.
+ * <p>
+ * The operand stacks are resolved at compile time. Every stack slot and local variable becomes a C variable, named
+ * after its kind and position, so the stack layout before each instruction has to be the same on every path that
+ * reaches it. Only leaf methods are compiled: methods that invoke other methods, allocate objects, have exception
+ * handlers, or are synchronized stay interpreted, and compile() returns null for them.
+ */
+public class CodeBlockCompiler
+{
+
+	// Thrown when the code block uses something the compiler doesn't translate
+	private static class UnsupportedException extends Exception
+	{
+		private static final long serialVersionUID = 1L;
+
+		public UnsupportedException(String message)
+		{
+			super(message);
+		}
+	}
+
+	// A value on the integer operand stack. The kind is 's', 'i' or 'l' for short, int and long values, or 'p' for
+	// what's left of a value of which only some of the slots were popped. The size is in slots.
+	private static class StackValue
+	{
+		private char kind;
+		private int size;
+
+		public StackValue(char kind, int size)
+		{
+			this.kind = kind;
+			this.size = size;
+		}
+	}
+
+	// The layout of the integer and reference operand stacks before an instruction
+	private static class StackState
+	{
+		private ArrayList<StackValue> ints = new ArrayList<StackValue>();
+		private int refs = 0;
+
+		public StackState copy()
+		{
+			StackState ret = new StackState();
+			ret.ints.addAll(ints);
+			ret.refs = refs;
+			return ret;
+		}
+
+		public boolean sameLayout(StackState other)
+		{
+			if (ints.size()!=other.ints.size() || refs!=other.refs) return false;
+			for (int i=0; i<ints.size(); i++)
+				if (ints.get(i).kind!=other.ints.get(i).kind || ints.get(i).size!=other.ints.get(i).size) return false;
+			return true;
+		}
+	}
+
+	private InternalMethodImplementation methodImplementation;
+	private CodeBlock codeBlock;
+	private List<InstructionHandle> handles;
+
+	// stack layout before each reachable instruction, and the instructions that are jumped to
+	private HashMap<InstructionHandle, StackState> states = new HashMap<InstructionHandle, StackState>();
+	private HashSet<InstructionHandle> branchTargets = new HashSet<InstructionHandle>();
+
+	// C variables used by the function and their types, and the ones that are read
+	private TreeMap<String, String> variables = new TreeMap<String, String>();
+	private HashSet<String> readVariables = new HashSet<String>();
+
+	// kinds of the integer local variables that hold parameters
+	private HashMap<Integer, Character> parameterKinds = new HashMap<Integer, Character>();
+
+	private StackState state;
+	private StringBuilder out;
+	private String reason;
+
+	/**
+	 * Creates a compiler for the code block of a method implementation.
+	 * @param methodImplementation the method implementation to compile
+	 */
+	public CodeBlockCompiler(InternalMethodImplementation methodImplementation)
+	{
+		this.methodImplementation = methodImplementation;
+		this.codeBlock = methodImplementation.getCodeBlock();
+	}
+
+	/**
+	 * @return why the last call to compile() returned null
+	 */
+	public String getReason()
+	{
+		return reason;
+	}
+
+	/**
+	 * Compiles the method.
+	 * @return the body of a C function implementing the method, or null if the method can't be compiled
+	 */
+	public String compile()
+	{
+		try {
+			if (codeBlock==null) throw new UnsupportedException("no code");
+			if (methodImplementation.isNative()) throw new UnsupportedException("native method");
+			if (methodImplementation.isSynchronized()) throw new UnsupportedException("synchronized method");
+			if (codeBlock.getExceptionHandlers().length>0) throw new UnsupportedException("exception handlers");
+
+			handles = codeBlock.getInstructions().getInstructionHandles();
+
+			String prologue = generatePrologue();
+			analyse();
+			String code = generateCode();
+
+			StringBuilder ret = new StringBuilder();
+			for (Map.Entry<String, String> variable : variables.entrySet())
+				ret.append(String.format("\t%s %s = 0;\n", variable.getValue(), variable.getKey()));
+			for (String variable : variables.keySet())
+				if (!readVariables.contains(variable))
+					ret.append(String.format("\t(void)%s;\n", variable));
+			ret.append("\n");
+			ret.append(prologue);
+			ret.append(code);
+
+			return ret.toString();
+		} catch (UnsupportedException ex)
+		{
+			reason = ex.getMessage();
+			return null;
+		}
+	}
+
+	// Pops the parameters off the caller's stacks into the local variables that hold them. The last parameter
+	// is on top, the object reference of a virtual method is below the first.
+	private String generatePrologue() throws UnsupportedException
+	{
+		StringBuilder ret = new StringBuilder();
+		BaseType returnType = methodImplementation.getMethodDefinition().getReturnType();
+		BaseType[] parameterTypes = methodImplementation.getMethodDefinition().getArgumentTypes();
+		boolean isStatic = methodImplementation.isStatic();
+
+		if (returnType!=BaseType.Void) kind(returnType);
+
+		int[] slots = new int[parameterTypes.length];
+		int pos = isStatic?0:1;
+		for (int i=0; i<parameterTypes.length; i++)
+		{
+			slots[i] = pos;
+			pos += parameterTypes[i].isLongSized()?2:1;
+
+			char kind = kind(parameterTypes[i]);
+			int index = codeBlock.getLocalVariable(slots[i]).getIntegerIndex();
+			if (kind!='a' && index>=0) parameterKinds.put(index, kind);
+		}
+
+		for (int i=parameterTypes.length-1; i>=0; i--)
+		{
+			LocalVariable localVariable = codeBlock.getLocalVariable(slots[i]);
+			char kind = kind(parameterTypes[i]);
+			int index = (kind=='a')?localVariable.getReferenceIndex():localVariable.getIntegerIndex();
+			String pop = String.format("dj_exec_stackPop%s()", stackFunctionType(kind));
+
+			if (index<0)
+				ret.append(String.format("\t%s;\n", pop));
+			else
+				ret.append(String.format("\t%s = %s;\n", local(kind, index), pop));
+		}
+
+		if (!isStatic)
+		{
+			int index = codeBlock.getLocalVariable(0).getReferenceIndex();
+			if (index<0)
+				ret.append("\tdj_exec_stackPopRef();\n");
+			else
+				ret.append(String.format("\t%s = dj_exec_stackPopRef();\n", local('a', index)));
+		}
+
+		return ret.toString();
+	}
+
+	// Finds the stack layout before each reachable instruction
+	private void analyse() throws UnsupportedException
+	{
+		ArrayList<InstructionHandle> worklist = new ArrayList<InstructionHandle>();
+
+		states.put(handles.get(0), new StackState());
+		worklist.add(handles.get(0));
+
+		while (!worklist.isEmpty())
+		{
+			InstructionHandle handle = worklist.remove(worklist.size()-1);
+			Opcode opcode = handle.getInstruction().getOpcode();
+
+			state = states.get(handle).copy();
+			out = new StringBuilder();
+			translate(handle);
+
+			if (opcode.isBranch())
+				mergeState(handle.getBranchHandle(), worklist, true);
+
+			if (opcode.isSwitch())
+				for (InstructionHandle target : handle.getSwitchTargets())
+					mergeState(target, worklist, true);
+
+			if (!opcode.isReturn() && !opcode.isUnConditionalBranch() && !opcode.isSwitch())
+				mergeState(handles.get(codeBlock.getInstructions().getIndex(handle)+1), worklist, false);
+		}
+	}
+
+	private void mergeState(InstructionHandle target, ArrayList<InstructionHandle> worklist, boolean isBranch) throws UnsupportedException
+	{
+		if (isBranch) branchTargets.add(target);
+
+		StackState targetState = states.get(target);
+		if (targetState==null)
+		{
+			states.put(target, state.copy());
+			worklist.add(target);
+		} else
+			if (!targetState.sameLayout(state))
+				throw new UnsupportedException("stack layout differs between paths");
+	}
+
+	private String generateCode() throws UnsupportedException
+	{
+		StringBuilder ret = new StringBuilder();
+
+		for (InstructionHandle handle : handles)
+		{
+			if (!states.containsKey(handle)) continue;
+
+			if (branchTargets.contains(handle))
+				ret.append(String.format("%s: ;\n", label(handle)));
+
+			state = states.get(handle).copy();
+			out = ret;
+			translate(handle);
+		}
+
+		return ret.toString();
+	}
+
+	private void translate(InstructionHandle handle) throws UnsupportedException
+	{
+		Instruction instruction = handle.getInstruction();
+		Opcode opcode = instruction.getOpcode();
+		String a, b, result;
+
+		if (instruction instanceof LoadStoreInstruction)
+		{
+			int index = ((LoadStoreInstruction)instruction).getIndex();
+			char kind = opcode.getName().charAt(0);
+			if (index<0) throw new UnsupportedException("unmapped local variable");
+
+			if (opcode.isLoadInstruction())
+			{
+				String local = local(kind, index);
+				read(local);
+				emit("%s = %s;", (kind=='a')?pushRef():pushInt(kind), local);
+			} else
+			{
+				String value = (kind=='a')?popRef():popInt(kind);
+				emit("%s = %s;", local(kind, index), value);
+			}
+			return;
+		}
+
+		switch (opcode)
+		{
+			case NOP:
+			case B2C:
+				break;
+
+			// constants
+			case SCONST_M1: case SCONST_0: case SCONST_1: case SCONST_2: case SCONST_3: case SCONST_4: case SCONST_5:
+			case BSPUSH: case SSPUSH:
+				emit("%s = %d;", pushInt('s'), ((PushInstruction)instruction).getValue());
+				break;
+			case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+			case BIPUSH: case SIPUSH: case IIPUSH:
+				emit("%s = %s;", pushInt('i'), intLiteral((int)((PushInstruction)instruction).getValue()));
+				break;
+			case LCONST_0: case LCONST_1: case LLPUSH:
+				emit("%s = %s;", pushInt('l'), longLiteral(((PushInstruction)instruction).getValue()));
+				break;
+			case ACONST_NULL:
+				emit("%s = nullref;", pushRef());
+				break;
+
+			// local variable increments
+			case SINC: case SINC_W:
+				a = local('s', ((LocalVariableInstruction)instruction).getLocalVariable().getIntegerIndex());
+				read(a);
+				emit("%s = (int16_t)(%s + %d);", a, a, increment(instruction));
+				break;
+			case IINC: case IINC_W:
+				a = local('i', ((LocalVariableInstruction)instruction).getLocalVariable().getIntegerIndex());
+				read(a);
+				emit("%s = (int32_t)((uint32_t)%s + (uint32_t)%d);", a, a, increment(instruction));
+				break;
+
+			// arrays
+			case BALOAD: case CALOAD: arrayLoad('s', "dj_int_array", "data.bytes"); break;
+			case SALOAD: arrayLoad('s', "dj_int_array", "data.shorts"); break;
+			case IALOAD: arrayLoad('i', "dj_int_array", "data.ints"); break;
+			case LALOAD: arrayLoad('l', "dj_int_array", "data.longs"); break;
+			case AALOAD: arrayLoad('a', "dj_ref_array", "refs"); break;
+			case BASTORE: case CASTORE: arrayStore('s', "dj_int_array", "data.bytes", "(int8_t)"); break;
+			case SASTORE: arrayStore('s', "dj_int_array", "data.shorts", ""); break;
+			case IASTORE: arrayStore('i', "dj_int_array", "data.ints", ""); break;
+			case LASTORE: arrayStore('l', "dj_int_array", "data.longs", ""); break;
+			case AASTORE: arrayStore('a', "dj_ref_array", "refs", ""); break;
+			case ARRAYLENGTH:
+				a = popRef();
+				result = pushInt('s');
+				emit("if (REF_TO_VOIDP(%s)==NULL) { dj_exec_throwCompiled(COMPILED_NULL_POINTER); return; }", a);
+				emit("%s = (int16_t)((dj_array*)REF_TO_VOIDP(%s))->length;", result, a);
+				break;
+
+			// object fields
+			case GETFIELD_B: case GETFIELD_C: getField('s', "int8_t", instruction); break;
+			case GETFIELD_S: getField('s', "int16_t", instruction); break;
+			case GETFIELD_I: getField('i', "int32_t", instruction); break;
+			case GETFIELD_L: getField('l', "int64_t", instruction); break;
+			case GETFIELD_A: getField('a', null, instruction); break;
+			case ALOAD_0_GETFIELD_B: loadReference(0); getField('s', "int8_t", instruction); break;
+			case ALOAD_0_GETFIELD_S: loadReference(0); getField('s', "int16_t", instruction); break;
+			case ALOAD_0_GETFIELD_I: loadReference(0); getField('i', "int32_t", instruction); break;
+			case ALOAD_0_GETFIELD_A: loadReference(0); getField('a', null, instruction); break;
+			case PUTFIELD_B: case PUTFIELD_C: putField('s', "int8_t", instruction); break;
+			case PUTFIELD_S: putField('s', "int16_t", instruction); break;
+			case PUTFIELD_I: putField('i', "int32_t", instruction); break;
+			case PUTFIELD_L: putField('l', "int64_t", instruction); break;
+			case PUTFIELD_A: putField('a', null, instruction); break;
+
+			// static fields
+			case GETSTATIC_B: case GETSTATIC_C: getStatic('s', "int8_t", "staticByteFields", instruction); break;
+			case GETSTATIC_S: getStatic('s', "int16_t", "staticShortFields", instruction); break;
+			case GETSTATIC_I: getStatic('i', "int32_t", "staticIntFields", instruction); break;
+			case GETSTATIC_L: getStatic('l', "int64_t", "staticLongFields", instruction); break;
+			case GETSTATIC_A: getStatic('a', null, "staticReferenceFields", instruction); break;
+			case PUTSTATIC_B: case PUTSTATIC_C: putStatic('s', "uint8_t", "staticByteFields", instruction); break;
+			case PUTSTATIC_S: putStatic('s', "uint16_t", "staticShortFields", instruction); break;
+			case PUTSTATIC_I: putStatic('i', "uint32_t", "staticIntFields", instruction); break;
+			case PUTSTATIC_L: putStatic('l', "uint64_t", "staticLongFields", instruction); break;
+			case PUTSTATIC_A: putStatic('a', null, "staticReferenceFields", instruction); break;
+
+			// short arithmetic, computed in int and truncated like the interpreter does
+			case SADD: shortOp("(int16_t)(%s + %s)"); break;
+			case SSUB: shortOp("(int16_t)(%s - %s)"); break;
+			case SMUL: shortOp("(int16_t)(%s * %s)"); break;
+			case SAND: shortOp("(int16_t)(%s & %s)"); break;
+			case SOR: shortOp("(int16_t)(%s | %s)"); break;
+			case SXOR: shortOp("(int16_t)(%s ^ %s)"); break;
+			case SSHL: shortOp("(int16_t)((uint32_t)(int32_t)%s << (%s & 31))"); break;
+			case SSHR: shortOp("(int16_t)(%s >> (%s & 31))"); break;
+			case SUSHR: shortOp("(int16_t)((uint16_t)%s >> (%s & 15))"); break;
+			case SDIV: case SREM:
+				b = popInt('s');
+				a = popInt('s');
+				result = pushInt('s');
+				emitThrowIf(b + "==0", "COMPILED_ARITHMETIC");
+				emit("%s = (int16_t)(%s %s %s);", result, a, (opcode==Opcode.SDIV)?"/":"%", b);
+				break;
+			case SNEG:
+				a = popInt('s');
+				emit("%s = (int16_t)-%s;", pushInt('s'), a);
+				break;
+
+			// int arithmetic, wrapping around on overflow
+			case IADD: intOp('i', "(int32_t)((uint32_t)%s + (uint32_t)%s)"); break;
+			case ISUB: intOp('i', "(int32_t)((uint32_t)%s - (uint32_t)%s)"); break;
+			case IMUL: intOp('i', "(int32_t)((uint32_t)%s * (uint32_t)%s)"); break;
+			case IAND: intOp('i', "%s & %s"); break;
+			case IOR: intOp('i', "%s | %s"); break;
+			case IXOR: intOp('i', "%s ^ %s"); break;
+			case ISHL: intOp('i', "(int32_t)((uint32_t)%s << (%s & 31))"); break;
+			case ISHR: intOp('i', "%s >> (%s & 31)"); break;
+			case IUSHR: intOp('s', "(int32_t)((uint32_t)%s >> (%s & 31))"); break;
+			case IDIV:
+				b = popInt('i');
+				a = popInt('i');
+				result = pushInt('i');
+				emitThrowIf(b + "==0", "COMPILED_ARITHMETIC");
+				emit("%s = (%s==-1) ? (int32_t)(0u - (uint32_t)%s) : %s / %s;", result, b, a, a, b);
+				break;
+			case IREM:
+				b = popInt('i');
+				a = popInt('i');
+				result = pushInt('i');
+				emitThrowIf(b + "==0", "COMPILED_ARITHMETIC");
+				emit("%s = (%s==-1) ? 0 : %s %% %s;", result, b, a, b);
+				break;
+			case INEG:
+				a = popInt('i');
+				emit("%s = (int32_t)(0u - (uint32_t)%s);", pushInt('i'), a);
+				break;
+
+			// long arithmetic
+			case LADD: longOp('l', "(int64_t)((uint64_t)%s + (uint64_t)%s)"); break;
+			case LSUB: longOp('l', "(int64_t)((uint64_t)%s - (uint64_t)%s)"); break;
+			case LMUL: longOp('l', "(int64_t)((uint64_t)%s * (uint64_t)%s)"); break;
+			case LAND: longOp('l', "%s & %s"); break;
+			case LOR: longOp('l', "%s | %s"); break;
+			case LXOR: longOp('l', "%s ^ %s"); break;
+			case LSHL: longOp('l', "(int64_t)((uint64_t)%s << (%s & 63))"); break;
+			case LSHR: longOp('l', "%s >> (%s & 63)"); break;
+			case LUSHR: longOp('s', "(int64_t)((uint64_t)%s >> (%s & 63))"); break;
+			case LDIV:
+				b = popInt('l');
+				a = popInt('l');
+				result = pushInt('l');
+				emitThrowIf(b + "==0", "COMPILED_ARITHMETIC");
+				emit("%s = (%s==-1) ? (int64_t)(0ull - (uint64_t)%s) : %s / %s;", result, b, a, a, b);
+				break;
+			case LREM:
+				b = popInt('l');
+				a = popInt('l');
+				result = pushInt('l');
+				emitThrowIf(b + "==0", "COMPILED_ARITHMETIC");
+				emit("%s = (%s==-1) ? 0 : %s %% %s;", result, b, a, b);
+				break;
+			case LNEG:
+				a = popInt('l');
+				emit("%s = (int64_t)(0ull - (uint64_t)%s);", pushInt('l'), a);
+				break;
+			case LCMP:
+				b = popInt('l');
+				a = popInt('l');
+				emit("%s = (%s>%s) ? 1 : ((%s<%s) ? -1 : 0);", pushInt('s'), a, b, a, b);
+				break;
+
+			// conversions, narrowing to char is done the same way as to byte by the interpreter
+			case S2B: case S2C: convert('s', 's', "(int8_t)"); break;
+			case S2I: convert('s', 'i', "(int32_t)"); break;
+			case S2L: convert('s', 'l', "(int64_t)"); break;
+			case I2B: case I2C: convert('i', 's', "(int8_t)"); break;
+			case I2S: convert('i', 's', "(int16_t)"); break;
+			case I2L: convert('i', 'l', "(int64_t)"); break;
+			case L2I: convert('l', 'i', "(int32_t)"); break;
+			case L2S: convert('l', 's', "(int16_t)"); break;
+
+			// stack operations
+			case IPOP: popSlots(1); break;
+			case IPOP2: popSlots(2); break;
+			case IDUP: duplicateInts(1, 0); break;
+			case IDUP2: duplicateInts(2, 0); break;
+			case IDUP_X1: duplicateInts(1, 1); break;
+			case IDUP_X2: duplicateInts(1, 2); break;
+			case IDUP_X: duplicateInts(((WideStackInstruction)instruction).getM(), ((WideStackInstruction)instruction).getN()); break;
+			case APOP: popRef(); break;
+			case APOP2: popRef(); popRef(); break;
+			case ADUP: duplicateRefs(1, 0); break;
+			case ADUP2: duplicateRefs(2, 0); break;
+			case ADUP_X1: duplicateRefs(1, 1); break;
+			case ADUP_X2: duplicateRefs(1, 2); break;
+
+			// branches
+			case SIFEQ: case SIFNE: case SIFLT: case SIFGE: case SIFGT: case SIFLE:
+				a = popInt('s');
+				emitBranch(a + comparison(opcode) + "0", handle);
+				break;
+			case IIFEQ: case IIFNE: case IIFLT: case IIFGE: case IIFGT: case IIFLE:
+				a = popInt('i');
+				emitBranch(a + comparison(opcode) + "0", handle);
+				break;
+			case IF_SCMPEQ: case IF_SCMPNE: case IF_SCMPLT: case IF_SCMPGE: case IF_SCMPGT: case IF_SCMPLE:
+				b = popInt('s');
+				a = popInt('s');
+				emitBranch(a + comparison(opcode) + b, handle);
+				break;
+			case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+				b = popInt('i');
+				a = popInt('i');
+				emitBranch(a + comparison(opcode) + b, handle);
+				break;
+			case SLOAD_SIFEQ: case SLOAD_SIFNE:
+				a = local('s', ((LoadBranchInstruction)instruction).getLocalVariable().getIntegerIndex());
+				read(a);
+				emitBranch(a + comparison(opcode) + "0", handle);
+				break;
+			case ILOAD_IIFEQ: case ILOAD_IIFNE:
+				a = local('i', ((LoadBranchInstruction)instruction).getLocalVariable().getIntegerIndex());
+				read(a);
+				emitBranch(a + comparison(opcode) + "0", handle);
+				break;
+			case IFNULL:
+				emitBranch(popRef() + "==nullref", handle);
+				break;
+			case IFNONNULL:
+				emitBranch(popRef() + "!=nullref", handle);
+				break;
+			case IF_ACMPEQ:
+				b = popRef();
+				a = popRef();
+				emitBranch(a + "==" + b, handle);
+				break;
+			case IF_ACMPNE:
+				b = popRef();
+				a = popRef();
+				emitBranch(a + "!=" + b, handle);
+				break;
+			case GOTO:
+				emit("goto %s;", label(handle.getBranchHandle()));
+				break;
+			case TABLESWITCH:
+				a = popInt('i');
+				emit("switch (%s)", a);
+				emit("{");
+				for (int i=0; i<handle.getSwitchTargets().size(); i++)
+					emit("\tcase %s: goto %s;", intLiteral(((TableSwitchInstruction)instruction).getLow() + i), label(handle.getSwitchTargets().get(i)));
+				emit("\tdefault: goto %s;", label(handle.getBranchHandle()));
+				emit("}");
+				break;
+			case LOOKUPSWITCH:
+				a = popInt('i');
+				emit("switch (%s)", a);
+				emit("{");
+				for (int i=0; i<handle.getSwitchTargets().size(); i++)
+					emit("\tcase %s: goto %s;", intLiteral(((LookupSwitchInstruction)instruction).getValues()[i]), label(handle.getSwitchTargets().get(i)));
+				emit("\tdefault: goto %s;", label(handle.getBranchHandle()));
+				emit("}");
+				break;
+
+			// returns
+			case SRETURN:
+				emit("dj_exec_stackPushShort(%s);", popInt('s'));
+				emit("return;");
+				break;
+			case IRETURN:
+				emit("dj_exec_stackPushInt(%s);", popInt('i'));
+				emit("return;");
+				break;
+			case LRETURN:
+				emit("dj_exec_stackPushLong(%s);", popInt('l'));
+				emit("return;");
+				break;
+			case ARETURN:
+				emit("dj_exec_stackPushRef(%s);", popRef());
+				emit("return;");
+				break;
+			case RETURN:
+				emit("return;");
+				break;
+
+			// invokes, allocation, type checks, exceptions and monitors stay interpreted
+			default:
+				throw new UnsupportedException("unsupported instruction " + opcode.getName());
+		}
+	}
+
+	private void arrayLoad(char kind, String arrayType, String elements) throws UnsupportedException
+	{
+		String index = popInt('i');
+		String array = popRef();
+		String result = (kind=='a')?pushRef():pushInt(kind);
+
+		emit("{");
+		emit("\t%s *array = dj_exec_compiledCheckArray(%s, %s);", arrayType, array, index);
+		emit("\tif (array==NULL) return;");
+		emit("\t%s = array->%s[%s];", result, elements, index);
+		emit("}");
+	}
+
+	private void arrayStore(char kind, String arrayType, String elements, String cast) throws UnsupportedException
+	{
+		String value = (kind=='a')?popRef():popInt(kind);
+		String index = popInt('i');
+		String array = popRef();
+
+		emit("{");
+		emit("\t%s *array = dj_exec_compiledCheckArray(%s, %s);", arrayType, array, index);
+		emit("\tif (array==NULL) return;");
+		if (kind=='a') emitWriteBarrier(value);
+		emit("\tarray->%s[%s] = %s%s;", elements, index, cast, value);
+		emit("}");
+	}
+
+	private void loadReference(int index) throws UnsupportedException
+	{
+		String local = local('a', index);
+		read(local);
+		emit("%s = %s;", pushRef(), local);
+	}
+
+	private void getField(char kind, String type, Instruction instruction) throws UnsupportedException
+	{
+		int offset = ((FieldInstruction)instruction).getOffset();
+		String object = popRef();
+		String result = (kind=='a')?pushRef():pushInt(kind);
+
+		emit("{");
+		emit("\tdj_object *object = dj_exec_compiledCheckObject(%s);", object);
+		emit("\tif (object==NULL) return;");
+		if (kind=='a')
+			emit("\t%s = dj_object_getReferences(object)[%d];", result, offset);
+		else
+			emit("\t%s = *(%s*)((char*)object + %d);", result, type, offset);
+		emit("}");
+	}
+
+	private void putField(char kind, String type, Instruction instruction) throws UnsupportedException
+	{
+		int offset = ((FieldInstruction)instruction).getOffset();
+		String value = (kind=='a')?popRef():popInt(kind);
+		String object = popRef();
+
+		emit("{");
+		emit("\tdj_object *object = dj_exec_compiledCheckObject(%s);", object);
+		emit("\tif (object==NULL) return;");
+		if (kind=='a')
+		{
+			emitWriteBarrier(value);
+			emit("\tdj_object_getReferences(object)[%d] = %s;", offset, value);
+		} else
+			emit("\t*(%s*)((char*)object + %d) = (%s)%s;", type, offset, type, value);
+		emit("}");
+	}
+
+	private void getStatic(char kind, String type, String fields, Instruction instruction) throws UnsupportedException
+	{
+		LocalId localId = ((LocalIdInstruction)instruction).getLocalId();
+		String result = (kind=='a')?pushRef():pushInt(kind);
+
+		emit("%s = %sdj_infusion_resolve(infusion, %d)->%s[%d];", result, (type==null)?"":"("+type+")", localId.getInfusionId(), fields, localId.getLocalId());
+	}
+
+	private void putStatic(char kind, String type, String fields, Instruction instruction) throws UnsupportedException
+	{
+		LocalId localId = ((LocalIdInstruction)instruction).getLocalId();
+		String value = (kind=='a')?popRef():popInt(kind);
+
+		if (kind=='a') emitWriteBarrier(value);
+		emit("dj_infusion_resolve(infusion, %d)->%s[%d] = %s%s;", localId.getInfusionId(), fields, localId.getLocalId(), (type==null)?"":"("+type+")", value);
+	}
+
+	private void emitWriteBarrier(String value)
+	{
+		out.append("#ifdef GC_INCREMENTAL\n");
+		emit("dj_mem_writeBarrier(%s);", value);
+		out.append("#endif\n");
+	}
+
+	private void shortOp(String expression) throws UnsupportedException
+	{
+		String b = popInt('s');
+		String a = popInt('s');
+		emit("%s = %s;", pushInt('s'), String.format(expression, a, b));
+	}
+
+	// int operations, the shift count of IUSHR is a short
+	private void intOp(char operandKind, String expression) throws UnsupportedException
+	{
+		String b = popInt(operandKind);
+		String a = popInt('i');
+		emit("%s = %s;", pushInt('i'), String.format(expression, a, b));
+	}
+
+	// long operations, the shift count of LUSHR is a short
+	private void longOp(char operandKind, String expression) throws UnsupportedException
+	{
+		String b = popInt(operandKind);
+		String a = popInt('l');
+		emit("%s = %s;", pushInt('l'), String.format(expression, a, b));
+	}
+
+	private void convert(char from, char to, String cast) throws UnsupportedException
+	{
+		String a = popInt(from);
+		emit("%s = %s%s;", pushInt(to), cast, a);
+	}
+
+	private void emitBranch(String condition, InstructionHandle handle)
+	{
+		emit("if (%s) goto %s;", condition, label(handle.getBranchHandle()));
+	}
+
+	private void emitThrowIf(String condition, String exception)
+	{
+		emit("if (%s) { dj_exec_throwCompiled(%s); return; }", condition, exception);
+	}
+
+	// Pops a number of slots off the integer stack. Values that are popped partially can only be popped further.
+	private void popSlots(int slots) throws UnsupportedException
+	{
+		while (slots>0)
+		{
+			if (state.ints.isEmpty()) throw new UnsupportedException("integer stack underflow");
+			StackValue top = state.ints.get(state.ints.size()-1);
+			if (top.size<=slots)
+			{
+				state.ints.remove(state.ints.size()-1);
+				slots -= top.size;
+			} else
+			{
+				state.ints.set(state.ints.size()-1, new StackValue('p', top.size-slots));
+				slots = 0;
+			}
+		}
+	}
+
+	// Removes the values in the top [slots] slots of the integer stack and returns their names, bottom first
+	private ArrayList<String> removeSlots(int slots) throws UnsupportedException
+	{
+		ArrayList<String> ret = new ArrayList<String>();
+		while (slots>0)
+		{
+			if (state.ints.isEmpty()) throw new UnsupportedException("integer stack underflow");
+			StackValue top = state.ints.get(state.ints.size()-1);
+			if (top.kind=='p' || top.size>slots) throw new UnsupportedException("stack operation splits a value");
+			ret.add(0, intStackName(state.ints.size()-1));
+			state.ints.remove(state.ints.size()-1);
+			slots -= top.size;
+		}
+		return ret;
+	}
+
+	// Copies the top m slots of the integer stack below the n slots under them (IDUP_X semantics)
+	private void duplicateInts(int m, int n) throws UnsupportedException
+	{
+		ArrayList<String> top = removeSlots(m);
+		ArrayList<String> below = removeSlots(n);
+
+		ArrayList<String> sources = new ArrayList<String>();
+		sources.addAll(top);
+		sources.addAll(below);
+		sources.addAll(top);
+
+		ArrayList<String> destinations = new ArrayList<String>();
+		for (String source : sources)
+			destinations.add(pushInt(source.charAt(0)));
+
+		emitMoves(destinations, sources);
+	}
+
+	// Copies the top m references below the n references under them
+	private void duplicateRefs(int m, int n) throws UnsupportedException
+	{
+		if (state.refs<m+n) throw new UnsupportedException("reference stack underflow");
+
+		ArrayList<String> top = new ArrayList<String>();
+		ArrayList<String> below = new ArrayList<String>();
+		for (int i=state.refs-m; i<state.refs; i++) top.add("r" + i);
+		for (int i=state.refs-m-n; i<state.refs-m; i++) below.add("r" + i);
+		state.refs -= m+n;
+
+		ArrayList<String> sources = new ArrayList<String>();
+		sources.addAll(top);
+		sources.addAll(below);
+		sources.addAll(top);
+
+		ArrayList<String> destinations = new ArrayList<String>();
+		for (int i=0; i<sources.size(); i++)
+			destinations.add(pushRef());
+
+		emitMoves(destinations, sources);
+	}
+
+	// Moves stack values to new positions through temporaries, so that the moves can overlap
+	private void emitMoves(ArrayList<String> destinations, ArrayList<String> sources)
+	{
+		StringBuilder temporaries = new StringBuilder();
+		StringBuilder moves = new StringBuilder();
+		int count = 0;
+
+		for (int i=0; i<sources.size(); i++)
+		{
+			if (destinations.get(i).equals(sources.get(i))) continue;
+			read(sources.get(i));
+			temporaries.append(String.format(" %s t%d = %s;", stackType(sources.get(i).charAt(0)), count, sources.get(i)));
+			moves.append(String.format(" %s = t%d;", destinations.get(i), count));
+			count++;
+		}
+
+		if (count>0) emit("{%s%s }", temporaries, moves);
+	}
+
+	private String intStackName(int index)
+	{
+		int slot = 0;
+		for (int i=0; i<index; i++) slot += state.ints.get(i).size;
+		return "" + state.ints.get(index).kind + slot;
+	}
+
+	private String pushInt(char kind)
+	{
+		state.ints.add(new StackValue(kind, ((kind=='s')?BaseType.Short:(kind=='i')?BaseType.Int:BaseType.Long).getNrIntegerSlots()));
+		String name = intStackName(state.ints.size()-1);
+		variables.put(name, stackType(kind));
+		return name;
+	}
+
+	private String popInt(char kind) throws UnsupportedException
+	{
+		if (state.ints.isEmpty()) throw new UnsupportedException("integer stack underflow");
+		if (state.ints.get(state.ints.size()-1).kind!=kind) throw new UnsupportedException("integer stack type mismatch");
+		String name = intStackName(state.ints.size()-1);
+		state.ints.remove(state.ints.size()-1);
+		read(name);
+		return name;
+	}
+
+	private String pushRef()
+	{
+		String name = "r" + state.refs;
+		state.refs++;
+		variables.put(name, "ref_t");
+		return name;
+	}
+
+	private String popRef() throws UnsupportedException
+	{
+		if (state.refs==0) throw new UnsupportedException("reference stack underflow");
+		state.refs--;
+		String name = "r" + state.refs;
+		read(name);
+		return name;
+	}
+
+	// Returns the C variable for a local variable. The kind is 's', 'i', 'l' or 'a' for reference variables.
+	private String local(char kind, int index) throws UnsupportedException
+	{
+		if (index<0) throw new UnsupportedException("unmapped local variable");
+		if (kind!='a' && parameterKinds.containsKey(index) && parameterKinds.get(index)!=kind)
+			throw new UnsupportedException("parameter slot accessed as a different type");
+
+		String name = "l" + kind + index;
+		variables.put(name, (kind=='a')?"ref_t":stackType(kind));
+		return name;
+	}
+
+	private void read(String variable)
+	{
+		readVariables.add(variable);
+	}
+
+	private String label(InstructionHandle handle)
+	{
+		return "L" + codeBlock.getInstructions().getIndex(handle);
+	}
+
+	private void emit(String format, Object ... args)
+	{
+		out.append('\t');
+		out.append(String.format(format, args));
+		out.append('\n');
+	}
+
+	private static int increment(Instruction instruction)
+	{
+		if (instruction instanceof WideIncreaseInstruction)
+			return ((WideIncreaseInstruction)instruction).getValue();
+		else
+			return ((IncreaseInstruction)instruction).getValue();
+	}
+
+	private static String comparison(Opcode opcode)
+	{
+		String name = opcode.getName();
+		String condition = name.substring(name.length()-2);
+		if (condition.equals("eq")) return "==";
+		if (condition.equals("ne")) return "!=";
+		if (condition.equals("lt")) return "<";
+		if (condition.equals("ge")) return ">=";
+		if (condition.equals("gt")) return ">";
+		return "<=";
+	}
+
+	private static char kind(BaseType type) throws UnsupportedException
+	{
+		switch (type)
+		{
+			case Ref: return 'a';
+			case Byte: case Char: case Boolean: case Short: return 's';
+			case Int: return 'i';
+			case Long: return 'l';
+			default:
+				throw new UnsupportedException("unsupported type " + type);
+		}
+	}
+
+	private static String stackType(char kind)
+	{
+		switch (kind)
+		{
+			case 's': return "int16_t";
+			case 'i': return "int32_t";
+			case 'l': return "int64_t";
+			default: return "ref_t";
+		}
+	}
+
+	private static String stackFunctionType(char kind)
+	{
+		switch (kind)
+		{
+			case 's': return "Short";
+			case 'i': return "Int";
+			case 'l': return "Long";
+			default: return "Ref";
+		}
+	}
+
+	private static String intLiteral(int value)
+	{
+		return (value==Integer.MIN_VALUE)?"(-2147483647 - 1)":Integer.toString(value);
+	}
+
+	private static String longLiteral(long value)
+	{
+		return (value==Long.MIN_VALUE)?"(-9223372036854775807LL - 1)":(Long.toString(value) + "LL");
+	}
+
+}
@@ -260,6 +260,16 @@ public enum Opcode
 	S2L((short)217,"s2l", BaseType.Long, BaseType.Short),
 
 	LCMP((short)218,"lcmp", BaseType.Short, BaseType.Long, BaseType.Long),
+
+	// fused instructions, only emitted by the SuperInstructions transformation after all analysis is done
+	SLOAD_SIFEQ((short)219,"sload_sifeq", null),
+	SLOAD_SIFNE((short)220,"sload_sifne", null),
+	ILOAD_IIFEQ((short)221,"iload_iifeq", null),
+	ILOAD_IIFNE((short)222,"iload_iifne", null),
+	ALOAD_0_GETFIELD_B((short)223,"aload_0_getfield_b", BaseType.Byte),
+	ALOAD_0_GETFIELD_S((short)224,"aload_0_getfield_s", BaseType.Short),
+	ALOAD_0_GETFIELD_I((short)225,"aload_0_getfield_i", BaseType.Int),
+	ALOAD_0_GETFIELD_A((short)226,"aload_0_getfield_a", BaseType.Ref),
 	
 	// this is a dummy placeholder opcode, will not appear in the final output
 	S2S((short)-1,"s2s", BaseType.Short, BaseType.Short)
@@ -274,6 +284,7 @@ public enum Opcode
 				IF_SCMPEQ, IF_SCMPNE, IF_SCMPLT, IF_SCMPGE, IF_SCMPGT, IF_SCMPLE,
 				IF_ICMPEQ, IF_ICMPNE, IF_ICMPLT, IF_ICMPGE, IF_ICMPGT, IF_ICMPLE,
 				IF_ACMPEQ, IF_ACMPNE,
+				SLOAD_SIFEQ, SLOAD_SIFNE, ILOAD_IIFEQ, ILOAD_IIFNE,
 				});
 
 	// Defines the group of switch instructions. Membership testing on this group is used in the isSwitch method.
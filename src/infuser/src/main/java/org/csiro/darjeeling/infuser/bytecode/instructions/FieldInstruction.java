@@ -37,6 +37,11 @@ public class FieldInstruction extends Instruction
 		super(opcode);
 		this.offset = offset;
 	}
+	
+	public int getOffset()
+	{
+		return offset;
+	}
 
 	@Override
 	public void dump(DataOutputStream out) throws IOException
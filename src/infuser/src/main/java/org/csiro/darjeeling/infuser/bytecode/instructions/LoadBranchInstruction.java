@@ -0,0 +1,70 @@
+/*
+ * LoadBranchInstruction.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+package org.csiro.darjeeling.infuser.bytecode.instructions;
+
+import java.io.DataOutputStream;
+import java.io.IOException;
+
+import org.csiro.darjeeling.infuser.bytecode.LocalVariable;
+import org.csiro.darjeeling.infuser.bytecode.Opcode;
+
+/**
+ * Fused instruction that loads an integer local variable and branches on it (SLOAD_SIFEQ and friends). The branch
+ * address is relative to the start of the instruction, like that of the other branch instructions.
+ */
+public class LoadBranchInstruction extends BranchInstruction
+{
+	
+	private LocalVariable localVariable;
+
+	public LoadBranchInstruction(Opcode opcode, LocalVariable localVariable, int branchAdress)
+	{
+		super(opcode, branchAdress);
+		this.localVariable = localVariable;
+	}
+	
+	public LocalVariable getLocalVariable()
+	{
+		return localVariable;
+	}
+
+	@Override
+	public void dump(DataOutputStream out) throws IOException
+	{
+		out.write(opcode.getOpcode());
+		out.write(localVariable.getIntegerIndex());
+		out.writeShort(branchAdress);
+	}
+	
+	@Override
+	public int getLength()
+	{
+		return 4;
+	}
+	
+	@Override
+	public String toString()
+	{
+		return String.format("%s(%d, %d)", opcode.getName(), localVariable.getIntegerIndex(), branchAdress);
+	}
+
+}
@@ -38,6 +38,11 @@ public class LocalIdInstruction extends Instruction
 		super(opcode);
 		this.localId = localId;
 	}
+	
+	public LocalId getLocalId()
+	{
+		return localId;
+	}
 
 	@Override
 	public void dump(DataOutputStream out) throws IOException
@@ -39,6 +39,11 @@ public class LookupSwitchInstruction extends SwitchInstruction
 		this.switchAddresses = targets;
 	}
 	
+	public int[] getValues()
+	{
+		return values;
+	}
+	
 	public void dump(DataOutputStream out) throws IOException
 	{
 		super.dump(out);
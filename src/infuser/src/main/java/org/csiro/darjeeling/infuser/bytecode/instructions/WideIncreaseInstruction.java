@@ -40,6 +40,11 @@ public class WideIncreaseInstruction extends LocalVariableInstruction
 		this.value = value;
 	}
 	
+	public int getValue()
+	{
+		return value;
+	}
+	
 	@Override
 	public int getLength()
 	{
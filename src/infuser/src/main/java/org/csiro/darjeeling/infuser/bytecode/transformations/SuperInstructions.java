@@ -0,0 +1,273 @@
+/*
+ * SuperInstructions.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+package org.csiro.darjeeling.infuser.bytecode.transformations;
+
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+
+import org.csiro.darjeeling.infuser.bytecode.CodeBlock;
+import org.csiro.darjeeling.infuser.bytecode.CodeBlockTransformation;
+import org.csiro.darjeeling.infuser.bytecode.ExceptionHandler;
+import org.csiro.darjeeling.infuser.bytecode.Instruction;
+import org.csiro.darjeeling.infuser.bytecode.InstructionHandle;
+import org.csiro.darjeeling.infuser.bytecode.Opcode;
+import org.csiro.darjeeling.infuser.bytecode.instructions.FieldInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.IncreaseInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LoadBranchInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.LoadStoreInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.PushInstruction;
+import org.csiro.darjeeling.infuser.bytecode.instructions.WideIncreaseInstruction;
+
+/**
+ * Replaces common instruction sequences with a single instruction, so that the interpreter dispatches once
+ * instead of once per instruction:
+ * <ul>
+ * <li>SLOAD x, short constant c, SADD/SSUB, SSTORE x becomes SINC x, c (or SINC_W), which the VM already has</li>
+ * <li>SLOAD/ILOAD x, SIFEQ/SIFNE/IIFEQ/IIFNE becomes SLOAD_SIFEQ x etc.</li>
+ * <li>ALOAD_0, GETFIELD_B/S/I/A becomes ALOAD_0_GETFIELD_B/S/I/A; GETFIELD_C shares ALOAD_0_GETFIELD_B, as the VM
+ * executes GETFIELD_C as GETFIELD_B</li>
+ * </ul>
+ * These sequences were picked by hand, not derived from a profile, and no profile is checked in yet. A VM built with
+ * OPCODE_PROFILER reports the most executed opcode pairs and triples. The superinstructions.py script in the infuser
+ * directory reads those reports and prints the share of dispatches these fusions save, and the most executed pairs
+ * that aren't fused yet. Revisit this set once such a profile is available, and keep the fusions in that script in
+ * sync with this class.
+ * <p>
+ * A sequence is only fused if control can't enter it other than at its first instruction, so no branch, switch or
+ * exception handler may target, or start or end at, any of its other instructions.
+ * <p>
+ * This transformation runs last, on the final local variable indices and after all analysis, since the other
+ * transformations don't know the fused opcodes. The opcodes other than SINC need a VM built with
+ * EXECUTION_SUPERINSTRUCTIONS, so the transformation is only applied when enabled with -superinstructions=true.
+ */
+public class SuperInstructions extends CodeBlockTransformation
+{
+	
+	private static boolean enabled = false;
+	
+	private static HashMap<Opcode, Opcode> fusedBranchOpcodes;
+	private static HashMap<Opcode, Opcode> fusedGetFieldOpcodes;
+	
+	static
+	{
+		fusedBranchOpcodes = new HashMap<Opcode, Opcode>();
+		fusedBranchOpcodes.put(Opcode.SIFEQ, Opcode.SLOAD_SIFEQ);
+		fusedBranchOpcodes.put(Opcode.SIFNE, Opcode.SLOAD_SIFNE);
+		fusedBranchOpcodes.put(Opcode.IIFEQ, Opcode.ILOAD_IIFEQ);
+		fusedBranchOpcodes.put(Opcode.IIFNE, Opcode.ILOAD_IIFNE);
+		
+		fusedGetFieldOpcodes = new HashMap<Opcode, Opcode>();
+		fusedGetFieldOpcodes.put(Opcode.GETFIELD_B, Opcode.ALOAD_0_GETFIELD_B);
+		fusedGetFieldOpcodes.put(Opcode.GETFIELD_C, Opcode.ALOAD_0_GETFIELD_B);
+		fusedGetFieldOpcodes.put(Opcode.GETFIELD_S, Opcode.ALOAD_0_GETFIELD_S);
+		fusedGetFieldOpcodes.put(Opcode.GETFIELD_I, Opcode.ALOAD_0_GETFIELD_I);
+		fusedGetFieldOpcodes.put(Opcode.GETFIELD_A, Opcode.ALOAD_0_GETFIELD_A);
+	}
+	
+	// handles that control can enter other than from the previous handle
+	private HashSet<InstructionHandle> entryPoints;
+	
+	private List<InstructionHandle> handles;
+
+	public SuperInstructions(CodeBlock codeBlock)
+	{
+		super(codeBlock);
+	}
+	
+	public static void setEnabled(boolean enabled)
+	{
+		SuperInstructions.enabled = enabled;
+	}
+	
+	public static boolean isEnabled()
+	{
+		return enabled;
+	}
+	
+	private void findEntryPoints()
+	{
+		entryPoints = new HashSet<InstructionHandle>();
+		
+		for (InstructionHandle handle : handles)
+		{
+			if (handle.getInstruction().getOpcode().isBranch() && handle.getBranchHandle()!=null)
+				entryPoints.add(handle.getBranchHandle());
+			entryPoints.addAll(handle.getSwitchTargets());
+		}
+		
+		for (ExceptionHandler exceptionHandler : codeBlock.getExceptionHandlers())
+		{
+			entryPoints.add(exceptionHandler.getStart());
+			entryPoints.add(exceptionHandler.getEnd());
+			entryPoints.add(exceptionHandler.getHandler());
+		}
+	}
+	
+	/**
+	 * Checks if the [length] handles starting at [index] can be fused into one.
+	 */
+	private boolean isFusable(int index, int length)
+	{
+		if (index+length>handles.size()) return false;
+		
+		for (int i=index+1; i<index+length; i++)
+			if (entryPoints.contains(handles.get(i))) return false;
+		
+		return true;
+	}
+	
+	private Opcode getOpcode(int index)
+	{
+		return handles.get(index).getInstruction().getOpcode();
+	}
+	
+	private static boolean isShortConstant(Opcode opcode)
+	{
+		switch (opcode)
+		{
+			case SCONST_M1:
+			case SCONST_0:
+			case SCONST_1:
+			case SCONST_2:
+			case SCONST_3:
+			case SCONST_4:
+			case SCONST_5:
+			case BSPUSH:
+			case SSPUSH:
+				return true;
+			default:
+				return false;
+		}
+	}
+	
+	/**
+	 * Replaces the [length] handles starting at [index] with a single handle that executes [instruction]. The
+	 * first handle is kept, so that branches to the sequence stay valid.
+	 */
+	private void fuse(int index, int length, Instruction instruction)
+	{
+		InstructionHandle handle = handles.get(index);
+		InstructionHandle last = handles.get(index+length-1);
+		
+		handle.setInstruction(instruction);
+		if (instruction.getOpcode().isBranch())
+			handle.setBranchHandle(last.getBranchHandle());
+		
+		for (int i=1; i<length; i++)
+			handles.remove(index+1);
+	}
+	
+	/**
+	 * Fuses SLOAD x, c, SADD, SSTORE x and c, SLOAD x, SADD, SSTORE x into SINC x, c, and SLOAD x, c, SSUB, SSTORE x
+	 * into SINC x, -c.
+	 */
+	private boolean fuseIncrease(int index)
+	{
+		if (!isFusable(index, 4)) return false;
+		if (getOpcode(index+3)!=Opcode.SSTORE) return false;
+		
+		int loadIndex, constantIndex;
+		if (getOpcode(index)==Opcode.SLOAD && isShortConstant(getOpcode(index+1)))
+		{
+			loadIndex = index;
+			constantIndex = index+1;
+		} else if (isShortConstant(getOpcode(index)) && getOpcode(index+1)==Opcode.SLOAD && getOpcode(index+2)==Opcode.SADD)
+		{
+			loadIndex = index+1;
+			constantIndex = index;
+		} else
+			return false;
+		
+		LoadStoreInstruction load = (LoadStoreInstruction)handles.get(loadIndex).getInstruction();
+		LoadStoreInstruction store = (LoadStoreInstruction)handles.get(index+3).getInstruction();
+		if (load.getIndex()!=store.getIndex()) return false;
+
+		int value = (int)((PushInstruction)handles.get(constantIndex).getInstruction()).getValue();
+		if (getOpcode(index+2)==Opcode.SSUB)
+			value = -value;
+		else if (getOpcode(index+2)!=Opcode.SADD)
+			return false;
+
+		if (value>=Byte.MIN_VALUE && value<=Byte.MAX_VALUE)
+			fuse(index, 4, new IncreaseInstruction(Opcode.SINC, load.getLocalVariable(), value));
+		else if (value>=Short.MIN_VALUE && value<=Short.MAX_VALUE)
+			fuse(index, 4, new WideIncreaseInstruction(Opcode.SINC_W, load.getLocalVariable(), value));
+		else
+			return false;
+		
+		return true;
+	}
+	
+	/**
+	 * Fuses SLOAD x, SIFEQ into SLOAD_SIFEQ x, and likewise for SIFNE, IIFEQ and IIFNE.
+	 */
+	private boolean fuseLoadBranch(int index)
+	{
+		if (!isFusable(index, 2)) return false;
+		
+		Opcode load = getOpcode(index);
+		Opcode branch = getOpcode(index+1);
+		Opcode fused = fusedBranchOpcodes.get(branch);
+		if (fused==null) return false;
+		if (load!=((branch==Opcode.SIFEQ || branch==Opcode.SIFNE) ? Opcode.SLOAD : Opcode.ILOAD)) return false;
+		
+		LoadStoreInstruction instruction = (LoadStoreInstruction)handles.get(index).getInstruction();
+		fuse(index, 2, new LoadBranchInstruction(fused, instruction.getLocalVariable(), 0));
+		
+		return true;
+	}
+	
+	/**
+	 * Fuses ALOAD_0, GETFIELD_S into ALOAD_0_GETFIELD_S, and likewise for the other single slot field types.
+	 */
+	private boolean fuseGetField(int index)
+	{
+		if (!isFusable(index, 2)) return false;
+		if (getOpcode(index)!=Opcode.ALOAD) return false;
+		if (((LoadStoreInstruction)handles.get(index).getInstruction()).getIndex()!=0) return false;
+		
+		Opcode fused = fusedGetFieldOpcodes.get(getOpcode(index+1));
+		if (fused==null) return false;
+		
+		FieldInstruction getField = (FieldInstruction)handles.get(index+1).getInstruction();
+		fuse(index, 2, new FieldInstruction(fused, getField.getOffset()));
+		
+		return true;
+	}
+	
+	@Override
+	protected void transformInternal()
+	{
+		handles = codeBlock.getInstructions().getInstructionHandles();
+		findEntryPoints();
+		
+		// the longest sequence is tried first
+		for (int i=0; i<handles.size(); i++)
+			if (!fuseIncrease(i))
+				if (!fuseLoadBranch(i))
+					fuseGetField(i);
+		
+		codeBlock.getInstructions().reThreadStates();
+	}
+
+}
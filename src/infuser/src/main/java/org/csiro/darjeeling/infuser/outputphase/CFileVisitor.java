@@ -59,6 +59,16 @@ public class CFileVisitor extends DescendingVisitor
 						generateMethodName(methodImplementation)
 						);
 			}
+			
+			if (((InternalMethodImplementation)methodImplementation).isCompiled())
+			{
+				writer.println("#ifdef EXECUTION_AOT");
+				writer.printf("\t\tcase %d: %s(id.infusion); break;\n",
+						methodImplementation.getGlobalId().getEntityId(),
+						generateMethodName(methodImplementation)
+						);
+				writer.println("#endif");
+			}
 		}
 		
 		writer.println("\t}");
@@ -77,6 +87,20 @@ public class CFileVisitor extends DescendingVisitor
 		writer.println("#include \"types.h\"");
 		writer.println("");
 		
+		// compiled methods access the VM internals directly
+		for (AbstractMethodImplementation methodImplementation : element.getMethodImplementationList().getChildren())
+			if (((InternalMethodImplementation)methodImplementation).isCompiled())
+			{
+				writer.println("#ifdef EXECUTION_AOT");
+				writer.println("#include \"execution.h\"");
+				writer.println("#include \"array.h\"");
+				writer.println("#include \"infusion.h\"");
+				writer.println("#include \"heap.h\"");
+				writer.println("#endif");
+				writer.println("");
+				break;
+			}
+		
 		visit((ParentElement<Element>)element);
 
 		generateNativeHandler(element);
@@ -129,6 +153,18 @@ public class CFileVisitor extends DescendingVisitor
 			writer.printf("void %s();\n\n", generateMethodName(element));
 			
 		}
+		
+		if (element.isCompiled())
+		{
+			writer.println("#ifdef EXECUTION_AOT");
+			writer.printf("// %s\n", generateFriendlyMethodName(element));
+			writer.printf("static void %s(dj_infusion *infusion)\n", generateMethodName(element));
+			writer.println("{");
+			writer.print(element.getCompiledCode());
+			writer.println("}");
+			writer.println("#endif");
+			writer.println("");
+		}
 
 	}
 	
@@ -0,0 +1,57 @@
+/*
+ * CompileMethodsVisitor.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+package org.csiro.darjeeling.infuser.processingphase;
+
+import org.csiro.darjeeling.infuser.bytecode.CodeBlockCompiler;
+import org.csiro.darjeeling.infuser.logging.Logging;
+import org.csiro.darjeeling.infuser.structure.DescendingVisitor;
+import org.csiro.darjeeling.infuser.structure.Element;
+import org.csiro.darjeeling.infuser.structure.elements.internal.InternalMethodImplementation;
+
+/**
+ * Compiles the methods of an infusion to C where possible. The generated code is written to the native C file
+ * of the infusion by the CFileVisitor, and the methods are flagged as compiled in the infusion file so that the
+ * VM calls them through the infusion's native handler.
+ */
+public class CompileMethodsVisitor extends DescendingVisitor
+{
+	
+	@Override
+	public void visit(InternalMethodImplementation element)
+	{
+		CodeBlockCompiler compiler = new CodeBlockCompiler(element);
+		String code = compiler.compile();
+		
+		if (code==null)
+			Logging.instance.printlnVerbose(Logging.VerboseOutputType.BYTECODE_PROCESSING, String.format("not compiling %s.%s: %s", element.getParentClass(), element.getMethodDefinition(), compiler.getReason()));
+		else
+			Logging.instance.printlnVerbose(Logging.VerboseOutputType.BYTECODE_PROCESSING, String.format("compiled %s.%s", element.getParentClass(), element.getMethodDefinition()));
+		
+		element.setCompiledCode(code);
+	}
+
+	@Override
+	public void visit(Element element)
+	{
+	}
+
+}
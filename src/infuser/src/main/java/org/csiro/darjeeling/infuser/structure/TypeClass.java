@@ -30,6 +30,10 @@ public enum TypeClass
 	Reference(0,1),
 	Void(0,0);
 	
+	// Width in bits of an integer operand stack or local variable slot in the target VM. This is 16, or 32 for VMs
+	// built with EXECUTION_32BIT_SLOTS, in which case ints take one slot and longs two.
+	private static int slotWidth = 16;
+	
 	private int nrIntegerSlots, nrReferenceSlots;
 	
 	private TypeClass(int nrIntegerSlots, int nrReferenceSlots)
@@ -38,9 +42,26 @@ public enum TypeClass
 		this.nrReferenceSlots = nrReferenceSlots;
 	}
 	
+	public static void setSlotWidth(int slotWidth)
+	{
+		TypeClass.slotWidth = slotWidth;
+	}
+	
+	public static int getSlotWidth()
+	{
+		return slotWidth;
+	}
+	
+	/**
+	 * @return the number of integer slots a value of this type class takes on the operand stack or in the local
+	 * variables, for the slot width the infusion is built for
+	 */
 	public int getNrIntegerSlots()
 	{
-		return nrIntegerSlots;
+		if (slotWidth==32)
+			return (nrIntegerSlots+1)/2;
+		else
+			return nrIntegerSlots;
 	}
 	
 	public int getNrReferenceSlots()
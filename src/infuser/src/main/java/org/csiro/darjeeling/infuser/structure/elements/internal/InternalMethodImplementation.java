@@ -41,6 +41,9 @@ public class InternalMethodImplementation extends AbstractMethodImplementation
 	
 	private boolean isSynchronized;
 	private boolean isNative;
+	
+	// C function body generated by CodeBlockCompiler, or null if the method is interpreted
+	private String compiledCode;
 
 	protected InternalMethodImplementation()
 	{
@@ -140,4 +143,19 @@ public class InternalMethodImplementation extends AbstractMethodImplementation
 		return isSynchronized;
 	}
 	
+	public String getCompiledCode()
+	{
+		return compiledCode;
+	}
+	
+	public void setCompiledCode(String compiledCode)
+	{
+		this.compiledCode = compiledCode;
+	}
+	
+	public boolean isCompiled()
+	{
+		return compiledCode!=null;
+	}
+	
 }
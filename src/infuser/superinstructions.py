@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+##
+## Reports how much of an OPCODE_PROFILER profile the infuser's superinstructions cover.
+##
+## Build the VM with OPCODE_PROFILER (and without superInstructions in the config, so the profile shows the unfused
+## opcodes), run each app, and save what the VM prints at shutdown, one file per app:
+##
+##     superinstructions.py profiles/vmbench.txt profiles/arraybench.txt ...
+##
+## For each fusion done by SuperInstructions.java, the script counts the dispatches it removes, and prints the share
+## of all dispatched opcodes that is saved. It then lists the most executed pairs that aren't fused yet: those are the
+## candidates to add to SuperInstructions.java and to the VM's EXECUTION_SUPERINSTRUCTIONS handlers.
+##
+## The profiler only prints its OPCODE_PROFILER_TOP most executed pairs and triples, so sequences below that are
+## missing from the counts. Raise OPCODE_PROFILER_TOP if the report says the lists were cut off.
+##
+
+import re
+import sys
+from collections import Counter
+
+def numbered(name, high=3):
+    return {name} | {"%s_%d" % (name, i) for i in range(high + 1)}
+
+SLOAD = numbered("sload")
+ILOAD = numbered("iload")
+SSTORE = numbered("sstore")
+SHORT_CONSTANTS = {"sconst_m1", "sconst_0", "sconst_1", "sconst_2", "sconst_3", "sconst_4", "sconst_5", "bspush", "sspush"}
+GETFIELDS = {"getfield_b", "getfield_c", "getfield_s", "getfield_i", "getfield_a"}
+
+# (description, sequence length, dispatches saved per execution, test on the sequence of opcode names)
+# These mirror the fusions in bytecode/transformations/SuperInstructions.java. The SINC fusion covers four opcodes,
+# which the profiler doesn't count, so it is estimated from the triples that start it; that is an upper bound, since
+# not every such triple is followed by a store to the same local variable.
+FUSIONS = [
+    ("sload, constant, sadd/ssub, sstore -> sinc", 3, 3,
+        lambda s: (s[0] in SLOAD and s[1] in SHORT_CONSTANTS and s[2] in ("sadd", "ssub")) or
+                  (s[0] in SHORT_CONSTANTS and s[1] in SLOAD and s[2] == "sadd")),
+    ("sload, sifeq/sifne -> sload_sifeq/sifne", 2, 1,
+        lambda s: s[0] in SLOAD and s[1] in ("sifeq", "sifne")),
+    ("iload, iifeq/iifne -> iload_iifeq/iifne", 2, 1,
+        lambda s: s[0] in ILOAD and s[1] in ("iifeq", "iifne")),
+    ("aload_0, getfield -> aload_0_getfield", 2, 1,
+        lambda s: s[0] == "aload_0" and s[1] in GETFIELDS),
+]
+
+LINE = re.compile(r"^\s*(\d+)\s+[\d.]+%\s+((?:\d+\s+)+)\s*([a-z_0-9 ]+?)\s*$")
+
+def parse(path):
+    dispatched = 0
+    tables = {2: Counter(), 3: Counter()}
+    truncated = set()
+    length = None
+    with open(path) as f:
+        for line in f:
+            if line.startswith("Opcodes dispatched:"):
+                dispatched += int(line.split(":")[1])
+            elif line.startswith("Opcode pairs:"):
+                length = 2
+            elif line.startswith("Opcode triples:"):
+                length = 3
+            elif length is not None:
+                if "(table full)" in line:
+                    truncated.add(length)
+                    continue
+                match = LINE.match(line)
+                if match:
+                    tables[length][tuple(match.group(3).split())] += int(match.group(1))
+    return dispatched, tables, truncated
+
+def main(paths):
+    if not paths:
+        sys.stderr.write("usage: superinstructions.py <profile> ...\n")
+        sys.exit(1)
+
+    dispatched = 0
+    tables = {2: Counter(), 3: Counter()}
+    for path in paths:
+        d, t, truncated = parse(path)
+        dispatched += d
+        for length in tables:
+            tables[length].update(t[length])
+        if truncated:
+            print("%s: profiler table full, counts are incomplete" % path)
+
+    if dispatched == 0:
+        print("no dispatches in the profiles")
+        return
+
+    print("%d opcodes dispatched in %d profile(s)\n" % (dispatched, len(paths)))
+
+    total_saved = 0
+    for description, length, saved, test in FUSIONS:
+        count = sum(n for sequence, n in tables[length].items() if test(sequence))
+        total_saved += count * saved
+        print("%-45s %10d executions %10d dispatches saved %5.1f%%" %
+              (description, count, count * saved, 100.0 * count * saved / dispatched))
+    print("%-45s %21s %10d dispatches saved %5.1f%%\n" % ("total", "", total_saved, 100.0 * total_saved / dispatched))
+
+    print("most executed pairs that are not fused:")
+    fused = [test for description, length, saved, test in FUSIONS if length == 2]
+    shown = 0
+    for sequence, count in tables[2].most_common():
+        if any(test(sequence) for test in fused):
+            continue
+        print("%10d %5.1f%%  %s" % (count, 100.0 * count / dispatched, " ".join(sequence)))
+        shown += 1
+        if shown == 20:
+            break
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,123 @@
+/*
+ * AOTKernels.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+package javax.darjeeling.aottest;
+
+/**
+ * Leaf methods that the infuser compiles to C, since this library is built with aotCompile = true. The aottest app
+ * runs each of them next to an interpreted copy and compares the results. Together they cover the instruction groups
+ * the compiler translates: short, int and long arithmetic, conversions, branches and switches, array and static field
+ * access, and the runtime exceptions compiled code can throw.
+ */
+public class AOTKernels
+{
+	public static int counter;
+
+	public static int loop(int n)
+	{
+		int a = 0, b = 1;
+		for (int i=0; i<n; i++)
+		{
+			a += b ^ i;
+			b = (b << 1) | (a & 1);
+		}
+		return a + b;
+	}
+
+	public static short shorts(short a, short b)
+	{
+		short r = (short)(a * b + (a >> 2) - (b << 3));
+		r ^= (short)(a >>> 1);
+		if (b != 0)
+			r += (short)(a / b + a % b);
+		return (short)-r;
+	}
+
+	public static long longs(long a, int n)
+	{
+		long r = 1;
+		for (int i=0; i<n; i++)
+		{
+			r = r * 31 + (a >>> (i & 63)) - (a << 3);
+			if (r < a)
+				r ^= a;
+		}
+		return r;
+	}
+
+	public static int conversions(int a)
+	{
+		byte b = (byte)a;
+		char c = (char)a;
+		short s = (short)a;
+		long l = (long)a * 100000;
+		return b + c + s + (int)(l >> 16);
+	}
+
+	public static int select(int k)
+	{
+		switch (k)
+		{
+			case 0: return 10;
+			case 1: return 11;
+			case 2: return 12;
+			case 3: return 13;
+			default: break;
+		}
+		switch (k)
+		{
+			case -1000: return 1;
+			case 7: return 2;
+			case 100000: return 3;
+			default: return -1;
+		}
+	}
+
+	public static int sum(int[] a)
+	{
+		int s = 0;
+		for (int i=0; i<a.length; i++)
+			s += a[i];
+		return s;
+	}
+
+	public static int get(int[] a, int i)
+	{
+		return a[i];
+	}
+
+	public static void fill(byte[] a, byte value)
+	{
+		for (int i=0; i<a.length; i++)
+			a[i] = (byte)(value + i);
+	}
+
+	public static int bump(int d)
+	{
+		counter += d;
+		return counter;
+	}
+
+	public static int divide(int a, int b)
+	{
+		return a / b;
+	}
+}
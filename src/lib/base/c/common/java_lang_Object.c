@@ -43,7 +43,11 @@ void java_lang_Object_void_wait_int()
 
 	dj_thread * thread = dj_exec_getCurrentThread();
 
-	dj_thread_wait(thread, object, timeOut);
+	if (!dj_thread_wait(thread, object, timeOut))
+	{
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IllegalMonitorStateException);
+		return;
+	}
 	dj_exec_breakExecution();
 }
 
@@ -55,7 +59,11 @@ void java_lang_Object_void_wait()
 	dj_object * object = (dj_object*)REF_TO_VOIDP(dj_exec_stackPeekRef());
 	dj_thread * thread = dj_exec_getCurrentThread();
 
-	dj_thread_wait(thread, object, 0);
+	if (!dj_thread_wait(thread, object, 0))
+	{
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IllegalMonitorStateException);
+		return;
+	}
 	dj_exec_breakExecution();
 }
 
@@ -66,10 +74,9 @@ void java_lang_Object_void_notify()
 	// because it's cleared by the VM's frame management.
 	dj_object * object = (dj_object*)REF_TO_VOIDP(dj_exec_stackPeekRef());
 
-	// make sure the thread owns the lock
-	// TODO implement this check
-
-	dj_vm_notify(dj_exec_getVM(), object, false);
+	// the thread must own the lock
+	if (!dj_vm_notify(dj_exec_getVM(), object, false))
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IllegalMonitorStateException);
 }
 
 // void java.lang.Object.notifyAll()
@@ -78,7 +85,10 @@ void java_lang_Object_void_notifyAll()
 	// Don't pop, just peek the object reference off the runtime stack,
 	// because it's cleared by the VM's frame management.
 	dj_object * object = (dj_object*)REF_TO_VOIDP(dj_exec_stackPeekRef());
-	dj_vm_notify(dj_exec_getVM(), object, false);
+
+	// the thread must own the lock
+	if (!dj_vm_notify(dj_exec_getVM(), object, true))
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IllegalMonitorStateException);
 }
 
 void java_lang_Object_java_lang_String_toString()
@@ -126,6 +126,9 @@ void java_lang_System_void_arraycopy_java_lang_Object_int_java_lang_Object_int_i
 	{
 		dj_ref_array *srcref = (dj_ref_array*)src;
 		dj_ref_array *dstref = (dj_ref_array*)dst;
+#ifdef GC_INCREMENTAL
+		int32_t i;
+#endif
 
 		// test class compatibility
 		if (!dj_global_id_testClassType(
@@ -139,6 +142,10 @@ void java_lang_System_void_arraycopy_java_lang_Object_int_java_lang_Object_int_i
 
 		// copy references
 		copyFunction(dstref->refs+dst_pos, srcref->refs+src_pos, length * sizeof(ref_t));
+#ifdef GC_INCREMENTAL
+		for (i=0; i<length; i++)
+			dj_mem_writeBarrier(dstref->refs[dst_pos + i]);
+#endif
 	}
 
 }
@@ -29,6 +29,7 @@
 #include "panic.h"
 
 #include "pointerwidth.h"
+#include "scheduler.h"
 
 // generated by the infuser
 #include "jlib_base.h"
@@ -68,7 +69,7 @@ void java_lang_Thread_void__start_short()
 	dj_global_id methodImplId = dj_global_id_lookupVirtualMethod(methodDefId, thread->runnable);
 
 	// create a frame for the 'run' function and push it on the thread stack
-	dj_frame *frame = dj_frame_create(methodImplId);
+	dj_frame *frame = dj_thread_createFrame(thread, methodImplId);
 
 	// check that the frame alloc was succesful
 	if(frame == NULL)
@@ -85,7 +86,7 @@ void java_lang_Thread_void__start_short()
 		dj_frame_getLocalReferenceVariables(frame)[0] = VOIDP_TO_REF(thread->runnable);
 
 		// mark new thread eligible for execution
-		thread->status = THREADSTATUS_RUNNING;
+		dj_scheduler_makeReady(dj_exec_getVM(), thread);
 	}
 
 	dj_mem_removeSafePointer((void**)&thread);
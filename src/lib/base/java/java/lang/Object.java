@@ -11,5 +11,13 @@ public class Object
 	}
 
 	public native int hashCode();
+
+	public final native void wait();
+
+	public final native void wait(int timeout);
+
+	public final native void notify();
+
+	public final native void notifyAll();
 	
 }
@@ -0,0 +1,399 @@
+/*
+ * javax_darjeeling_Arrays.c
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+// generated at infusion time
+#include "jlib_base.h"
+
+#include "types.h"
+#include "execution.h"
+#include "array.h"
+
+/*
+ * Native implementation of javax.darjeeling.Arrays.
+ *
+ * The kernels below are plain counted loops over restrict pointers with no early exits (except where the result is
+ * known, like compare and indexOf), so that gcc can vectorise them on native and generate a tight pointer increment
+ * loop on AVR.
+ * Accumulation is done in uint32_t, which wraps around exactly like Java int arithmetic does.
+ */
+
+#define ARRAYS_KERNELS(name, type) \
+static void dj_arrays_fill_##name(type * restrict dst, uint16_t n, type value) \
+{ \
+	for (uint16_t i=0; i<n; i++) dst[i] = value; \
+} \
+static int32_t dj_arrays_compare_##name(const type * restrict a, const type * restrict b, uint16_t n) \
+{ \
+	for (uint16_t i=0; i<n; i++) \
+		if (a[i]!=b[i]) return (a[i]<b[i]) ? -1 : 1; \
+	return 0; \
+} \
+static int32_t dj_arrays_indexOf_##name(const type * restrict a, uint16_t from, uint16_t n, type value) \
+{ \
+	for (uint16_t i=from; i<n; i++) \
+		if (a[i]==value) return i; \
+	return -1; \
+} \
+static int32_t dj_arrays_sum_##name(const type * restrict a, uint16_t n) \
+{ \
+	uint32_t sum = 0; \
+	for (uint16_t i=0; i<n; i++) sum += (uint32_t)(int32_t)a[i]; \
+	return (int32_t)sum; \
+} \
+static int32_t dj_arrays_min_##name(const type * restrict a, uint16_t n) \
+{ \
+	type min = a[0]; \
+	for (uint16_t i=1; i<n; i++) min = (a[i]<min) ? a[i] : min; \
+	return min; \
+} \
+static int32_t dj_arrays_max_##name(const type * restrict a, uint16_t n) \
+{ \
+	type max = a[0]; \
+	for (uint16_t i=1; i<n; i++) max = (a[i]>max) ? a[i] : max; \
+	return max; \
+} \
+static int32_t dj_arrays_dot_##name(const type * restrict a, const type * restrict b, uint16_t n) \
+{ \
+	uint32_t sum = 0; \
+	for (uint16_t i=0; i<n; i++) sum += (uint32_t)(int32_t)a[i] * (uint32_t)(int32_t)b[i]; \
+	return (int32_t)sum; \
+}
+
+ARRAYS_KERNELS(byte, int8_t)
+ARRAYS_KERNELS(short, int16_t)
+ARRAYS_KERNELS(int, int32_t)
+
+/**
+ * Converts a reference popped from the stack to an int array, throwing a NullPointerException if it is null.
+ * @param ref the array reference.
+ * @return the array, or NULL if an exception was thrown.
+ */
+static dj_int_array *dj_arrays_get(ref_t ref)
+{
+	dj_int_array *array = (dj_int_array*)REF_TO_VOIDP(ref);
+	if (array==NULL)
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_NullPointerException);
+	return array;
+}
+
+/**
+ * Checks that [from, to) is a valid range within an array, throwing an IndexOutOfBoundsException if it isn't.
+ * @param array the array.
+ * @param from the first index of the range.
+ * @param to the index just after the last element of the range.
+ * @param allowEmpty whether an empty range is acceptable.
+ * @return true if the range is valid.
+ */
+static bool dj_arrays_checkRange(dj_int_array *array, int32_t from, int32_t to, bool allowEmpty)
+{
+	if (from<0 || to>array->array.length || from>to || (!allowEmpty && from==to))
+	{
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IndexOutOfBoundsException);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Pops the (array, from, to) arguments shared by sum, min and max, and checks them.
+ * @param allowEmpty whether an empty range is acceptable.
+ * @param from receives the first index of the range.
+ * @param n receives the number of elements in the range.
+ * @return the array, or NULL if an exception was thrown.
+ */
+static dj_int_array *dj_arrays_popRange(bool allowEmpty, uint16_t *from, uint16_t *n)
+{
+	int32_t to = dj_exec_stackPopInt();
+	int32_t start = dj_exec_stackPopInt();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array==NULL || !dj_arrays_checkRange(array, start, to, allowEmpty))
+		return NULL;
+
+	*from = start;
+	*n = to - start;
+	return array;
+}
+
+/**
+ * Pops two array arguments, throwing a NullPointerException if either is null.
+ * @param b receives the second array.
+ * @return the first array, or NULL if an exception was thrown.
+ */
+static dj_int_array *dj_arrays_popPair(dj_int_array **b)
+{
+	*b = dj_arrays_get(dj_exec_stackPopRef());
+	dj_int_array *a = dj_arrays_get(dj_exec_stackPopRef());
+	return (a==NULL || *b==NULL) ? NULL : a;
+}
+
+/**
+ * Compares two arrays of the same type lexicographically, see javax.darjeeling.Arrays.compare.
+ */
+static int32_t dj_arrays_compare(dj_int_array *a, dj_int_array *b)
+{
+	uint16_t n = (a->array.length < b->array.length) ? a->array.length : b->array.length;
+	int32_t ret;
+
+	switch (a->type)
+	{
+		case T_BYTE: ret = dj_arrays_compare_byte(a->data.bytes, b->data.bytes, n); break;
+		case T_SHORT: ret = dj_arrays_compare_short(a->data.shorts, b->data.shorts, n); break;
+		default: ret = dj_arrays_compare_int(a->data.ints, b->data.ints, n); break;
+	}
+
+	if (ret==0 && a->array.length!=b->array.length)
+		ret = (a->array.length < b->array.length) ? -1 : 1;
+
+	return ret;
+}
+
+/**
+ * Pops the arguments of equals and pushes the result.
+ * @param elementSize size of an array element in bytes.
+ */
+static void dj_arrays_equals(uint8_t elementSize)
+{
+	dj_int_array *b, *a = dj_arrays_popPair(&b);
+	if (a==NULL) return;
+
+	dj_exec_stackPushShort(a->array.length==b->array.length
+			&& memcmp(a->data.bytes, b->data.bytes, (size_t)a->array.length * elementSize)==0);
+}
+
+/**
+ * Pops the arguments of dot, checks the arrays have the same length, and returns them.
+ * @param b receives the second array.
+ * @return the first array, or NULL if an exception was thrown.
+ */
+static dj_int_array *dj_arrays_popDot(dj_int_array **b)
+{
+	dj_int_array *a = dj_arrays_popPair(b);
+	if (a!=NULL && a->array.length!=(*b)->array.length)
+	{
+		dj_exec_createAndThrow(BASE_CDEF_java_lang_IndexOutOfBoundsException);
+		return NULL;
+	}
+	return a;
+}
+
+// void javax.darjeeling.Arrays.fill(byte[], int, int, byte)
+void javax_darjeeling_Arrays_void_fill_byte___int_int_byte()
+{
+	int8_t value = dj_exec_stackPopShort();
+	int32_t to = dj_exec_stackPopInt();
+	int32_t from = dj_exec_stackPopInt();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, to, true))
+		dj_arrays_fill_byte(array->data.bytes + from, to - from, value);
+}
+
+// void javax.darjeeling.Arrays.fill(short[], int, int, short)
+void javax_darjeeling_Arrays_void_fill_short___int_int_short()
+{
+	int16_t value = dj_exec_stackPopShort();
+	int32_t to = dj_exec_stackPopInt();
+	int32_t from = dj_exec_stackPopInt();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, to, true))
+		dj_arrays_fill_short(array->data.shorts + from, to - from, value);
+}
+
+// void javax.darjeeling.Arrays.fill(int[], int, int, int)
+void javax_darjeeling_Arrays_void_fill_int___int_int_int()
+{
+	int32_t value = dj_exec_stackPopInt();
+	int32_t to = dj_exec_stackPopInt();
+	int32_t from = dj_exec_stackPopInt();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, to, true))
+		dj_arrays_fill_int(array->data.ints + from, to - from, value);
+}
+
+// boolean javax.darjeeling.Arrays.equals(byte[], byte[])
+void javax_darjeeling_Arrays_boolean_equals_byte___byte__()
+{
+	dj_arrays_equals(sizeof(int8_t));
+}
+
+// boolean javax.darjeeling.Arrays.equals(short[], short[])
+void javax_darjeeling_Arrays_boolean_equals_short___short__()
+{
+	dj_arrays_equals(sizeof(int16_t));
+}
+
+// boolean javax.darjeeling.Arrays.equals(int[], int[])
+void javax_darjeeling_Arrays_boolean_equals_int___int__()
+{
+	dj_arrays_equals(sizeof(int32_t));
+}
+
+// int javax.darjeeling.Arrays.compare(byte[], byte[])
+void javax_darjeeling_Arrays_int_compare_byte___byte__()
+{
+	dj_int_array *b, *a = dj_arrays_popPair(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_compare(a, b));
+}
+
+// int javax.darjeeling.Arrays.compare(short[], short[])
+void javax_darjeeling_Arrays_int_compare_short___short__()
+{
+	dj_int_array *b, *a = dj_arrays_popPair(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_compare(a, b));
+}
+
+// int javax.darjeeling.Arrays.compare(int[], int[])
+void javax_darjeeling_Arrays_int_compare_int___int__()
+{
+	dj_int_array *b, *a = dj_arrays_popPair(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_compare(a, b));
+}
+
+// int javax.darjeeling.Arrays.indexOf(byte[], byte, int)
+void javax_darjeeling_Arrays_int_indexOf_byte___byte_int()
+{
+	int32_t from = dj_exec_stackPopInt();
+	int8_t value = dj_exec_stackPopShort();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, array->array.length, true))
+		dj_exec_stackPushInt(dj_arrays_indexOf_byte(array->data.bytes, from, array->array.length, value));
+}
+
+// int javax.darjeeling.Arrays.indexOf(short[], short, int)
+void javax_darjeeling_Arrays_int_indexOf_short___short_int()
+{
+	int32_t from = dj_exec_stackPopInt();
+	int16_t value = dj_exec_stackPopShort();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, array->array.length, true))
+		dj_exec_stackPushInt(dj_arrays_indexOf_short(array->data.shorts, from, array->array.length, value));
+}
+
+// int javax.darjeeling.Arrays.indexOf(int[], int, int)
+void javax_darjeeling_Arrays_int_indexOf_int___int_int()
+{
+	int32_t from = dj_exec_stackPopInt();
+	int32_t value = dj_exec_stackPopInt();
+	dj_int_array *array = dj_arrays_get(dj_exec_stackPopRef());
+
+	if (array!=NULL && dj_arrays_checkRange(array, from, array->array.length, true))
+		dj_exec_stackPushInt(dj_arrays_indexOf_int(array->data.ints, from, array->array.length, value));
+}
+
+// int javax.darjeeling.Arrays.sum(byte[], int, int)
+void javax_darjeeling_Arrays_int_sum_byte___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(true, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_sum_byte(array->data.bytes + from, n));
+}
+
+// int javax.darjeeling.Arrays.sum(short[], int, int)
+void javax_darjeeling_Arrays_int_sum_short___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(true, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_sum_short(array->data.shorts + from, n));
+}
+
+// int javax.darjeeling.Arrays.sum(int[], int, int)
+void javax_darjeeling_Arrays_int_sum_int___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(true, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_sum_int(array->data.ints + from, n));
+}
+
+// int javax.darjeeling.Arrays.min(byte[], int, int)
+void javax_darjeeling_Arrays_int_min_byte___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_min_byte(array->data.bytes + from, n));
+}
+
+// int javax.darjeeling.Arrays.min(short[], int, int)
+void javax_darjeeling_Arrays_int_min_short___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_min_short(array->data.shorts + from, n));
+}
+
+// int javax.darjeeling.Arrays.min(int[], int, int)
+void javax_darjeeling_Arrays_int_min_int___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_min_int(array->data.ints + from, n));
+}
+
+// int javax.darjeeling.Arrays.max(byte[], int, int)
+void javax_darjeeling_Arrays_int_max_byte___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_max_byte(array->data.bytes + from, n));
+}
+
+// int javax.darjeeling.Arrays.max(short[], int, int)
+void javax_darjeeling_Arrays_int_max_short___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_max_short(array->data.shorts + from, n));
+}
+
+// int javax.darjeeling.Arrays.max(int[], int, int)
+void javax_darjeeling_Arrays_int_max_int___int_int()
+{
+	uint16_t from, n;
+	dj_int_array *array = dj_arrays_popRange(false, &from, &n);
+	if (array!=NULL) dj_exec_stackPushInt(dj_arrays_max_int(array->data.ints + from, n));
+}
+
+// int javax.darjeeling.Arrays.dot(byte[], byte[])
+void javax_darjeeling_Arrays_int_dot_byte___byte__()
+{
+	dj_int_array *b, *a = dj_arrays_popDot(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_dot_byte(a->data.bytes, b->data.bytes, a->array.length));
+}
+
+// int javax.darjeeling.Arrays.dot(short[], short[])
+void javax_darjeeling_Arrays_int_dot_short___short__()
+{
+	dj_int_array *b, *a = dj_arrays_popDot(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_dot_short(a->data.shorts, b->data.shorts, a->array.length));
+}
+
+// int javax.darjeeling.Arrays.dot(int[], int[])
+void javax_darjeeling_Arrays_int_dot_int___int__()
+{
+	dj_int_array *b, *a = dj_arrays_popDot(&b);
+	if (a!=NULL) dj_exec_stackPushInt(dj_arrays_dot_int(a->data.ints, b->data.ints, a->array.length));
+}
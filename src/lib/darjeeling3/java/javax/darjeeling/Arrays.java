@@ -0,0 +1,121 @@
+/*
+ * Arrays.java
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+package javax.darjeeling;
+
+/**
+ * 
+ * Bulk operations on byte, short and int arrays, implemented natively so that sensor processing code doesn't have to
+ * run element by element loops through the interpreter. Ranges are given as [from, to). All methods throw a
+ * NullPointerException if an array is null, and an IndexOutOfBoundsException if a range is not within the array.
+ * Sums and dot products are computed with int arithmetic and overflow the same way the equivalent Java loop would.
+ *
+ */
+public class Arrays
+{
+	/**
+	 * Sets the elements in [from, to) to the given value.
+	 */
+	public static native void fill(byte[] array, int from, int to, byte value);
+	public static native void fill(short[] array, int from, int to, short value);
+	public static native void fill(int[] array, int from, int to, int value);
+
+	/**
+	 * @return true if both arrays have the same length and elements.
+	 */
+	public static native boolean equals(byte[] a, byte[] b);
+	public static native boolean equals(short[] a, short[] b);
+	public static native boolean equals(int[] a, int[] b);
+
+	/**
+	 * Compares two arrays lexicographically.
+	 * @return a negative number, zero or a positive number if a is smaller than, equal to, or larger than b. If one
+	 * array is a prefix of the other, the shorter array is the smaller one.
+	 */
+	public static native int compare(byte[] a, byte[] b);
+	public static native int compare(short[] a, short[] b);
+	public static native int compare(int[] a, int[] b);
+
+	/**
+	 * @return the index of the first element in [from, array.length) that equals value, or -1 if there is none.
+	 */
+	public static native int indexOf(byte[] array, byte value, int from);
+	public static native int indexOf(short[] array, short value, int from);
+	public static native int indexOf(int[] array, int value, int from);
+
+	/**
+	 * @return the sum of the elements in [from, to).
+	 */
+	public static native int sum(byte[] array, int from, int to);
+	public static native int sum(short[] array, int from, int to);
+	public static native int sum(int[] array, int from, int to);
+
+	/**
+	 * @return the smallest element in [from, to). The range must not be empty.
+	 */
+	public static native int min(byte[] array, int from, int to);
+	public static native int min(short[] array, int from, int to);
+	public static native int min(int[] array, int from, int to);
+
+	/**
+	 * @return the largest element in [from, to). The range must not be empty.
+	 */
+	public static native int max(byte[] array, int from, int to);
+	public static native int max(short[] array, int from, int to);
+	public static native int max(int[] array, int from, int to);
+
+	/**
+	 * @return the sum of a[i]*b[i] over both arrays, which must have the same length.
+	 */
+	public static native int dot(byte[] a, byte[] b);
+	public static native int dot(short[] a, short[] b);
+	public static native int dot(int[] a, int[] b);
+
+	public static void fill(byte[] array, byte value)
+	{
+		fill(array, 0, array.length, value);
+	}
+
+	public static void fill(short[] array, short value)
+	{
+		fill(array, 0, array.length, value);
+	}
+
+	public static void fill(int[] array, int value)
+	{
+		fill(array, 0, array.length, value);
+	}
+
+	public static int indexOf(byte[] array, byte value)
+	{
+		return indexOf(array, value, 0);
+	}
+
+	public static int indexOf(short[] array, short value)
+	{
+		return indexOf(array, value, 0);
+	}
+
+	public static int indexOf(int[] array, int value)
+	{
+		return indexOf(array, value, 0);
+	}
+}
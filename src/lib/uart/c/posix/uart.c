@@ -5,23 +5,37 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "uart.h"
+#include "posix_poll.h"
 
 extern char* posix_uart_filenames[4]; // Should be filled from main.c
 int uart_fd[4] = {0, 0, 0, 0};
 
+// Closes a UART opened by uart_inituart, and stops waking up the main loop for it.
+static void uart_closeuart(uint8_t uart) {
+	posix_poll_unregister(uart_fd[uart]);
+	close(uart_fd[uart]);
+	uart_fd[uart] = 0;
+}
+
 void uart_inituart(uint8_t uart, uint32_t baudrate) {
 	if(posix_uart_filenames[uart] == NULL) {
 		printf("Uart %d not specified\n", uart);
 		abort();
 	}
 
+	if (uart_fd[uart] != 0)
+		uart_closeuart(uart);
+
 	int fd = open(posix_uart_filenames[uart], O_RDWR | O_NOCTTY);
-	if (uart_fd[uart] < 0) {
+	if (fd < 0) {
 		printf("open %s error\n", posix_uart_filenames[uart]);
 		abort();
 	}
 	uart_fd[uart] = fd;
 
+	// Wake up the main loop when data arrives, so it can idle in poll() instead of polling the UART
+	posix_poll_register(fd);
+
     struct termios newtio;
 	if (tcgetattr(uart_fd[uart], &newtio) < 0) {
 		printf("errors:tcgetattr.\n");
@@ -0,0 +1,257 @@
+/*
+ * alloc_profiler.c
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Allocation profiler.
+ *
+ * When ALLOC_PROFILER is defined, every heap allocation is counted per allocated type and per allocating method, so
+ * the Java code that churns the heap can be found. dj_mem_alloc() reports every chunk through dj_mem_allocHook, which
+ * is used to attribute it to the method executing in the current frame. dj_object_create(), dj_int_array_create() and
+ * dj_ref_array_create() report the class or element type of what they allocate.
+ *
+ * Classes and methods are recorded as an infusion header and entity id rather than as a runtime id or infusion
+ * pointer, because those change when infusions are loaded or unloaded, and infusion pointers also change when the
+ * heap is compacted. The tables are static so that profiling doesn't change the heap behaviour it measures. When a
+ * table is full, further types or methods are only counted in its overflow totals.
+ *
+ * The report is printed by dj_allocprof_dump(), and at shutdown through dj_core_shutdownHook.
+ */
+
+#include "alloc_profiler.h"
+#include "execution.h"
+#include "global_id.h"
+#include "parse_infusion.h"
+#include "heap.h"
+#include "debug.h"
+
+#include "config.h"
+
+#ifdef ALLOC_PROFILER
+
+typedef struct _dj_allocprof_entry
+{
+	dj_di_pointer infusion;		// header of the infusion, or 0 for chunk ids and integer array types
+	uint8_t entity_id;
+	uint8_t kind;
+	uint16_t count;
+	uint32_t bytes;
+} dj_allocprof_entry;
+
+typedef struct _dj_allocprof_table
+{
+	dj_allocprof_entry entries[ALLOC_PROFILER_SIZE];
+	uint8_t nr_entries;
+	uint16_t overflow_count;
+	uint32_t overflow_bytes;
+} dj_allocprof_table;
+
+static DJ_VM_LOCAL dj_allocprof_table typeTable;
+static DJ_VM_LOCAL dj_allocprof_table siteTable;
+
+/**
+ * Adds an allocation to a table.
+ * @param table the table to add the allocation to
+ * @param kind one of the DJ_ALLOCPROF_ constants
+ * @param infusion the header of the infusion that defines the entity, or 0
+ * @param entity_id the entity id within the infusion, or the chunk id or array type if infusion is 0
+ * @param bytes chunk size of the allocation, including the chunk header
+ */
+static void dj_allocprof_add(dj_allocprof_table *table, uint8_t kind, dj_di_pointer infusion, uint8_t entity_id, heap_size_t bytes)
+{
+	uint8_t i;
+	dj_allocprof_entry *entry;
+
+	for (i=0; i<table->nr_entries; i++)
+	{
+		entry = &table->entries[i];
+		if (entry->kind==kind && entry->infusion==infusion && entry->entity_id==entity_id)
+		{
+			entry->count++;
+			entry->bytes += bytes;
+			return;
+		}
+	}
+
+	if (table->nr_entries==ALLOC_PROFILER_SIZE)
+	{
+		table->overflow_count++;
+		table->overflow_bytes += bytes;
+		return;
+	}
+
+	entry = &table->entries[table->nr_entries++];
+	entry->kind = kind;
+	entry->infusion = infusion;
+	entry->entity_id = entity_id;
+	entry->count = 1;
+	entry->bytes = bytes;
+}
+
+/**
+ * Records the allocating method of a new chunk. Called through dj_mem_allocHook for every chunk that is allocated.
+ * Chunks that are not Java objects or arrays are also counted per chunk id, since dj_allocprof_recordType() is only
+ * called for those.
+ * @param data pointer to the new chunk
+ */
+void dj_allocprof_recordChunk(void *data)
+{
+	uint16_t id = dj_mem_getChunkId(data);
+	heap_size_t size = dj_mem_getChunkSize(data);
+	dj_vm *vm = dj_exec_getVM();
+	dj_thread *thread;
+
+	// allocations by the VM itself, for instance while loading infusions, are attributed to method 0 of no infusion
+	if (vm!=NULL && (thread = dj_exec_getCurrentThread())!=NULL && thread->frameStack!=NULL)
+		dj_allocprof_add(&siteTable, DJ_ALLOCPROF_METHOD, thread->frameStack->method.infusion->header,
+				thread->frameStack->method.entity_id, size);
+	else
+		dj_allocprof_add(&siteTable, DJ_ALLOCPROF_METHOD, 0, 0, size);
+
+	if (id<CHUNKID_JAVA_START && id!=CHUNKID_INTARRAY && id!=CHUNKID_REFARRAY)
+		dj_allocprof_add(&typeTable, DJ_ALLOCPROF_CHUNK, 0, id, size);
+}
+
+/**
+ * Records the type of a new Java object or array.
+ * @param kind DJ_ALLOCPROF_OBJECT, DJ_ALLOCPROF_INT_ARRAY or DJ_ALLOCPROF_REF_ARRAY
+ * @param id runtime id of the class for objects and reference arrays, element type for integer arrays
+ * @param ptr the new object or array
+ */
+void dj_allocprof_recordType(uint8_t kind, runtime_id_t id, void *ptr)
+{
+	dj_global_id classId;
+	heap_size_t size = dj_mem_getChunkSize(ptr);
+
+	if (kind==DJ_ALLOCPROF_INT_ARRAY || id<CHUNKID_JAVA_START)
+		dj_allocprof_add(&typeTable, kind, 0, id, size);
+	else
+	{
+		classId = dj_vm_getRuntimeClass(dj_exec_getVM(), id);
+		dj_allocprof_add(&typeTable, kind, classId.infusion->header, classId.entity_id, size);
+	}
+}
+
+/**
+ * Sorts a table by the number of bytes allocated, largest first.
+ * @param table the table to sort
+ */
+static void dj_allocprof_sort(dj_allocprof_table *table)
+{
+	int i, j;
+	dj_allocprof_entry entry;
+
+	for (i=1; i<table->nr_entries; i++)
+	{
+		entry = table->entries[i];
+		for (j=i; j>0 && table->entries[j-1].bytes<entry.bytes; j--)
+			table->entries[j] = table->entries[j-1];
+		table->entries[j] = entry;
+	}
+}
+
+/**
+ * Prints the name of the infusion with the given header, if it's still loaded.
+ * @param header infusion header
+ */
+static void dj_allocprof_printInfusion(dj_di_pointer header)
+{
+	dj_vm *vm = dj_exec_getVM();
+	dj_infusion *infusion = (vm==NULL) ? NULL : vm->infusions;
+
+	while (infusion!=NULL && infusion->header!=header)
+		infusion = infusion->next;
+
+	if (infusion!=NULL)
+		DARJEELING_PRINTF("%s", (char *) dj_di_header_getInfusionName(header));
+	else
+		DARJEELING_PRINTF("(unloaded)");
+}
+
+/**
+ * Prints one table of the report.
+ * @param table the table to print
+ */
+static void dj_allocprof_printTable(dj_allocprof_table *table)
+{
+	uint8_t i;
+	dj_allocprof_entry *entry;
+
+	dj_allocprof_sort(table);
+
+	for (i=0; i<table->nr_entries; i++)
+	{
+		entry = &table->entries[i];
+		DARJEELING_PRINTF("\t%8ld bytes %6d allocations  ", (long)entry->bytes, entry->count);
+
+		if (entry->kind==DJ_ALLOCPROF_CHUNK)
+			DARJEELING_PRINTF("chunk id %d\n", entry->entity_id);
+		else if (entry->kind==DJ_ALLOCPROF_INT_ARRAY)
+			DARJEELING_PRINTF("array of type %d\n", entry->entity_id);
+		else if (entry->kind==DJ_ALLOCPROF_METHOD && entry->infusion==0)
+			DARJEELING_PRINTF("(vm)\n");
+		else
+		{
+			if (entry->kind==DJ_ALLOCPROF_REF_ARRAY) DARJEELING_PRINTF("array of ");
+
+			if (entry->infusion==0)
+				DARJEELING_PRINTF("runtime class %d\n", entry->entity_id);
+			else
+			{
+				dj_allocprof_printInfusion(entry->infusion);
+				DARJEELING_PRINTF(entry->kind==DJ_ALLOCPROF_METHOD ? " method %d\n" : " class %d\n", entry->entity_id);
+			}
+		}
+	}
+
+	if (table->overflow_count>0)
+		DARJEELING_PRINTF("\t%8ld bytes %6d allocations  (table full)\n", (long)table->overflow_bytes, table->overflow_count);
+}
+
+/**
+ * Prints the number of allocations and bytes allocated per type and per allocating method, largest first.
+ */
+void dj_allocprof_dump()
+{
+	DARJEELING_PRINTF("Allocations per type:\n");
+	dj_allocprof_printTable(&typeTable);
+	DARJEELING_PRINTF("Allocations per method:\n");
+	dj_allocprof_printTable(&siteTable);
+}
+
+/**
+ * Clears the counters, so that allocations can be profiled for a specific part of a program.
+ */
+void dj_allocprof_reset()
+{
+	typeTable.nr_entries = 0;
+	typeTable.overflow_count = 0;
+	typeTable.overflow_bytes = 0;
+	siteTable.nr_entries = 0;
+	siteTable.overflow_count = 0;
+	siteTable.overflow_bytes = 0;
+}
+
+void dj_allocprof_shutdown(void *data)
+{
+	dj_allocprof_dump();
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "debug.h"
 #include "core.h"
 #include "panic.h"
+#include "alloc_profiler.h"
 
 /**
  * Creates a new integer array.
@@ -36,7 +37,7 @@
 dj_int_array *dj_int_array_create(uint8_t type, uint16_t size)
 {
 	dj_int_array *arr;
-	uint16_t byteSize = size;
+	uint32_t byteSize = size;
 
 	if ( type==T_BOOLEAN || type==T_BYTE || type==T_CHAR) { byteSize = size; } else
 	if ( type==T_SHORT ) byteSize = size*sizeof(int16_t); else
@@ -47,6 +48,9 @@ dj_int_array *dj_int_array_create(uint8_t type, uint16_t size)
 		dj_panic(DJ_PANIC_UNIMPLEMENTED_FEATURE);
 	}
 
+	// the array has to fit in a single chunk
+	if (byteSize + sizeof(dj_int_array) > HEAP_MAX_CHUNK_SIZE) return NULL;
+
 	// allocate array
 	arr = (dj_int_array*)dj_mem_alloc( byteSize + sizeof(dj_int_array), CHUNKID_INTARRAY );
 
@@ -62,6 +66,10 @@ dj_int_array *dj_int_array_create(uint8_t type, uint16_t size)
 	// set array type
 	arr->type = type;
 
+#ifdef ALLOC_PROFILER
+	dj_allocprof_recordType(DJ_ALLOCPROF_INT_ARRAY, type, arr);
+#endif
+
 	// C be a harsh mistress!
 	return arr;
 }
@@ -82,6 +90,9 @@ dj_ref_array *dj_ref_array_create(runtime_id_t runtime_class_id, uint16_t size)
 {
 	dj_ref_array *arr;
 
+	// the array has to fit in a single chunk
+	if ((uint32_t)size * sizeof(ref_t) + sizeof(dj_ref_array) > HEAP_MAX_CHUNK_SIZE) return NULL;
+
 	// allocate array
 	arr = (dj_ref_array*)dj_mem_alloc( size * sizeof(ref_t) + sizeof(dj_ref_array), CHUNKID_REFARRAY );
 
@@ -97,6 +108,10 @@ dj_ref_array *dj_ref_array_create(runtime_id_t runtime_class_id, uint16_t size)
 	// init array to zeroes
 	memset(arr->refs, 0, size*sizeof(ref_t));
 
+#ifdef ALLOC_PROFILER
+	dj_allocprof_recordType(DJ_ALLOCPROF_REF_ARRAY, runtime_class_id, arr);
+#endif
+
 	// C be a harsh mistress!
 	return arr;
 
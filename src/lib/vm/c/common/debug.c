@@ -33,8 +33,9 @@
 // though, we only need them when actually doing some debugging
 #if defined(DARJEELING_DEBUG) || defined(DARJEELING_DEBUG_PERFILE)
 
-int  darjeeling_debug_nesting_level=0;
-int  darjeeling_debug_indent_index=0;
+// nesting of the DEBUG_ENTER_NEST/DEBUG_EXIT_NEST traces, kept per VM instance (DJ_MULTI_VM)
+DJ_VM_LOCAL int  darjeeling_debug_nesting_level=0;
+DJ_VM_LOCAL int  darjeeling_debug_indent_index=0;
 
 
 // dumps the  stack frame, and  calls itself recursively to  print the
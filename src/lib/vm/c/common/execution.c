@@ -54,14 +54,22 @@
 #include "vm.h"
 #include "vm_gc.h"
 #include "global_id.h"
+#include "type_table.h"
 #include "debug.h"
 #include "panic.h"
 #include "hooks.h"
 #include "core.h"
+#include "opcode_profiler.h"
 
 // platform-specific configuration
 #include "config.h"
 
+// Threaded dispatch relies on the GCC labels-as-values extension, and the per-instruction trace output
+// is only produced by the switch interpreter.
+#if defined(EXECUTION_THREADED_DISPATCH) && (!defined(__GNUC__) || defined(DARJEELING_DEBUG_TRACE))
+#undef EXECUTION_THREADED_DISPATCH
+#endif
+
 // generated at infusion time
 #include "jlib_base.h"
 
@@ -71,36 +79,80 @@
 #include "opcodes.c"
 
 // currently selected Virtual Machine context
-static dj_vm *vm;
+static DJ_VM_LOCAL dj_vm *vm;
 
 // global variables for quick access
 //static dj_thread *currentThread;
 
 // execution state
-static uint16_t pc;
-static dj_di_pointer code;
+static DJ_VM_LOCAL uint16_t pc;
+static DJ_VM_LOCAL dj_di_pointer code;
+
+static DJ_VM_LOCAL dj_int_slot *intStack;
+static DJ_VM_LOCAL ref_t *refStack;
 
-static int16_t *intStack;
-static ref_t *refStack;
+static DJ_VM_LOCAL ref_t *localReferenceVariables;
+static DJ_VM_LOCAL dj_int_slot *localIntegerVariables;
 
-static ref_t *localReferenceVariables;
-static int16_t *localIntegerVariables;
+static DJ_VM_LOCAL ref_t *referenceParameters;
+static DJ_VM_LOCAL dj_int_slot *integerParameters;
 
-static ref_t *referenceParameters;
-static int16_t *integerParameters;
+static DJ_VM_LOCAL uint8_t nrReferenceParameters;
+static DJ_VM_LOCAL uint8_t nrIntegerParameters;
 
-static uint8_t nrReferenceParameters;
-static uint8_t nrIntegerParameters;
+static DJ_VM_LOCAL ref_t this;
 
-static ref_t this;
+static DJ_VM_LOCAL int nrOpcodesLeft;
 
-static int nrOpcodesLeft;
+// cleared through javax.rtc.RTC.useRTC to run methods the infuser compiled to C in the interpreter instead
+DJ_VM_LOCAL bool dj_exec_use_rtc = true;
 #ifdef DARJEELING_DEBUG
-static uint32_t totalNrOpcodes;
-static uint16_t oldPc;
+static DJ_VM_LOCAL uint32_t totalNrOpcodes;
+static DJ_VM_LOCAL uint16_t oldPc;
 #endif
 #ifdef DARJEELING_DEBUG_TRACE
-static int callDepth = 0;
+static DJ_VM_LOCAL int callDepth = 0;
+#endif
+
+#ifdef EXECUTION_INLINE_CACHE
+// Polymorphic inline caches for INVOKEVIRTUAL/INVOKEINTERFACE. Bytecode lives in program memory and can't be patched,
+// so the caches live in a small direct-mapped table indexed on the address of the call site. Each slot remembers the
+// method implementations for up to EXECUTION_INLINE_CACHE_WAYS receiver classes, replaced round-robin once full.
+typedef struct _dj_exec_invokeCacheWay
+{
+	runtime_id_t classId;
+	dj_global_id methodImplId;
+	dj_di_pointer methodImpl;
+} dj_exec_invokeCacheWay;
+
+typedef struct _dj_exec_invokeCacheEntry
+{
+	dj_di_pointer site;
+	uint8_t nrWays;
+	uint8_t nextWay;
+	dj_exec_invokeCacheWay ways[EXECUTION_INLINE_CACHE_WAYS];
+} dj_exec_invokeCacheEntry;
+
+static DJ_VM_LOCAL dj_exec_invokeCacheEntry invokeCache[EXECUTION_INLINE_CACHE_SIZE];
+#endif
+
+#ifdef EXECUTION_QUICKENING
+// Quickening table for INVOKESTATIC/INVOKESPECIAL and GETSTATIC/PUTSTATIC. The first execution of such an instruction
+// resolves its operands and records the result here, indexed on the address of the instruction. Later executions find
+// the resolved method or static field address directly.
+typedef struct _dj_exec_quickEntry
+{
+	dj_di_pointer site;
+	dj_global_id target;			// the resolved method, or the infusion holding the static field
+	union
+	{
+		dj_di_pointer methodImpl;
+		void * field;
+	} resolved;
+	bool isStaticField;
+} dj_exec_quickEntry;
+
+static DJ_VM_LOCAL dj_exec_quickEntry quickTable[EXECUTION_QUICKENING_SIZE];
 #endif
 //if it is tossim we need a bunch of getter setters,
 //because tossim considers global variables in all nodes to be shared
@@ -134,6 +186,17 @@ inline void dj_exec_breakExecution() {
 	nrOpcodesLeft = -1;
 }
 
+/**
+ * Charges the current time slice for a backward branch or a method call or return. In threaded dispatch mode
+ * these are the only points where the slice is consumed. The switch interpreter counts every instruction in
+ * the run loop instead, so this is a no-op there.
+ */
+static inline void dj_exec_chargeQuantum() {
+#ifdef EXECUTION_THREADED_DISPATCH
+	nrOpcodesLeft--;
+#endif
+}
+
 /**
  * Saves execution state (stack pointer, pc) in the given frame struct. This method
  * is used in context switching and method invocations/returns.
@@ -142,7 +205,7 @@ inline void dj_exec_breakExecution() {
 static inline void dj_exec_saveLocalState(dj_frame *frame) {
 	frame->pc = pc;
 	frame->nr_int_stack = ((char*) intStack - dj_frame_stackStartOffset(frame))
-			/ sizeof(int16_t);
+			/ sizeof(dj_int_slot);
 	frame->nr_ref_stack = (dj_frame_stackEndOffset(frame) - (char*) refStack)
 			/ sizeof(ref_t);
 }
@@ -154,8 +217,7 @@ static inline void dj_exec_saveLocalState(dj_frame *frame) {
  */
 static inline void dj_exec_loadLocalState(dj_frame *frame) {
 	// get program counter, stack pointers, code
-	dj_di_pointer methodImpl = dj_global_id_getMethodImplementation(
-			frame->method);
+	dj_di_pointer methodImpl = dj_frame_getMethodImplementation(frame);
 	code = dj_di_methodImplementation_getData(methodImpl);
 	pc = frame->pc;
 
@@ -204,7 +266,7 @@ static dj_frame *getCurrentFrame() {
 
 
 #ifdef DARJEELING_DEBUG_FRAME
-static void dj_exec_debugInt16( const char *desc, int16_t *data, uint8_t num, int increment ) {
+static void dj_exec_debugInt16( const char *desc, dj_int_slot *data, uint8_t num, int increment ) {
 	int idx;
 
 	DARJEELING_PRINTF("%s: %p, %d values", desc, data, num);
@@ -241,7 +303,7 @@ static void dj_exec_debugRef( const char *desc, ref_t *data, uint8_t num ) {
 void dj_exec_dumpFrame( dj_frame *frame ) {
 	char name[16];
 	int numLocalInts, numLocalRefs, numIntParams, numRefParams;
-	int16_t *intParams;
+	dj_int_slot *intParams;
 	ref_t *refParams;
 
 	DARJEELING_PRINTF("Frame = %p.\n", frame);
@@ -251,20 +313,20 @@ void dj_exec_dumpFrame( dj_frame *frame ) {
 		dj_infusion_getName(frame->method.infusion, name, 16);
 		DARJEELING_PRINTF(" Method.infusion=%s, Method.id=%d\n", name, frame->method.entity_id);
 
-		dj_di_pointer methodImpl = dj_global_id_getMethodImplementation(frame->method);
+		dj_di_pointer methodImpl = dj_frame_getMethodImplementation(frame);
 
 		// calculate the size of the frame to create
 		numLocalInts = dj_di_methodImplementation_getIntegerLocalVariableCount(methodImpl);
 		numLocalRefs = dj_di_methodImplementation_getReferenceLocalVariableCount(methodImpl);
-		int localVariablesSize = (numLocalRefs * sizeof(ref_t)) + (numLocalInts * sizeof(int16_t));
+		int localVariablesSize = (numLocalRefs * sizeof(ref_t)) + (numLocalInts * sizeof(dj_int_slot));
 
 		int size =
 			sizeof(dj_frame) +
-			(dj_di_methodImplementation_getMaxStack(methodImpl) * sizeof(int16_t)) +
+			(dj_di_methodImplementation_getMaxStack(methodImpl) * DJ_FRAME_STACK_SLOT_SIZE) +
 			localVariablesSize;
 		DARJEELING_PRINTF(" Size of struct: %d, max.stack: %d, local var's: %d bytes.\n",
 				sizeof(dj_frame),
-				(dj_di_methodImplementation_getMaxStack(methodImpl) * sizeof(int16_t)),
+				(dj_di_methodImplementation_getMaxStack(methodImpl) * DJ_FRAME_STACK_SLOT_SIZE),
 				localVariablesSize );
 		DARJEELING_PRINTF(" Frame total size is %d bytes, so frame ends at %p.\n", size, ( ((void *)frame)+size) );
 
@@ -310,7 +372,7 @@ void dj_exec_dumpFrameTrace( dj_frame *frame ) {
 }
 
 dj_frame *dj_exec_dumpExecutionState() {
-	int16_t *orgIntStack;
+	dj_int_slot *orgIntStack;
 	ref_t *orgRefStack;
 	dj_frame *frame = getCurrentFrame();
 
@@ -406,8 +468,134 @@ void dj_exec_activate_thread(dj_thread *thread) {
 void dj_exec_updatePointers() {
 	vm = dj_mem_getUpdatedPointer(vm);
 	this = dj_mem_getUpdatedReference(this);
+
+#if defined(EXECUTION_INLINE_CACHE) || defined(EXECUTION_QUICKENING)
+	int i;
+#endif
+#ifdef EXECUTION_INLINE_CACHE
+	int j;
+#endif
+
+#ifdef EXECUTION_INLINE_CACHE
+	// infusions are heap objects, so the cached method implementation ids have to follow them
+	for (i=0; i<EXECUTION_INLINE_CACHE_SIZE; i++)
+		if (invokeCache[i].site!=0)
+			for (j=0; j<invokeCache[i].nrWays; j++)
+				invokeCache[i].ways[j].methodImplId.infusion = dj_mem_getUpdatedPointer(invokeCache[i].ways[j].methodImplId.infusion);
+#endif
+
+#ifdef EXECUTION_QUICKENING
+	// static fields live inside the infusion chunk, and move along with it
+	for (i=0; i<EXECUTION_QUICKENING_SIZE; i++)
+		if (quickTable[i].site!=0)
+		{
+			if (quickTable[i].isStaticField)
+				quickTable[i].resolved.field = (char*)quickTable[i].resolved.field - dj_mem_getChunkShift(quickTable[i].target.infusion);
+			quickTable[i].target.infusion = dj_mem_getUpdatedPointer(quickTable[i].target.infusion);
+		}
+#endif
+}
+
+/**
+ * Invalidates the inline caches of all virtual call sites and the quickening table. This must be called whenever the
+ * runtime class ids are shifted or an infusion is removed, since entries are keyed on runtime class ids and code
+ * addresses, and may point into the removed infusion.
+ */
+void dj_exec_flushCaches() {
+#if defined(EXECUTION_INLINE_CACHE) || defined(EXECUTION_QUICKENING)
+	int i;
+#endif
+
+#ifdef EXECUTION_INLINE_CACHE
+	for (i=0; i<EXECUTION_INLINE_CACHE_SIZE; i++)
+		invokeCache[i].site = 0;
+#endif
+
+#ifdef EXECUTION_QUICKENING
+	for (i=0; i<EXECUTION_QUICKENING_SIZE; i++)
+		quickTable[i].site = 0;
+#endif
 }
 
+/**
+ * Hashes the address of an instruction into a slot of one of the direct-mapped side tables.
+ * @param site address in program memory of the instruction's operands
+ * @param size number of slots in the table
+ */
+static inline uint16_t dj_exec_hashSite(dj_di_pointer site, uint16_t size) {
+	return (uint16_t)(site ^ (site >> 5)) % size;
+}
+
+#ifdef EXECUTION_INLINE_CACHE
+/**
+ * Returns the inline cache slot for a call site.
+ * @param site address in program memory of the call site's operands
+ */
+static inline dj_exec_invokeCacheEntry * dj_exec_getInvokeCacheEntry(dj_di_pointer site) {
+	return &invokeCache[dj_exec_hashSite(site, EXECUTION_INLINE_CACHE_SIZE)];
+}
+
+/**
+ * Looks up the receiver class in a call site's inline cache slot.
+ * @param cacheEntry the call site's slot, as returned by dj_exec_getInvokeCacheEntry
+ * @param site address in program memory of the call site's operands
+ * @param classId runtime class id of the receiver
+ * @return the cached way, or NULL on a miss
+ */
+static inline dj_exec_invokeCacheWay * dj_exec_findInvokeCacheWay(dj_exec_invokeCacheEntry *cacheEntry, dj_di_pointer site, runtime_id_t classId) {
+	uint8_t i;
+
+	if (cacheEntry->site!=site)
+		return NULL;
+
+	for (i=0; i<cacheEntry->nrWays; i++)
+		if (cacheEntry->ways[i].classId==classId)
+			return &cacheEntry->ways[i];
+
+	return NULL;
+}
+
+/**
+ * Records a resolved receiver class in a call site's inline cache slot. A slot that held another call site is taken
+ * over, otherwise empty ways are filled first and the oldest way is replaced once the slot is full.
+ * @param cacheEntry the call site's slot, as returned by dj_exec_getInvokeCacheEntry
+ * @param site address in program memory of the call site's operands
+ * @param classId runtime class id of the receiver
+ * @return the way to fill in
+ */
+static inline dj_exec_invokeCacheWay * dj_exec_addInvokeCacheWay(dj_exec_invokeCacheEntry *cacheEntry, dj_di_pointer site, runtime_id_t classId) {
+	dj_exec_invokeCacheWay *way;
+
+	if (cacheEntry->site!=site)
+	{
+		cacheEntry->site = site;
+		cacheEntry->nrWays = 0;
+		cacheEntry->nextWay = 0;
+	}
+
+	if (cacheEntry->nrWays<EXECUTION_INLINE_CACHE_WAYS)
+		way = &cacheEntry->ways[cacheEntry->nrWays++];
+	else
+	{
+		way = &cacheEntry->ways[cacheEntry->nextWay];
+		cacheEntry->nextWay = (cacheEntry->nextWay + 1) % EXECUTION_INLINE_CACHE_WAYS;
+	}
+
+	way->classId = classId;
+	return way;
+}
+#endif
+
+#ifdef EXECUTION_QUICKENING
+/**
+ * Returns the quickening table slot for an instruction.
+ * @param site address in program memory of the instruction's operands
+ */
+static inline dj_exec_quickEntry * dj_exec_getQuickEntry(dj_di_pointer site) {
+	return &quickTable[dj_exec_hashSite(site, EXECUTION_QUICKENING_SIZE)];
+}
+#endif
+
 /**
  * Returns the current infusion which is the infusion containing the method that's currently executing. This infusion
  * serves as a context for instructions, as any local ID's contained in them are relative to it.
@@ -526,7 +714,7 @@ static inline void pushShort(int16_t value) {
  */
 static inline void pushInt(int32_t value) {
 	*((int32_t*) intStack) = value;
-	intStack += 2;
+	intStack += DJ_INT_SLOTS;
 }
 
 /**
@@ -534,7 +722,7 @@ static inline void pushInt(int32_t value) {
  */
 static inline void pushLong(int64_t value) {
 	*((int64_t*) intStack) = value;
-	intStack += 4;
+	intStack += DJ_LONG_SLOTS;
 }
 
 /**
@@ -558,7 +746,7 @@ static inline int16_t popShort()
  * Pops an int (32 bit) from the runtime stack
  */
 static inline int32_t popInt() {
-	intStack -= 2;
+	intStack -= DJ_INT_SLOTS;
 	return *(int32_t*) intStack;
 }
 
@@ -566,7 +754,7 @@ static inline int32_t popInt() {
  * Pops a long (64 bit) from the runtime stack
  */
 static inline int64_t popLong() {
-	intStack -= 4;
+	intStack -= DJ_LONG_SLOTS;
 	return *(int64_t*) intStack;
 }
 
@@ -590,16 +778,36 @@ static inline int16_t peekShort() {
  * Returns the topmost 32 bit integer element on the integer stack, does not change the stackpointer.
  */
 static inline int32_t peekInt() {
-	return *(int32_t*) (intStack - 2);
+	return *(int32_t*) (intStack - DJ_INT_SLOTS);
 }
 
 /**
  * Returns the topmost 64 bit long element on the integer stack, does not change the stackpointer.
  */
-// 20140410 NR: Comment unused function
-//static inline int64_t peekLong() {
-//	return *(int64_t*) (intStack - 4);
-//}
+static inline int64_t peekLong() {
+	return *(int64_t*) (intStack - DJ_LONG_SLOTS);
+}
+
+/**
+ * Replaces the topmost 16 bit short element on the integer stack, does not change the stackpointer.
+ */
+static inline void pokeShort(int16_t value) {
+	*(intStack - 1) = value;
+}
+
+/**
+ * Replaces the topmost 32 bit integer element on the integer stack, does not change the stackpointer.
+ */
+static inline void pokeInt(int32_t value) {
+	*(int32_t*) (intStack - DJ_INT_SLOTS) = value;
+}
+
+/**
+ * Replaces the topmost 64 bit long element on the integer stack, does not change the stackpointer.
+ */
+static inline void pokeLong(int64_t value) {
+	*(int64_t*) (intStack - DJ_LONG_SLOTS) = value;
+}
 
 
 /**
@@ -828,6 +1036,8 @@ static inline ref_t getLocalRef(int index) {
  */
 static inline void branch(int16_t offset) {
 	pc += offset;
+	if (offset < 0)
+		dj_exec_chargeQuantum();
 }
 
 /**
@@ -837,11 +1047,12 @@ static inline void branch(int16_t offset) {
  * If the method is not native, a new frame is created and a context switch is
  * performed.
  * @param methodImplId a global id pointing to the method to be executed
+ * @param methodImpl pointer in program space to the method implementation block
  * @param virtualCall indicates if the call is a virtual or static call. In the
  * case of a virtual call the object the method belongs to is on the stack and
  * should be handled as an additional parameter. Should be either 1 or 0.
  */
-static inline void callMethod(dj_global_id methodImplId, int virtualCall)
+static inline void callResolvedMethod(dj_global_id methodImplId, dj_di_pointer methodImpl, int virtualCall)
 {
 	dj_frame *frame;
 	dj_native_handler handler;
@@ -849,10 +1060,17 @@ static inline void callMethod(dj_global_id methodImplId, int virtualCall)
 	int oldNumRefStack, numRefStack;
 	int diffRefArgs;
 
-	// get a pointer in program space to the method implementation block
-	// from the method's global id
-	dj_di_pointer methodImpl;
-	methodImpl = dj_global_id_getMethodImplementation(methodImplId);
+#ifdef EXECUTION_AOT
+	// the infuser compiled this method to C, run it through the infusion's native handler. Unlike native methods,
+	// compiled methods pop all their parameters including the object reference, so there's no stack fixup to do.
+	if (dj_exec_use_rtc && (dj_di_methodImplementation_getFlags(methodImpl) & FLAGS_COMPILED) != 0
+			&& methodImplId.infusion->native_handler != NULL)
+	{
+		methodImplId.infusion->native_handler(methodImplId);
+		dj_exec_chargeQuantum();
+		return;
+	}
+#endif
 
 	// check if the method is a native methods
 	if ((dj_di_methodImplementation_getFlags(methodImpl) & FLAGS_NATIVE) != 0)
@@ -938,7 +1156,7 @@ static inline void callMethod(dj_global_id methodImplId, int virtualCall)
 	} else {
 
 		// create new frame for the function
-		frame = dj_frame_create(methodImplId);
+		frame = dj_thread_createFrame(dj_exec_getCurrentThread(), methodImplId);
 
 		// not enough space on the heap to allocate the frame
 		if (frame == NULL) {
@@ -955,6 +1173,8 @@ static inline void callMethod(dj_global_id methodImplId, int virtualCall)
 		// switch in newly created frame
 		dj_exec_loadLocalState(frame);
 
+		dj_exec_chargeQuantum();
+
 #ifdef DARJEELING_DEBUG_MEM_TRACE
 		vm_mem_dumpMemUsage();
 #endif
@@ -970,6 +1190,18 @@ static inline void callMethod(dj_global_id methodImplId, int virtualCall)
 
 }
 
+/**
+ * Enters a method, see callResolvedMethod.
+ * @param methodImplId a global id pointing to the method to be executed
+ * @param virtualCall 1 for a virtual call, 0 for a static call
+ */
+static inline void callMethod(dj_global_id methodImplId, int virtualCall)
+{
+	// get a pointer in program space to the method implementation block
+	// from the method's global id
+	callResolvedMethod(methodImplId, dj_global_id_getMethodImplementation(methodImplId), virtualCall);
+}
+
 /**
  * Returns from a method. The current execution frame is popped off the thread's frame stack. If there are no other
  * frames to execute, the thread ends. Otherwise control is switched to the underlying caller frame.
@@ -978,12 +1210,13 @@ static inline void returnFromMethod() {
 	dj_di_pointer methodImpl;
 
 	// get the method from the stack frame so we can calculate how many parameters to pop off the operand stack
-	methodImpl = dj_global_id_getMethodImplementation(
-			dj_exec_getCurrentThread()->frameStack->method);
+	methodImpl = dj_frame_getMethodImplementation(dj_exec_getCurrentThread()->frameStack);
 
 	// pop frame from frame stack and dealloc it
 	dj_frame_destroy(dj_thread_popFrame(dj_exec_getCurrentThread()));
 
+	dj_exec_chargeQuantum();
+
 	// check if there are elements on the call stack
 	if (dj_exec_getCurrentThread()->frameStack == NULL) {
 		// done executing (exited last element on the call stack)
@@ -1034,6 +1267,32 @@ void dj_exec_createAndThrow(int exceptionId)
 	dj_exec_throwHere(obj);
 }
 
+#ifdef EXECUTION_AOT
+/**
+ * Throws one of the runtime exceptions C code generated for a compiled method can raise. The exception is thrown at
+ * the current PC, which is the invoke instruction that called the compiled method.
+ * @param exception one of the COMPILED_ exception codes
+ */
+void dj_exec_throwCompiled(uint8_t exception)
+{
+	switch (exception)
+	{
+		case COMPILED_NULL_POINTER:
+			dj_exec_createAndThrow(BASE_CDEF_java_lang_NullPointerException);
+			break;
+		case COMPILED_CLASS_UNLOADED:
+			dj_exec_createAndThrow(BASE_CDEF_javax_darjeeling_vm_ClassUnloadedException);
+			break;
+		case COMPILED_INDEX_OUT_OF_BOUNDS:
+			dj_exec_createAndThrow(BASE_CDEF_java_lang_IndexOutOfBoundsException);
+			break;
+		default:
+			dj_exec_createAndThrow(BASE_CDEF_java_lang_ArithmeticException);
+			break;
+	}
+}
+#endif
+
 /**
  * Throws an exception at the current PC. Ideally this function should be called only from outside the execution module.
  * @see dj_exe_throw()
@@ -1075,8 +1334,7 @@ void dj_exec_throw(dj_object *obj, uint16_t throw_pc)
 	throw_pc = pc;
 	while (!caught && dj_exec_getCurrentThread()->frameStack != NULL)
 	{
-		method = dj_global_id_getMethodImplementation(
-				dj_exec_getCurrentThread()->frameStack->method);
+		method = dj_frame_getMethodImplementation(dj_exec_getCurrentThread()->frameStack);
 
 		// loop through the exception handlers to try and find an appropriate one
 		uint8_t nr_handlers =
@@ -1093,6 +1351,15 @@ void dj_exec_throw(dj_object *obj, uint16_t throw_pc)
 			} else {
 				catch_type = dj_global_id_resolve(dj_exec_getCurrentInfusion(),
 						catch_type_local_id);
+#ifdef VM_TYPE_DISPLAYS
+				// the runtime class of the exception is known, so test it against the type table directly
+				if (vm->typeTable!=NULL
+						&& dj_type_table_contains(vm->typeTable, classRuntimeId)
+						&& dj_type_table_contains(vm->typeTable, dj_global_id_getRuntimeClassId(catch_type)))
+					type_applies = dj_type_table_testClassType(vm->typeTable, classRuntimeId,
+							dj_global_id_getRuntimeClassId(catch_type));
+				else
+#endif
 				type_applies = dj_global_id_testClassType(classGlobalId,
 						catch_type);
 			}
@@ -1107,7 +1374,7 @@ void dj_exec_throw(dj_object *obj, uint16_t throw_pc)
 
 				// TODO is this correct?
 				// pop all operands from the integer and reference stacks
-				intStack = (int16_t*) dj_frame_stackStartOffset(dj_exec_getCurrentThread()->frameStack);
+				intStack = (dj_int_slot*) dj_frame_stackStartOffset(dj_exec_getCurrentThread()->frameStack);
 				refStack = (ref_t*) dj_frame_stackEndOffset(dj_exec_getCurrentThread()->frameStack);
 
 				pushRef(VOIDP_TO_REF(obj));
@@ -1147,20 +1414,73 @@ void dj_exec_throw(dj_object *obj, uint16_t throw_pc)
 #include "invoke_instructions.h"
 #include "misc_instructions.h"
 
+// The operand that an arithmetic instruction replaces with its result. With EXECUTION_TOS_INPLACE it is read and
+// overwritten on top of the stack, so a binary operator moves the stack pointer once instead of three times and a
+// unary operator not at all. Otherwise it is popped and the result pushed.
+#ifdef EXECUTION_TOS_INPLACE
+#define popShortOperand() peekShort()
+#define popIntOperand() peekInt()
+#define popLongOperand() peekLong()
+#define pushShortResult(value) pokeShort(value)
+#define pushIntResult(value) pokeInt(value)
+#define pushLongResult(value) pokeLong(value)
+#else
+#define popShortOperand() popShort()
+#define popIntOperand() popInt()
+#define popLongOperand() popLong()
+#define pushShortResult(value) pushShort(value)
+#define pushIntResult(value) pushInt(value)
+#define pushLongResult(value) pushLong(value)
+#endif
+
 #define SHORT_ARITHMETIC_OP(op) do { temp2 = popShort(); \
-        temp1 = popShort();                        \
-        pushShort((int16_t)(temp1 op temp2)); } while(0)
+        temp1 = popShortOperand();                 \
+        pushShortResult((int16_t)(temp1 op temp2)); } while(0)
 
 #define INT_ARITHMETIC_OP(op) do { temp2 = popInt(); \
-        temp1 = popInt();                        \
-        pushInt(temp1 op temp2); } while(0)
+        temp1 = popIntOperand();                 \
+        pushIntResult(temp1 op temp2); } while(0)
 
 #define LONG_ARITHMETIC_OP(op) do { ltemp2 = popLong(); \
-        ltemp1 = popLong();                        \
-        pushLong((int64_t)(ltemp1 op ltemp2)); } while(0)
+        ltemp1 = popLongOperand();                 \
+        pushLongResult((int64_t)(ltemp1 op ltemp2)); } while(0)
+
+#ifdef OPCODE_PROFILER
+#define PROFILE_OPCODE(opcode) dj_opprof_record(opcode)
+#else
+#define PROFILE_OPCODE(opcode) do { } while(0)
+#endif
+
+// Opcode handlers are written once and expanded either into the cases of a switch statement, or into labels
+// of a computed-goto dispatch table. In threaded mode every handler fetches and jumps to the next opcode
+// itself, and the quantum and runlevel are only checked after instructions that may branch backwards, call,
+// return, block or throw (NEXT_CHECKED). Straight-line code between those points always terminates.
+#ifdef EXECUTION_THREADED_DISPATCH
+
+#ifdef DARJEELING_DEBUG
+#define DISPATCH_COUNT() do { totalNrOpcodes++; oldPc = pc; } while(0)
+#else
+#define DISPATCH_COUNT() do { } while(0)
+#endif
+
+#define CASE(op) op_##op:
+#define DEFAULT op_default:
+#define NEXT() { opcode = fetch(); DISPATCH_COUNT(); PROFILE_OPCODE(opcode); goto *dispatchTable[opcode]; }
+#define NEXT_CHECKED() { if (nrOpcodesLeft <= 0 || dj_exec_runlevel != RUNLEVEL_RUNNING) goto dispatchDone; NEXT(); }
+
+#else
+
+#define CASE(op) case op:
+#define DEFAULT default:
+#define NEXT() break
+#define NEXT_CHECKED() break
+
+#endif
 
 /**
  * The execution engine's main run function. Executes [nrOpcodes] instructions, or until execution is stopped explicitly.
+ * When EXECUTION_THREADED_DISPATCH is defined, [nrOpcodes] counts backward branches and method calls/returns
+ * instead of individual instructions.
  * @param nrOpcodes the amount of opcodes to execute in one 'run'.
  */
 int dj_exec_run(int nrOpcodes)
@@ -1173,12 +1493,30 @@ int dj_exec_run(int nrOpcodes)
 	uint8_t opcode, m, n;
 	int i;
 	nrOpcodesLeft = nrOpcodes;
-	int32_t temp1, temp2, temp3;
+	int32_t temp1, temp2;
 	int64_t ltemp1, ltemp2;
 	ref_t rtemp1, rtemp2, rtemp3;
 
 	dj_hook_call(dj_core_pollingHook, NULL);
 
+#ifdef OPCODE_PROFILER
+	// the previous time slice may have run another thread
+	dj_opprof_break();
+#endif
+
+#ifdef EXECUTION_THREADED_DISPATCH
+	static const void * const dispatchTable[256] = {
+		[0 ... 255] = &&op_default,
+#include "threaded_dispatch.h"
+	};
+
+	if (nrOpcodesLeft <= 0 || dj_exec_runlevel != RUNLEVEL_RUNNING)
+		return nrOpcodesLeft;
+
+	NEXT();
+
+	{
+#else
 	while (nrOpcodesLeft > 0 && dj_exec_runlevel == RUNLEVEL_RUNNING) {
 		nrOpcodesLeft--;
 		opcode = fetch();
@@ -1187,219 +1525,221 @@ int dj_exec_run(int nrOpcodes)
 		totalNrOpcodes++;
 		oldPc = pc;
 #endif
+		PROFILE_OPCODE(opcode);
 
 		switch (opcode) {
+#endif
 
 		// arithmetic
-		case JVM_SADD: SHORT_ARITHMETIC_OP(+); break;
-		case JVM_SSUB: SHORT_ARITHMETIC_OP(-); break;
-		case JVM_SMUL: SHORT_ARITHMETIC_OP(*); break;
-		case JVM_SDIV:
+		CASE(JVM_SADD) SHORT_ARITHMETIC_OP(+); NEXT();
+		CASE(JVM_SSUB) SHORT_ARITHMETIC_OP(-); NEXT();
+		CASE(JVM_SMUL) SHORT_ARITHMETIC_OP(*); NEXT();
+		CASE(JVM_SDIV)
 			temp2 = popShort();
-			temp1 = popShort();
+			temp1 = popShortOperand();
 			if (temp2 == 0)
 				dj_exec_createAndThrow(BASE_CDEF_java_lang_ArithmeticException);
 			else
-				pushShort(temp1 / temp2);
-			break;
-		case JVM_SNEG: pushShort(-popShort()); break;
-		case JVM_SSHR: SHORT_ARITHMETIC_OP(>>); break;
-		case JVM_SUSHR:
+				pushShortResult(temp1 / temp2);
+			NEXT();
+		CASE(JVM_SNEG) pushShortResult(-popShortOperand()); NEXT();
+		CASE(JVM_SSHR) SHORT_ARITHMETIC_OP(>>); NEXT();
+		CASE(JVM_SUSHR)
 			temp2 = popShort() & 15;
-			temp1 = popShort();
-			pushShort(((uint16_t) temp1) >> temp2);
-			break;
-		case JVM_SSHL: SHORT_ARITHMETIC_OP(<<); break;
-		case JVM_SREM: SHORT_ARITHMETIC_OP(%); break;
-		case JVM_SAND: SHORT_ARITHMETIC_OP(&); break;
-		case JVM_SOR: SHORT_ARITHMETIC_OP(|); break;
-		case JVM_SXOR: SHORT_ARITHMETIC_OP(^); break;
-
-		case JVM_IADD: INT_ARITHMETIC_OP(+); break;
-		case JVM_ISUB: INT_ARITHMETIC_OP(-); break;
-		case JVM_IMUL: INT_ARITHMETIC_OP(*); break;
-		case JVM_IDIV:
+			temp1 = popShortOperand();
+			pushShortResult(((uint16_t) temp1) >> temp2);
+			NEXT();
+		CASE(JVM_SSHL) SHORT_ARITHMETIC_OP(<<); NEXT();
+		CASE(JVM_SREM) SHORT_ARITHMETIC_OP(%); NEXT();
+		CASE(JVM_SAND) SHORT_ARITHMETIC_OP(&); NEXT();
+		CASE(JVM_SOR) SHORT_ARITHMETIC_OP(|); NEXT();
+		CASE(JVM_SXOR) SHORT_ARITHMETIC_OP(^); NEXT();
+
+		CASE(JVM_IADD) INT_ARITHMETIC_OP(+); NEXT();
+		CASE(JVM_ISUB) INT_ARITHMETIC_OP(-); NEXT();
+		CASE(JVM_IMUL) INT_ARITHMETIC_OP(*); NEXT();
+		CASE(JVM_IDIV)
 			temp2 = popInt();
-			temp1 = popInt();
+			temp1 = popIntOperand();
 			if (temp2 == 0)
 				dj_exec_createAndThrow(BASE_CDEF_java_lang_ArithmeticException);
 			else
-				pushInt(temp1 / temp2);
-			break;
+				pushIntResult(temp1 / temp2);
+			NEXT();
 
-		case JVM_INEG: pushInt(-popInt()); break;
-		case JVM_ISHR: INT_ARITHMETIC_OP(>>); break;
-		case JVM_IUSHR:
+		CASE(JVM_INEG) pushIntResult(-popIntOperand()); NEXT();
+		CASE(JVM_ISHR) INT_ARITHMETIC_OP(>>); NEXT();
+		CASE(JVM_IUSHR)
 			temp2 = popShort() & 31;
-			temp1 = popInt();
-			pushInt(((uint32_t) temp1) >> temp2);
-			break;
-		case JVM_ISHL: INT_ARITHMETIC_OP(<<); break;
-		case JVM_IREM: INT_ARITHMETIC_OP(%); break;
-		case JVM_IAND: INT_ARITHMETIC_OP(&); break;
-		case JVM_IOR: INT_ARITHMETIC_OP(|); break;
-		case JVM_IXOR: INT_ARITHMETIC_OP(^); break;
-
-		case JVM_LADD: LONG_ARITHMETIC_OP(+); break;
-		case JVM_LSUB: LONG_ARITHMETIC_OP(-); break;
-		case JVM_LMUL: LONG_ARITHMETIC_OP(*); break;
-		case JVM_LDIV:
+			temp1 = popIntOperand();
+			pushIntResult(((uint32_t) temp1) >> temp2);
+			NEXT();
+		CASE(JVM_ISHL) INT_ARITHMETIC_OP(<<); NEXT();
+		CASE(JVM_IREM) INT_ARITHMETIC_OP(%); NEXT();
+		CASE(JVM_IAND) INT_ARITHMETIC_OP(&); NEXT();
+		CASE(JVM_IOR) INT_ARITHMETIC_OP(|); NEXT();
+		CASE(JVM_IXOR) INT_ARITHMETIC_OP(^); NEXT();
+
+		CASE(JVM_LADD) LONG_ARITHMETIC_OP(+); NEXT();
+		CASE(JVM_LSUB) LONG_ARITHMETIC_OP(-); NEXT();
+		CASE(JVM_LMUL) LONG_ARITHMETIC_OP(*); NEXT();
+		CASE(JVM_LDIV)
 			temp2 = popLong();
-			temp1 = popLong();
+			temp1 = popLongOperand();
 			if (temp2 == 0)
 				dj_exec_createAndThrow(BASE_CDEF_java_lang_ArithmeticException);
 			else
-				pushLong(temp1 / temp2);
-			break;
-		case JVM_LNEG: pushLong(-popLong()); break;
-		case JVM_LSHR: LONG_ARITHMETIC_OP(>>); break;
-		case JVM_LUSHR:
+				pushLongResult(temp1 / temp2);
+			NEXT();
+		CASE(JVM_LNEG) pushLongResult(-popLongOperand()); NEXT();
+		CASE(JVM_LSHR) LONG_ARITHMETIC_OP(>>); NEXT();
+		CASE(JVM_LUSHR)
 			ltemp2 = popShort() & 63;
-			ltemp1 = popLong();
-			pushLong(((uint64_t) ltemp1) >> ltemp2);
-			break;
-		case JVM_LSHL: LONG_ARITHMETIC_OP(<<); break;
-		case JVM_LREM: LONG_ARITHMETIC_OP(%); break;
-		case JVM_LAND: LONG_ARITHMETIC_OP(&); break;
-		case JVM_LOR: LONG_ARITHMETIC_OP(|); break;
-		case JVM_LXOR: LONG_ARITHMETIC_OP(^); break;
-
-		// TODO use peekInt/pokeInt
-		case JVM_S2B: pushShort((int8_t) popShort()); break;
-		case JVM_S2C: pushShort((int8_t) popShort()); break;
-		case JVM_S2I: pushInt((int32_t) popShort()); break;
-		case JVM_S2L: pushLong((int64_t) popShort()); break;
-
-		case JVM_I2B: pushShort((int8_t) popInt()); break;
-		case JVM_I2C: pushShort((int8_t) popInt()); break;
-		case JVM_I2S: pushShort((int16_t) popInt()); break;
-		case JVM_I2L: pushLong((int64_t) popInt()); break;
-
-		case JVM_L2I: pushInt((int32_t) popLong()); break;
-		case JVM_L2S: pushShort((int16_t) popLong()); break;
-
-		case JVM_B2C:
+			ltemp1 = popLongOperand();
+			pushLongResult(((uint64_t) ltemp1) >> ltemp2);
+			NEXT();
+		CASE(JVM_LSHL) LONG_ARITHMETIC_OP(<<); NEXT();
+		CASE(JVM_LREM) LONG_ARITHMETIC_OP(%); NEXT();
+		CASE(JVM_LAND) LONG_ARITHMETIC_OP(&); NEXT();
+		CASE(JVM_LOR) LONG_ARITHMETIC_OP(|); NEXT();
+		CASE(JVM_LXOR) LONG_ARITHMETIC_OP(^); NEXT();
+
+		// TODO use peekInt/pokeInt for the conversions that change the operand size
+		CASE(JVM_S2B) pushShortResult((int8_t) popShortOperand()); NEXT();
+		CASE(JVM_S2C) pushShortResult((int8_t) popShortOperand()); NEXT();
+		CASE(JVM_S2I) pushInt((int32_t) popShort()); NEXT();
+		CASE(JVM_S2L) pushLong((int64_t) popShort()); NEXT();
+
+		CASE(JVM_I2B) pushShort((int8_t) popInt()); NEXT();
+		CASE(JVM_I2C) pushShort((int8_t) popInt()); NEXT();
+		CASE(JVM_I2S) pushShort((int16_t) popInt()); NEXT();
+		CASE(JVM_I2L) pushLong((int64_t) popInt()); NEXT();
+
+		CASE(JVM_L2I) pushInt((int32_t) popLong()); NEXT();
+		CASE(JVM_L2S) pushShort((int16_t) popLong()); NEXT();
+
+		CASE(JVM_B2C)
 			// TODO keep this opcode?
-			break;
+			NEXT();
 
-		case JVM_IINC:
+		CASE(JVM_IINC)
 			temp1 = fetch();
 			temp2 = (int8_t) fetch();
 			setLocalInt(temp1, getLocalInt(temp1) + temp2);
-			break;
+			NEXT();
 
-		case JVM_IINC_W:
+		CASE(JVM_IINC_W)
 			temp1 = fetch();
 			temp2 = (int16_t) fetch16();
 			setLocalInt(temp1, getLocalInt(temp1) + temp2);
-			break;
+			NEXT();
 
-		case JVM_SINC:
+		CASE(JVM_SINC)
 			temp1 = fetch();
 			temp2 = (int8_t) fetch();
 			setLocalShort(temp1, getLocalShort(temp1) + temp2);
-			break;
+			NEXT();
 
-		case JVM_SINC_W:
+		CASE(JVM_SINC_W)
 			temp1 = fetch();
 			temp2 = (int16_t) fetch16();
 			setLocalShort(temp1, getLocalShort(temp1) + temp2);
-			break;
+			NEXT();
 
 		// stack and local variables
-		case JVM_SCONST_M1: pushShort(-1); break;
-		case JVM_SCONST_0: pushShort(0); break;
-		case JVM_SCONST_1: pushShort(1); break;
-		case JVM_SCONST_2: pushShort(2); break;
-		case JVM_SCONST_3: pushShort(3); break;
-		case JVM_SCONST_4: pushShort(4); break;
-		case JVM_SCONST_5: pushShort(5); break;
-
-		case JVM_ICONST_M1: pushInt(-1); break;
-		case JVM_ICONST_0: pushInt(0); break;
-		case JVM_ICONST_1: pushInt(1); break;
-		case JVM_ICONST_2: pushInt(2); break;
-		case JVM_ICONST_3: pushInt(3); break;
-		case JVM_ICONST_4: pushInt(4); break;
-		case JVM_ICONST_5: pushInt(5); break;
-
-		case JVM_LCONST_0: pushLong(0); break;
-		case JVM_LCONST_1: pushLong(1); break;
-
-		case JVM_BIPUSH: pushInt((int8_t) fetch()); break;
-		case JVM_BSPUSH: pushShort((int8_t) fetch()); break;
-		case JVM_SIPUSH: pushInt((int16_t) fetch16()); break;
-		case JVM_SSPUSH: pushShort((int16_t) fetch16()); break;
-		case JVM_IIPUSH: pushInt((int32_t) fetch32()); break;
-		case JVM_LLPUSH: pushLong((int64_t) fetch64()); break;
-
-		case JVM_LDS: LDS(); break;
-
-		case JVM_SLOAD: pushShort(getLocalShort(fetch())); break;
-		case JVM_SLOAD_0: pushShort(getLocalShort(0)); break;
-		case JVM_SLOAD_1: pushShort(getLocalShort(1)); break;
-		case JVM_SLOAD_2: pushShort(getLocalShort(2)); break;
-		case JVM_SLOAD_3: pushShort(getLocalShort(3)); break;
-
-		case JVM_ILOAD: pushInt(getLocalInt(fetch())); break;
-		case JVM_ILOAD_0: pushInt(getLocalInt(0)); break;
-		case JVM_ILOAD_1: pushInt(getLocalInt(1)); break;
-		case JVM_ILOAD_2: pushInt(getLocalInt(2)); break;
-		case JVM_ILOAD_3: pushInt(getLocalInt(3)); break;
-
-		case JVM_LLOAD: pushLong(getLocalLong(fetch())); break;
-		case JVM_LLOAD_0: pushLong(getLocalLong(0)); break;
-		case JVM_LLOAD_1: pushLong(getLocalLong(1)); break;
-		case JVM_LLOAD_2: pushLong(getLocalLong(2)); break;
-		case JVM_LLOAD_3: pushLong(getLocalLong(3)); break;
-
-		case JVM_ACONST_NULL: pushRef(nullref); break;
-		case JVM_ALOAD: pushRef(getLocalRef(fetch())); break;
-		case JVM_ALOAD_0: pushRef(getLocalRef(0)); break;
-		case JVM_ALOAD_1: pushRef(getLocalRef(1)); break;
-		case JVM_ALOAD_2: pushRef(getLocalRef(2)); break;
-		case JVM_ALOAD_3: pushRef(getLocalRef(3)); break;
-
-		case JVM_SSTORE: setLocalShort(fetch(), popShort()); break;
-		case JVM_SSTORE_0: setLocalShort(0, popShort()); break;
-		case JVM_SSTORE_1: setLocalShort(1, popShort()); break;
-		case JVM_SSTORE_2: setLocalShort(2, popShort()); break;
-		case JVM_SSTORE_3: setLocalShort(3, popShort()); break;
-
-		case JVM_ISTORE: setLocalInt(fetch(), popInt()); break;
-		case JVM_ISTORE_0: setLocalInt(0, popInt()); break;
-		case JVM_ISTORE_1: setLocalInt(1, popInt()); break;
-		case JVM_ISTORE_2: setLocalInt(2, popInt()); break;
-		case JVM_ISTORE_3: setLocalInt(3, popInt()); break;
-
-		case JVM_LSTORE: setLocalLong(fetch(), popLong()); break;
-		case JVM_LSTORE_0: setLocalLong(0, popLong()); break;
-		case JVM_LSTORE_1: setLocalLong(1, popLong()); break;
-		case JVM_LSTORE_2: setLocalLong(2, popLong()); break;
-		case JVM_LSTORE_3: setLocalLong(3, popLong()); break;
-
-		case JVM_ASTORE: setLocalRef(fetch(), popRef()); break;
-		case JVM_ASTORE_0: setLocalRef(0, popRef()); break;
-		case JVM_ASTORE_1: setLocalRef(1, popRef()); break;
-		case JVM_ASTORE_2: setLocalRef(2, popRef()); break;
-		case JVM_ASTORE_3: setLocalRef(3, popRef()); break;
+		CASE(JVM_SCONST_M1) pushShort(-1); NEXT();
+		CASE(JVM_SCONST_0) pushShort(0); NEXT();
+		CASE(JVM_SCONST_1) pushShort(1); NEXT();
+		CASE(JVM_SCONST_2) pushShort(2); NEXT();
+		CASE(JVM_SCONST_3) pushShort(3); NEXT();
+		CASE(JVM_SCONST_4) pushShort(4); NEXT();
+		CASE(JVM_SCONST_5) pushShort(5); NEXT();
+
+		CASE(JVM_ICONST_M1) pushInt(-1); NEXT();
+		CASE(JVM_ICONST_0) pushInt(0); NEXT();
+		CASE(JVM_ICONST_1) pushInt(1); NEXT();
+		CASE(JVM_ICONST_2) pushInt(2); NEXT();
+		CASE(JVM_ICONST_3) pushInt(3); NEXT();
+		CASE(JVM_ICONST_4) pushInt(4); NEXT();
+		CASE(JVM_ICONST_5) pushInt(5); NEXT();
+
+		CASE(JVM_LCONST_0) pushLong(0); NEXT();
+		CASE(JVM_LCONST_1) pushLong(1); NEXT();
+
+		CASE(JVM_BIPUSH) pushInt((int8_t) fetch()); NEXT();
+		CASE(JVM_BSPUSH) pushShort((int8_t) fetch()); NEXT();
+		CASE(JVM_SIPUSH) pushInt((int16_t) fetch16()); NEXT();
+		CASE(JVM_SSPUSH) pushShort((int16_t) fetch16()); NEXT();
+		CASE(JVM_IIPUSH) pushInt((int32_t) fetch32()); NEXT();
+		CASE(JVM_LLPUSH) pushLong((int64_t) fetch64()); NEXT();
+
+		CASE(JVM_LDS) LDS(); NEXT();
+
+		CASE(JVM_SLOAD) pushShort(getLocalShort(fetch())); NEXT();
+		CASE(JVM_SLOAD_0) pushShort(getLocalShort(0)); NEXT();
+		CASE(JVM_SLOAD_1) pushShort(getLocalShort(1)); NEXT();
+		CASE(JVM_SLOAD_2) pushShort(getLocalShort(2)); NEXT();
+		CASE(JVM_SLOAD_3) pushShort(getLocalShort(3)); NEXT();
+
+		CASE(JVM_ILOAD) pushInt(getLocalInt(fetch())); NEXT();
+		CASE(JVM_ILOAD_0) pushInt(getLocalInt(0)); NEXT();
+		CASE(JVM_ILOAD_1) pushInt(getLocalInt(1)); NEXT();
+		CASE(JVM_ILOAD_2) pushInt(getLocalInt(2)); NEXT();
+		CASE(JVM_ILOAD_3) pushInt(getLocalInt(3)); NEXT();
+
+		CASE(JVM_LLOAD) pushLong(getLocalLong(fetch())); NEXT();
+		CASE(JVM_LLOAD_0) pushLong(getLocalLong(0)); NEXT();
+		CASE(JVM_LLOAD_1) pushLong(getLocalLong(1)); NEXT();
+		CASE(JVM_LLOAD_2) pushLong(getLocalLong(2)); NEXT();
+		CASE(JVM_LLOAD_3) pushLong(getLocalLong(3)); NEXT();
+
+		CASE(JVM_ACONST_NULL) pushRef(nullref); NEXT();
+		CASE(JVM_ALOAD) pushRef(getLocalRef(fetch())); NEXT();
+		CASE(JVM_ALOAD_0) pushRef(getLocalRef(0)); NEXT();
+		CASE(JVM_ALOAD_1) pushRef(getLocalRef(1)); NEXT();
+		CASE(JVM_ALOAD_2) pushRef(getLocalRef(2)); NEXT();
+		CASE(JVM_ALOAD_3) pushRef(getLocalRef(3)); NEXT();
+
+		CASE(JVM_SSTORE) setLocalShort(fetch(), popShort()); NEXT();
+		CASE(JVM_SSTORE_0) setLocalShort(0, popShort()); NEXT();
+		CASE(JVM_SSTORE_1) setLocalShort(1, popShort()); NEXT();
+		CASE(JVM_SSTORE_2) setLocalShort(2, popShort()); NEXT();
+		CASE(JVM_SSTORE_3) setLocalShort(3, popShort()); NEXT();
+
+		CASE(JVM_ISTORE) setLocalInt(fetch(), popInt()); NEXT();
+		CASE(JVM_ISTORE_0) setLocalInt(0, popInt()); NEXT();
+		CASE(JVM_ISTORE_1) setLocalInt(1, popInt()); NEXT();
+		CASE(JVM_ISTORE_2) setLocalInt(2, popInt()); NEXT();
+		CASE(JVM_ISTORE_3) setLocalInt(3, popInt()); NEXT();
+
+		CASE(JVM_LSTORE) setLocalLong(fetch(), popLong()); NEXT();
+		CASE(JVM_LSTORE_0) setLocalLong(0, popLong()); NEXT();
+		CASE(JVM_LSTORE_1) setLocalLong(1, popLong()); NEXT();
+		CASE(JVM_LSTORE_2) setLocalLong(2, popLong()); NEXT();
+		CASE(JVM_LSTORE_3) setLocalLong(3, popLong()); NEXT();
+
+		CASE(JVM_ASTORE) setLocalRef(fetch(), popRef()); NEXT();
+		CASE(JVM_ASTORE_0) setLocalRef(0, popRef()); NEXT();
+		CASE(JVM_ASTORE_1) setLocalRef(1, popRef()); NEXT();
+		CASE(JVM_ASTORE_2) setLocalRef(2, popRef()); NEXT();
+		CASE(JVM_ASTORE_3) setLocalRef(3, popRef()); NEXT();
 
 		// Integer stack operations
-		case JVM_IPOP: intStack--; break;
-		case JVM_IPOP2: intStack -= 2; break;
+		CASE(JVM_IPOP) intStack--; NEXT();
+		CASE(JVM_IPOP2) intStack -= 2; NEXT();
 
-		case JVM_IDUP:
+		CASE(JVM_IDUP)
 			*intStack = *(intStack - 1);
 			intStack++;
-			break;
+			NEXT();
 
-		case JVM_IDUP2:
+		CASE(JVM_IDUP2)
 			*(intStack + 1) = *(intStack - 1);
 			*(intStack) = *(intStack - 2);
 			intStack += 2;
-			break;
+			NEXT();
 
-		case JVM_IDUP_X:
+		CASE(JVM_IDUP_X)
 			m = fetch();
 			n = m & 15;
 			m >>= 4;
@@ -1422,54 +1762,51 @@ int dj_exec_run(int nrOpcodes)
 					intStack[-i - n - 1] = intStack[-i - 1];
 			}
 
-			break;
+			NEXT();
 
 		// TODO make faster
-		case JVM_IDUP_X1:
-			temp1 = popShort();
-			temp2 = popShort();
-			pushShort(temp1);
-			pushShort(temp2);
-			pushShort(temp1);
-			break;
+		// the slots are moved whole, they hold an int rather than half of one when EXECUTION_32BIT_SLOTS is defined
+		CASE(JVM_IDUP_X1)
+			intStack[0] = intStack[-1];
+			intStack[-1] = intStack[-2];
+			intStack[-2] = intStack[0];
+			intStack++;
+			NEXT();
 
-		// TODO make faster
-		case JVM_IDUP_X2:
-			temp1 = popShort();
-			temp2 = popShort();
-			temp3 = popShort();
-			pushShort(temp1);
-			pushShort(temp3);
-			pushShort(temp2);
-			pushShort(temp1);
-			break;
+		CASE(JVM_IDUP_X2)
+			intStack[0] = intStack[-1];
+			intStack[-1] = intStack[-2];
+			intStack[-2] = intStack[-3];
+			intStack[-3] = intStack[0];
+			intStack++;
+			NEXT();
 
 		// Reference stack operations
-		case JVM_APOP: refStack++; break;
-		case JVM_APOP2:	refStack += 2; break;
+		CASE(JVM_APOP) refStack++; NEXT();
+		CASE(JVM_APOP2)	refStack += 2; NEXT();
 
-		case JVM_ADUP:
+		CASE(JVM_ADUP)
 			refStack--;
 			*refStack = *(refStack + 1);
-			break;
+			NEXT();
 
-		case JVM_ADUP2:
+		CASE(JVM_ADUP2)
 			refStack -= 2;
 			*(refStack) = *(refStack + 2);
 			*(refStack + 1) = *(refStack + 3);
-			break;
+			NEXT();
 
 		// TODO make faster
-		case JVM_ADUP_X1:
+		CASE(JVM_ADUP_X1)
 			rtemp1 = popRef();
 			rtemp2 = popRef();
 			pushRef(rtemp1);
 			pushRef(rtemp2);
 			pushRef(rtemp1);
-			break;
+			NEXT();
 
 		// TODO make faster
-		case JVM_ADUP_X2:
+		CASE(JVM_ADUP_X2)
 			rtemp1 = popRef();
 			rtemp2 = popRef();
 			rtemp3 = popRef();
@@ -1477,122 +1814,122 @@ int dj_exec_run(int nrOpcodes)
 			pushRef(rtemp3);
 			pushRef(rtemp2);
 			pushRef(rtemp1);
-			break;
+			NEXT();
 
 		// program flow
-		case JVM_GOTO: GOTO(); break;
-
-		case JVM_IF_ICMPEQ: IF_ICMPEQ(); break;
-		case JVM_IF_ICMPNE:	IF_ICMPNE(); break;
-		case JVM_IF_ICMPLT:	IF_ICMPLT(); break;
-		case JVM_IF_ICMPGE:	IF_ICMPGE(); break;
-		case JVM_IF_ICMPGT:	IF_ICMPGT(); break;
-		case JVM_IF_ICMPLE:	IF_ICMPLE(); break;
-
-		case JVM_IF_SCMPEQ:	IF_SCMPEQ(); break;
-		case JVM_IF_SCMPNE:	IF_SCMPNE(); break;
-		case JVM_IF_SCMPLT:	IF_SCMPLT(); break;
-		case JVM_IF_SCMPGE:	IF_SCMPGE(); break;
-		case JVM_IF_SCMPGT:	IF_SCMPGT(); break;
-		case JVM_IF_SCMPLE:	IF_SCMPLE(); break;
-
-		case JVM_IIFEQ: IIFEQ(); break;
-		case JVM_IIFNE: IIFNE(); break;
-		case JVM_IIFLT: IIFLT(); break;
-		case JVM_IIFGE: IIFGE(); break;
-		case JVM_IIFGT: IIFGT(); break;
-		case JVM_IIFLE: IIFLE(); break;
-
-		case JVM_SIFEQ: SIFEQ(); break;
-		case JVM_SIFNE: SIFNE(); break;
-		case JVM_SIFLT: SIFLT(); break;
-		case JVM_SIFGE: SIFGE(); break;
-		case JVM_SIFGT: SIFGT(); break;
-		case JVM_SIFLE: SIFLE(); break;
-
-		case JVM_IF_ACMPEQ: IF_ACMPEQ(); break;
-		case JVM_IF_ACMPNE: IF_ACMPNE(); break;
-		case JVM_IFNULL: IFNULL(); break;
-		case JVM_IFNONNULL: IFNONNULL(); break;
-
-		case JVM_RETURN: RETURN(); break;
-		case JVM_SRETURN: SRETURN(); break;
-		case JVM_IRETURN: IRETURN(); break;
-		case JVM_LRETURN: LRETURN(); break;
-		case JVM_ARETURN: ARETURN(); break;
-
-		case JVM_INVOKESTATIC: INVOKESTATIC(); break;
-		case JVM_INVOKESPECIAL: INVOKESPECIAL(); break;
-		case JVM_INVOKEVIRTUAL:	INVOKEVIRTUAL(); break;
-		case JVM_INVOKEINTERFACE: INVOKEINTERFACE();break;
+		CASE(JVM_GOTO) GOTO(); NEXT_CHECKED();
+
+		CASE(JVM_IF_ICMPEQ) IF_ICMPEQ(); NEXT_CHECKED();
+		CASE(JVM_IF_ICMPNE)	IF_ICMPNE(); NEXT_CHECKED();
+		CASE(JVM_IF_ICMPLT)	IF_ICMPLT(); NEXT_CHECKED();
+		CASE(JVM_IF_ICMPGE)	IF_ICMPGE(); NEXT_CHECKED();
+		CASE(JVM_IF_ICMPGT)	IF_ICMPGT(); NEXT_CHECKED();
+		CASE(JVM_IF_ICMPLE)	IF_ICMPLE(); NEXT_CHECKED();
+
+		CASE(JVM_IF_SCMPEQ)	IF_SCMPEQ(); NEXT_CHECKED();
+		CASE(JVM_IF_SCMPNE)	IF_SCMPNE(); NEXT_CHECKED();
+		CASE(JVM_IF_SCMPLT)	IF_SCMPLT(); NEXT_CHECKED();
+		CASE(JVM_IF_SCMPGE)	IF_SCMPGE(); NEXT_CHECKED();
+		CASE(JVM_IF_SCMPGT)	IF_SCMPGT(); NEXT_CHECKED();
+		CASE(JVM_IF_SCMPLE)	IF_SCMPLE(); NEXT_CHECKED();
+
+		CASE(JVM_IIFEQ) IIFEQ(); NEXT_CHECKED();
+		CASE(JVM_IIFNE) IIFNE(); NEXT_CHECKED();
+		CASE(JVM_IIFLT) IIFLT(); NEXT_CHECKED();
+		CASE(JVM_IIFGE) IIFGE(); NEXT_CHECKED();
+		CASE(JVM_IIFGT) IIFGT(); NEXT_CHECKED();
+		CASE(JVM_IIFLE) IIFLE(); NEXT_CHECKED();
+
+		CASE(JVM_SIFEQ) SIFEQ(); NEXT_CHECKED();
+		CASE(JVM_SIFNE) SIFNE(); NEXT_CHECKED();
+		CASE(JVM_SIFLT) SIFLT(); NEXT_CHECKED();
+		CASE(JVM_SIFGE) SIFGE(); NEXT_CHECKED();
+		CASE(JVM_SIFGT) SIFGT(); NEXT_CHECKED();
+		CASE(JVM_SIFLE) SIFLE(); NEXT_CHECKED();
+
+		CASE(JVM_IF_ACMPEQ) IF_ACMPEQ(); NEXT_CHECKED();
+		CASE(JVM_IF_ACMPNE) IF_ACMPNE(); NEXT_CHECKED();
+		CASE(JVM_IFNULL) IFNULL(); NEXT_CHECKED();
+		CASE(JVM_IFNONNULL) IFNONNULL(); NEXT_CHECKED();
+
+		CASE(JVM_RETURN) RETURN(); NEXT_CHECKED();
+		CASE(JVM_SRETURN) SRETURN(); NEXT_CHECKED();
+		CASE(JVM_IRETURN) IRETURN(); NEXT_CHECKED();
+		CASE(JVM_LRETURN) LRETURN(); NEXT_CHECKED();
+		CASE(JVM_ARETURN) ARETURN(); NEXT_CHECKED();
+
+		CASE(JVM_INVOKESTATIC) INVOKESTATIC(); NEXT_CHECKED();
+		CASE(JVM_INVOKESPECIAL) INVOKESPECIAL(); NEXT_CHECKED();
+		CASE(JVM_INVOKEVIRTUAL)	INVOKEVIRTUAL(); NEXT_CHECKED();
+		CASE(JVM_INVOKEINTERFACE) INVOKEINTERFACE();NEXT_CHECKED();
 
 		// Monitors
-		case JVM_MONITORENTER: MONITORENTER(); break;
-		case JVM_MONITOREXIT: MONITOREXIT(); break;
+		CASE(JVM_MONITORENTER) MONITORENTER(); NEXT_CHECKED();
+		CASE(JVM_MONITOREXIT) MONITOREXIT(); NEXT_CHECKED();
 
 		// Arrays and classes
-		case JVM_NEW: NEW(); break;
-		case JVM_INSTANCEOF: INSTANCEOF(); break;
-		case JVM_CHECKCAST: CHECKCAST(); break;
+		CASE(JVM_NEW) NEW(); NEXT();
+		CASE(JVM_INSTANCEOF) INSTANCEOF(); NEXT();
+		CASE(JVM_CHECKCAST) CHECKCAST(); NEXT();
 
 		// Array operations
-		case JVM_NEWARRAY: NEWARRAY(); break;
-		case JVM_ANEWARRAY: ANEWARRAY(); break;
-		case JVM_ARRAYLENGTH: ARRAYLENGTH(); break;
-
-		case JVM_BASTORE: BASTORE(); break;
-		case JVM_CASTORE: CASTORE(); break;
-		case JVM_SASTORE: SASTORE(); break;
-		case JVM_IASTORE: IASTORE(); break;
-		case JVM_LASTORE: LASTORE(); break;
-		case JVM_AASTORE: AASTORE(); break;
-
-		case JVM_BALOAD: BALOAD(); break;
-		case JVM_CALOAD: CALOAD(); break;
-		case JVM_SALOAD: SALOAD(); break;
-		case JVM_IALOAD: IALOAD(); break;
-		case JVM_LALOAD: LALOAD(); break;
-		case JVM_AALOAD: AALOAD(); break;
+		CASE(JVM_NEWARRAY) NEWARRAY(); NEXT();
+		CASE(JVM_ANEWARRAY) ANEWARRAY(); NEXT();
+		CASE(JVM_ARRAYLENGTH) ARRAYLENGTH(); NEXT();
+
+		CASE(JVM_BASTORE) BASTORE(); NEXT();
+		CASE(JVM_CASTORE) CASTORE(); NEXT();
+		CASE(JVM_SASTORE) SASTORE(); NEXT();
+		CASE(JVM_IASTORE) IASTORE(); NEXT();
+		CASE(JVM_LASTORE) LASTORE(); NEXT();
+		CASE(JVM_AASTORE) AASTORE(); NEXT();
+
+		CASE(JVM_BALOAD) BALOAD(); NEXT();
+		CASE(JVM_CALOAD) CALOAD(); NEXT();
+		CASE(JVM_SALOAD) SALOAD(); NEXT();
+		CASE(JVM_IALOAD) IALOAD(); NEXT();
+		CASE(JVM_LALOAD) LALOAD(); NEXT();
+		CASE(JVM_AALOAD) AALOAD(); NEXT();
 
 		// Static variables
-		case JVM_GETSTATIC_B: GETSTATIC_B(); break;
-		case JVM_GETSTATIC_C: GETSTATIC_C(); break;
-		case JVM_GETSTATIC_S: GETSTATIC_S(); break;
-		case JVM_GETSTATIC_I: GETSTATIC_I(); break;
-		case JVM_GETSTATIC_L: GETSTATIC_L(); break;
-		case JVM_GETSTATIC_A: GETSTATIC_A(); break;
-
-		case JVM_PUTSTATIC_B: PUTSTATIC_B(); break;
-		case JVM_PUTSTATIC_C: PUTSTATIC_C(); break;
-		case JVM_PUTSTATIC_S: PUTSTATIC_S(); break;
-		case JVM_PUTSTATIC_I: PUTSTATIC_I(); break;
-		case JVM_PUTSTATIC_L: PUTSTATIC_L(); break;
-		case JVM_PUTSTATIC_A: PUTSTATIC_A(); break;
+		CASE(JVM_GETSTATIC_B) GETSTATIC_B(); NEXT();
+		CASE(JVM_GETSTATIC_C) GETSTATIC_C(); NEXT();
+		CASE(JVM_GETSTATIC_S) GETSTATIC_S(); NEXT();
+		CASE(JVM_GETSTATIC_I) GETSTATIC_I(); NEXT();
+		CASE(JVM_GETSTATIC_L) GETSTATIC_L(); NEXT();
+		CASE(JVM_GETSTATIC_A) GETSTATIC_A(); NEXT();
+
+		CASE(JVM_PUTSTATIC_B) PUTSTATIC_B(); NEXT();
+		CASE(JVM_PUTSTATIC_C) PUTSTATIC_C(); NEXT();
+		CASE(JVM_PUTSTATIC_S) PUTSTATIC_S(); NEXT();
+		CASE(JVM_PUTSTATIC_I) PUTSTATIC_I(); NEXT();
+		CASE(JVM_PUTSTATIC_L) PUTSTATIC_L(); NEXT();
+		CASE(JVM_PUTSTATIC_A) PUTSTATIC_A(); NEXT();
 
 		// Field operations
-		case JVM_GETFIELD_B: GETFIELD_B(); break;
-		case JVM_GETFIELD_C: GETFIELD_C(); break;
-		case JVM_GETFIELD_S: GETFIELD_S(); break;
-		case JVM_GETFIELD_I: GETFIELD_I(); break;
-		case JVM_GETFIELD_L: GETFIELD_L(); break;
-		case JVM_GETFIELD_A: GETFIELD_A(); break;
-
-		case JVM_PUTFIELD_B: PUTFIELD_B(); break;
-		case JVM_PUTFIELD_C: PUTFIELD_C(); break;
-		case JVM_PUTFIELD_S: PUTFIELD_S(); break;
-		case JVM_PUTFIELD_I: PUTFIELD_I(); break;
-		case JVM_PUTFIELD_L: PUTFIELD_L(); break;
-		case JVM_PUTFIELD_A: PUTFIELD_A(); break;
+		CASE(JVM_GETFIELD_B) GETFIELD_B(); NEXT();
+		CASE(JVM_GETFIELD_C) GETFIELD_C(); NEXT();
+		CASE(JVM_GETFIELD_S) GETFIELD_S(); NEXT();
+		CASE(JVM_GETFIELD_I) GETFIELD_I(); NEXT();
+		CASE(JVM_GETFIELD_L) GETFIELD_L(); NEXT();
+		CASE(JVM_GETFIELD_A) GETFIELD_A(); NEXT();
+
+		CASE(JVM_PUTFIELD_B) PUTFIELD_B(); NEXT();
+		CASE(JVM_PUTFIELD_C) PUTFIELD_C(); NEXT();
+		CASE(JVM_PUTFIELD_S) PUTFIELD_S(); NEXT();
+		CASE(JVM_PUTFIELD_I) PUTFIELD_I(); NEXT();
+		CASE(JVM_PUTFIELD_L) PUTFIELD_L(); NEXT();
+		CASE(JVM_PUTFIELD_A) PUTFIELD_A(); NEXT();
 
 		// Case statements
-		case JVM_TABLESWITCH: TABLESWITCH(); break;
-		case JVM_LOOKUPSWITCH: LOOKUPSWITCH(); break;
+		CASE(JVM_TABLESWITCH) TABLESWITCH(); NEXT_CHECKED();
+		CASE(JVM_LOOKUPSWITCH) LOOKUPSWITCH(); NEXT_CHECKED();
 
 		// Exceptions
-		case JVM_ATHROW: ATHROW(); break;
+		CASE(JVM_ATHROW) ATHROW(); NEXT_CHECKED();
 
 		// Long compare
-		case JVM_LCMP:
+		CASE(JVM_LCMP)
 			// TODO maybe find a smarter/quicker way of doing this
 			ltemp2 = popLong();
 			ltemp1 = popLong();
@@ -1603,16 +1940,32 @@ int dj_exec_run(int nrOpcodes)
 			else
 				pushShort(0);
 
-			break;
+			NEXT();
+
+#ifdef EXECUTION_SUPERINSTRUCTIONS
+		// fused instructions
+		CASE(JVM_SLOAD_SIFEQ) SLOAD_SIFEQ(); NEXT_CHECKED();
+		CASE(JVM_SLOAD_SIFNE) SLOAD_SIFNE(); NEXT_CHECKED();
+		CASE(JVM_ILOAD_IIFEQ) ILOAD_IIFEQ(); NEXT_CHECKED();
+		CASE(JVM_ILOAD_IIFNE) ILOAD_IIFNE(); NEXT_CHECKED();
+		CASE(JVM_ALOAD_0_GETFIELD_B) pushRef(getLocalRef(0)); GETFIELD_B(); NEXT();
+		CASE(JVM_ALOAD_0_GETFIELD_S) pushRef(getLocalRef(0)); GETFIELD_S(); NEXT();
+		CASE(JVM_ALOAD_0_GETFIELD_I) pushRef(getLocalRef(0)); GETFIELD_I(); NEXT();
+		CASE(JVM_ALOAD_0_GETFIELD_A) pushRef(getLocalRef(0)); GETFIELD_A(); NEXT();
+#endif
 
 		// misc
-		case JVM_NOP: /* do nothing :3 */ break;
+		CASE(JVM_NOP) /* do nothing :3 */ NEXT();
 
-		default:
+		DEFAULT
 			DEBUG_LOG(DBG_DARJEELING, "Unimplemented opcode %d at pc=%d\n", opcode, oldPc);
 			dj_exec_createAndThrow(BASE_CDEF_java_lang_VirtualMachineError);
+			NEXT_CHECKED();
 		}
 
+#ifdef EXECUTION_THREADED_DISPATCH
+dispatchDone:
+#else
 #ifdef DARJEELING_DEBUG_TRACE
 
 		dj_thread *currentThread = dj_exec_getCurrentThread();
@@ -1625,7 +1978,7 @@ int dj_exec_run(int nrOpcodes)
 
 		DEBUG_LOG(DBG_DARJEELING, "R<");
 
-		dj_di_pointer method = dj_global_id_getMethodImplementation(current_frame->method);
+		dj_di_pointer method = dj_frame_getMethodImplementation(current_frame);
 		int len = dj_di_methodImplementation_getReferenceLocalVariableCount(method);
 		for (i=0; i<len; i++)
 			DEBUG_LOG(DBG_DARJEELING, (i==0)?" %-9d ":", %-9d ", localReferenceVariables[i]);
@@ -1653,7 +2006,7 @@ int dj_exec_run(int nrOpcodes)
 
 		DEBUG_LOG(DBG_DARJEELING, "\tI(");
 
-		int16_t *intStackStart = dj_frame_getStackStart(current_frame);
+		dj_int_slot *intStackStart = dj_frame_getStackStart(current_frame);
 		for (i=0; i<current_frame->nr_int_stack; i++)
 			DEBUG_LOG(DBG_DARJEELING, "%-6d,", intStackStart[i]);
 
@@ -1669,10 +2022,24 @@ int dj_exec_run(int nrOpcodes)
 
 
 	}
+#endif
 
 	return nrOpcodesLeft;
 
 }
+
+#ifdef OPCODE_PROFILER
+/**
+ * Gets the name of an opcode, for the opcode profiler's report.
+ * @param opcode the opcode
+ * @return the name of the opcode, or "?" if it isn't defined
+ */
+const char *dj_exec_getOpcodeName(uint8_t opcode)
+{
+	return (opcode<=JVM_ALOAD_0_GETFIELD_A) ? jvm_opcodes[opcode] : "?";
+}
+#endif
+
 /**
  * @}
  */
@@ -26,6 +26,8 @@
 #include "vm.h"
 #include "execution.h"
 #include "object.h"
+#include "vtable.h"
+#include "type_table.h"
 #include "debug.h"
 
 #include "jlib_base.h"
@@ -125,6 +127,15 @@ char dj_global_id_implements(dj_global_id class, dj_global_id interface)
 {
 	dj_global_id finger = class;
 
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table *typeTable = dj_exec_getVM()->typeTable;
+	runtime_id_t classId = dj_global_id_getRuntimeClassId(class);
+	runtime_id_t interfaceId = dj_global_id_getRuntimeClassId(interface);
+
+	if (typeTable!=NULL && dj_type_table_contains(typeTable, classId) && dj_type_table_contains(typeTable, interfaceId))
+		return dj_type_table_implements(typeTable, classId, interfaceId);
+#endif
+
 	// java.lang.Object doesn't implement any interface and has no parent
 	while (!dj_global_id_isJavaLangObject(finger))
 	{
@@ -151,6 +162,18 @@ char dj_global_id_isEqualToOrChildOf(dj_global_id child, dj_global_id parent)
                          child.infusion,child.entity_id,
                          parent.infusion,parent.entity_id);
 
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table *typeTable = dj_exec_getVM()->typeTable;
+	runtime_id_t childId = dj_global_id_getRuntimeClassId(child);
+	runtime_id_t parentId = dj_global_id_getRuntimeClassId(parent);
+
+	if (typeTable!=NULL && dj_type_table_contains(typeTable, childId) && dj_type_table_contains(typeTable, parentId))
+	{
+		DEBUG_EXIT_NEST(DBG_DARJEELING, "dj_global_id_isEqualToOrChildOf() using the type table");
+		return dj_type_table_isEqualToOrChildOf(typeTable, childId, parentId);
+	}
+#endif
+
     // if equal return true
     if (dj_global_id_isJavaLangObject(parent))
 	{
@@ -212,6 +235,18 @@ char dj_global_id_testClassType(dj_global_id refClass, dj_global_id testType)
                          refClass.infusion,refClass.entity_id,
                          testType.infusion,testType.entity_id);
 
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table *typeTable = dj_exec_getVM()->typeTable;
+	runtime_id_t refClassId = dj_global_id_getRuntimeClassId(refClass);
+	runtime_id_t testTypeId = dj_global_id_getRuntimeClassId(testType);
+
+	if (typeTable!=NULL && dj_type_table_contains(typeTable, refClassId) && dj_type_table_contains(typeTable, testTypeId))
+	{
+		DEBUG_EXIT_NEST(DBG_DARJEELING, "dj_global_id_testClassType() using the type table");
+		return dj_type_table_testClassType(typeTable, refClassId, testTypeId);
+	}
+#endif
+
 	// check if refClass is equal to, or subclass of testType
 	if (dj_global_id_isEqualToOrChildOf(refClass, testType))
     {
@@ -337,6 +372,13 @@ dj_global_id dj_global_id_lookupVirtualMethod(dj_global_id resolvedMethodDefId,
 
 	// resolve runtime class of the object
 	vm = dj_exec_getVM();
+
+#ifdef VM_FLATTENED_VTABLES
+	// use the flattened method tables if they could be built
+	if (vm->vtables!=NULL)
+		return dj_vtables_lookup(vm->vtables, resolvedMethodDefId, dj_mem_getChunkId(object));
+#endif
+
 	classId = dj_vm_getRuntimeClass(vm, dj_mem_getChunkId(object));
 
 	while (true)
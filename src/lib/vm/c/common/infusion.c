@@ -138,7 +138,7 @@ void dj_infusion_markRootSet(dj_infusion *infusion)
 	dj_mem_setChunkColor(infusion, TCM_BLACK);
 
 	for (i=0; i<infusion->nr_static_refs; i++)
-		dj_mem_setRefColor(infusion->staticReferenceFields[i], TCM_GRAY);
+		dj_mem_setRefGrayIfWhite(infusion->staticReferenceFields[i]);
 }
 
 void dj_infusion_updatePointers(dj_infusion *infusion)
@@ -66,6 +66,10 @@ dj_object * dj_jstring_createFromGlobalId(dj_vm *vm, dj_global_id stringId)
 	uint16_t stringLength = dj_di_stringtable_getElementLength(stringId.infusion->stringTable, stringId.entity_id);
 
 	BASE_STRUCT_java_lang_String * jstring = (BASE_STRUCT_java_lang_String*)dj_jstring_create(vm, stringLength);
+
+	// let the caller deal with out of memory
+	if (jstring == NULL) return NULL;
+
 	dj_int_array * charArray = REF_TO_VOIDP(jstring->value);
 
 	// Copy ASCII from program space to the array
@@ -74,3 +78,108 @@ dj_object * dj_jstring_createFromGlobalId(dj_vm *vm, dj_global_id stringId)
 
 	return (dj_object *)jstring;
 }
+
+#ifdef VM_INTERN_STRINGS
+
+/**
+ * Interned string constants. LDS would otherwise create a new String object, and copy the string from program memory,
+ * every time it executes. The table is a direct mapped cache keyed on (infusion, string id), so a constant that
+ * collides with another one is simply created again.
+ *
+ * The strings are held weakly: the table isn't part of the root set, and entries whose string has been collected are
+ * removed after each collection. Entries for an infusion are removed when it is unloaded.
+ */
+typedef struct _dj_jstring_intern_entry
+{
+	dj_infusion * infusion;
+	dj_object * string;
+	uint8_t entity_id;
+} dj_jstring_intern_entry;
+
+static DJ_VM_LOCAL dj_jstring_intern_entry internTable[VM_INTERN_STRINGS_SIZE];
+
+/**
+ * @return the slot for a string constant. The infusion header is in program memory, so unlike the infusion pointer
+ * it doesn't change during compaction.
+ */
+static inline dj_jstring_intern_entry * dj_jstring_getInternSlot(dj_global_id stringId)
+{
+	return &internTable[(stringId.entity_id ^ ((size_t)stringId.infusion->header >> 4)) % VM_INTERN_STRINGS_SIZE];
+}
+
+/**
+ * Returns the String object for a string constant, creating it if it isn't in the intern table.
+ * @param vm the virtual machine context
+ * @param stringId global id of the string constant
+ * @return the String object, or NULL if there was not enough memory to create it
+ */
+dj_object * dj_jstring_intern(dj_vm *vm, dj_global_id stringId)
+{
+	dj_jstring_intern_entry * entry;
+	dj_object * string;
+
+	entry = dj_jstring_getInternSlot(stringId);
+	if (entry->string!=NULL && entry->infusion==stringId.infusion && entry->entity_id==stringId.entity_id)
+		return entry->string;
+
+	// creating the string may trigger a collection that moves the infusion and changes the table
+	dj_mem_addSafePointer((void**)&stringId.infusion);
+	string = dj_jstring_createFromGlobalId(vm, stringId);
+	dj_mem_removeSafePointer((void**)&stringId.infusion);
+
+	if (string!=NULL)
+	{
+		entry = dj_jstring_getInternSlot(stringId);
+		entry->infusion = stringId.infusion;
+		entry->entity_id = stringId.entity_id;
+		entry->string = string;
+	}
+
+	return string;
+}
+
+/**
+ * Removes the strings that have been collected from the intern table. Called after marking, when the chunks of
+ * collected objects have been marked free but not yet reused.
+ */
+void dj_jstring_removeCollectedInterned()
+{
+	uint8_t i;
+
+	for (i=0; i<VM_INTERN_STRINGS_SIZE; i++)
+		if (internTable[i].string!=NULL && dj_mem_getChunkId(internTable[i].string)==CHUNKID_FREE)
+			internTable[i].string = NULL;
+}
+
+/**
+ * Updates the pointers in the intern table during compaction. Strings that have been collected are removed first,
+ * since their chunks don't have a valid new position.
+ */
+void dj_jstring_updateInternedPointers()
+{
+	uint8_t i;
+
+	dj_jstring_removeCollectedInterned();
+
+	for (i=0; i<VM_INTERN_STRINGS_SIZE; i++)
+		if (internTable[i].string!=NULL)
+		{
+			internTable[i].string = dj_mem_getUpdatedPointer(internTable[i].string);
+			internTable[i].infusion = dj_mem_getUpdatedPointer(internTable[i].infusion);
+		}
+}
+
+/**
+ * Removes the string constants of an infusion from the intern table.
+ * @param infusion the infusion that is being unloaded
+ */
+void dj_jstring_removeInternedInfusion(dj_infusion *infusion)
+{
+	uint8_t i;
+
+	for (i=0; i<VM_INTERN_STRINGS_SIZE; i++)
+		if (internTable[i].infusion==infusion)
+			internTable[i].string = NULL;
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "heap.h"
 #include "execution.h"
 #include "panic.h"
+#include "alloc_profiler.h"
 
 /**
  * Constructs a new object.
@@ -49,6 +50,10 @@ dj_object *dj_object_create(runtime_id_t type, int nr_refs, int non_ref_size)
 	// init fields to 0
 	memset((void*)ret, 0, size);
 
+#ifdef ALLOC_PROFILER
+	dj_allocprof_recordType(DJ_ALLOCPROF_OBJECT, type, ret);
+#endif
+
 	return ret;
 }
 
@@ -0,0 +1,219 @@
+/*
+ * opcode_profiler.c
+ *
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ *
+ * This file is part of Darjeeling.
+ *
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Opcode sequence profiler.
+ *
+ * When OPCODE_PROFILER is defined, dj_exec_run reports every opcode it dispatches, and the profiler counts how often
+ * each pair and each triple of consecutively dispatched opcodes is executed. The hottest sequences are the candidates
+ * for the fused instructions the infuser emits with -superinstructions=true; fusing a sequence of n opcodes saves n-1
+ * dispatches each time it executes.
+ *
+ * Sequences are counted as they are dispatched, so they also span branches, calls and returns, which the infuser
+ * can't fuse. The sequence is restarted at the beginning of each time slice so that it doesn't run across threads.
+ *
+ * Pairs and triples are kept in two open addressing hash tables of OPCODE_PROFILER_SIZE entries each. They are static
+ * so that profiling doesn't change the heap behaviour of the program. When a table is full, further sequences are
+ * only counted in its overflow total.
+ *
+ * The report lists the OPCODE_PROFILER_TOP most executed pairs and triples, and is printed by dj_opprof_dump(), and at
+ * shutdown through dj_core_shutdownHook.
+ */
+
+#include "opcode_profiler.h"
+#include "debug.h"
+
+#include "config.h"
+
+#ifdef OPCODE_PROFILER
+
+typedef struct _dj_opprof_entry
+{
+	uint32_t sequence;		// opcodes, the last one in the lowest byte; 0 marks an empty entry
+	uint32_t count;
+} dj_opprof_entry;
+
+typedef struct _dj_opprof_table
+{
+	dj_opprof_entry entries[OPCODE_PROFILER_SIZE];
+	uint16_t nr_entries;
+	uint32_t overflow_count;
+} dj_opprof_table;
+
+static DJ_VM_LOCAL dj_opprof_table pairTable;
+static DJ_VM_LOCAL dj_opprof_table tripleTable;
+
+static DJ_VM_LOCAL uint32_t nrDispatches;
+static DJ_VM_LOCAL uint8_t history[2];
+static DJ_VM_LOCAL uint8_t historyLength;
+
+/**
+ * Counts one execution of an opcode sequence.
+ * @param table the table to count the sequence in
+ * @param sequence the opcodes of the sequence, one per byte. The length of the sequence is stored in the top byte
+ * so that a sequence of NOPs isn't mistaken for an empty entry.
+ */
+static void dj_opprof_add(dj_opprof_table *table, uint32_t sequence)
+{
+	uint16_t i = (uint16_t)((sequence * 40503u) % OPCODE_PROFILER_SIZE);
+	uint16_t probes;
+
+	for (probes=0; probes<OPCODE_PROFILER_SIZE; probes++)
+	{
+		if (table->entries[i].sequence==sequence)
+		{
+			table->entries[i].count++;
+			return;
+		}
+
+		if (table->entries[i].sequence==0)
+		{
+			if (table->nr_entries==OPCODE_PROFILER_SIZE)
+				break;
+
+			table->entries[i].sequence = sequence;
+			table->entries[i].count = 1;
+			table->nr_entries++;
+			return;
+		}
+
+		i = (i+1) % OPCODE_PROFILER_SIZE;
+	}
+
+	table->overflow_count++;
+}
+
+/**
+ * Records the dispatch of an opcode. Called by dj_exec_run for every opcode it executes.
+ * @param opcode the opcode that is about to be executed
+ */
+void dj_opprof_record(uint8_t opcode)
+{
+	nrDispatches++;
+
+	if (historyLength>=1)
+		dj_opprof_add(&pairTable, (2ul<<24) | ((uint32_t)history[1]<<8) | opcode);
+
+	if (historyLength>=2)
+		dj_opprof_add(&tripleTable, (3ul<<24) | ((uint32_t)history[0]<<16) | ((uint32_t)history[1]<<8) | opcode);
+
+	history[0] = history[1];
+	history[1] = opcode;
+	if (historyLength<2) historyLength++;
+}
+
+/**
+ * Ends the current sequence, so that the next opcode isn't counted as a successor of the previous one.
+ */
+void dj_opprof_break()
+{
+	historyLength = 0;
+}
+
+/**
+ * Prints the most executed sequences of a table, most executed first. Each line shows the count, the share of all
+ * dispatches, the opcode numbers and the opcode names.
+ * @param table the table to print
+ * @param length the length of the sequences in the table
+ */
+static void dj_opprof_printTable(dj_opprof_table *table, uint8_t length)
+{
+	uint16_t i, n, best;
+	uint32_t previousCount = UINT32_MAX;
+	uint16_t previousIndex = 0;
+	dj_opprof_entry *entry;
+	uint32_t permille;
+	int8_t j;
+
+	// select the entries in order of decreasing count instead of sorting, so that the hash table stays intact
+	// and profiling can continue after a dump
+	for (n=0; n<OPCODE_PROFILER_TOP && n<table->nr_entries; n++)
+	{
+		best = OPCODE_PROFILER_SIZE;
+		for (i=0; i<OPCODE_PROFILER_SIZE; i++)
+		{
+			entry = &table->entries[i];
+			if (entry->sequence==0) continue;
+
+			// skip the entries that have been printed already
+			if (entry->count>previousCount || (entry->count==previousCount && i<=previousIndex)) continue;
+
+			if (best==OPCODE_PROFILER_SIZE || entry->count>table->entries[best].count)
+				best = i;
+		}
+
+		entry = &table->entries[best];
+		permille = (uint32_t)((uint64_t)entry->count * 1000 / nrDispatches);
+		DARJEELING_PRINTF("\t%10ld %3ld.%ld%% ", (long)entry->count, (long)permille/10, (long)permille%10);
+		for (j=length-1; j>=0; j--)
+			DARJEELING_PRINTF(" %3d", (entry->sequence>>(j*8)) & 0xff);
+		DARJEELING_PRINTF("  ");
+		for (j=length-1; j>=0; j--)
+			DARJEELING_PRINTF(" %s", dj_exec_getOpcodeName((entry->sequence>>(j*8)) & 0xff));
+		DARJEELING_PRINTF("\n");
+
+		previousCount = entry->count;
+		previousIndex = best;
+	}
+
+	if (table->overflow_count>0)
+		DARJEELING_PRINTF("\t%10ld (table full)\n", (long)table->overflow_count);
+}
+
+/**
+ * Prints the number of dispatched opcodes and the most executed opcode pairs and triples.
+ */
+void dj_opprof_dump()
+{
+	DARJEELING_PRINTF("Opcodes dispatched: %ld\n", (long)nrDispatches);
+	DARJEELING_PRINTF("Opcode pairs:\n");
+	dj_opprof_printTable(&pairTable, 2);
+	DARJEELING_PRINTF("Opcode triples:\n");
+	dj_opprof_printTable(&tripleTable, 3);
+}
+
+/**
+ * Clears the counters, so that a specific part of a program can be profiled.
+ */
+void dj_opprof_reset()
+{
+	uint16_t i;
+
+	for (i=0; i<OPCODE_PROFILER_SIZE; i++)
+	{
+		pairTable.entries[i].sequence = 0;
+		tripleTable.entries[i].sequence = 0;
+	}
+
+	pairTable.nr_entries = 0;
+	pairTable.overflow_count = 0;
+	tripleTable.nr_entries = 0;
+	tripleTable.overflow_count = 0;
+	nrDispatches = 0;
+	historyLength = 0;
+}
+
+void dj_opprof_shutdown(void *data)
+{
+	dj_opprof_dump();
+}
+
+#endif
@@ -240,7 +240,17 @@
 #define JVM_S2L 217
 #define JVM_LCMP 218
 
-#if defined(DARJEELING_DEBUG) && defined(DARJEELING_DEBUG_TRACE)
+// fused instructions, emitted by the infuser when it is run with -superinstructions=true
+#define JVM_SLOAD_SIFEQ 219
+#define JVM_SLOAD_SIFNE 220
+#define JVM_ILOAD_IIFEQ 221
+#define JVM_ILOAD_IIFNE 222
+#define JVM_ALOAD_0_GETFIELD_B 223
+#define JVM_ALOAD_0_GETFIELD_S 224
+#define JVM_ALOAD_0_GETFIELD_I 225
+#define JVM_ALOAD_0_GETFIELD_A 226
+
+#if (defined(DARJEELING_DEBUG) && defined(DARJEELING_DEBUG_TRACE)) || defined(OPCODE_PROFILER)
 
 const char *jvm_opcodes[] = {
 "nop",
@@ -461,6 +471,14 @@ const char *jvm_opcodes[] = {
 "l2s",
 "i2l",
 "s2l",
-"lcmp"
+"lcmp",
+"sload_sifeq",
+"sload_sifne",
+"iload_iifeq",
+"iload_iifne",
+"aload_0_getfield_b",
+"aload_0_getfield_s",
+"aload_0_getfield_i",
+"aload_0_getfield_a"
 };
-#endif // defined(DARJEELING_DEBUG) && defined(DARJEELING_DEBUG_TRACE)
+#endif // (defined(DARJEELING_DEBUG) && defined(DARJEELING_DEBUG_TRACE)) || defined(OPCODE_PROFILER)
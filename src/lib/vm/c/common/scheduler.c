@@ -0,0 +1,497 @@
+/*
+ * scheduler.c
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Run queue, timer heap and monitor blocked lists.
+ *
+ * The scheduler keeps threads that can run in a FIFO ready queue, so that picking the next thread is a matter of
+ * taking the head of the queue, and a thread that used up its quantum is put back at the tail (round robin). The
+ * thread that is currently executing is not in the ready queue.
+ *
+ * Sleeping threads and threads in a timed wait are kept in a pairing heap ordered on scheduleTime, so that waking
+ * them only looks at the threads whose timeout has expired. Every monitor has two FIFO queues: the entry queue holds
+ * the threads that are blocked on entering the monitor, the wait queue the threads that called wait() on it. When
+ * the owner releases the monitor it is handed directly to the thread at the head of the entry queue, and notify
+ * moves the thread at the head of the wait queue to the tail of the entry queue, so threads never have to be polled
+ * and get the monitor in the order in which they asked for it.
+ *
+ * All queues are linked through fields in dj_thread, so the scheduler never allocates memory. The vm->threads list
+ * still holds every thread and is used for garbage collection and lookups by id.
+ */
+
+#include "scheduler.h"
+#include "vmthread.h"
+#include "vm.h"
+#include "djtimer.h"
+#include "debug.h"
+
+#include "config.h"
+
+/**
+ * Appends a thread to the tail of the ready queue. Does nothing if the thread is already queued.
+ * @param vm the virtual machine context
+ * @param thread the thread to append
+ */
+void dj_scheduler_enqueue(dj_vm *vm, dj_thread *thread)
+{
+	if (thread->queued & DJ_THREAD_QUEUED_READY)
+		return;
+
+	thread->queueNext = NULL;
+	if (vm->readyTail==NULL)
+		vm->readyHead = thread;
+	else
+		vm->readyTail->queueNext = thread;
+	vm->readyTail = thread;
+
+	thread->queued |= DJ_THREAD_QUEUED_READY;
+	vm->nrReady++;
+}
+
+/**
+ * Takes the thread at the head of the ready queue.
+ * @param vm the virtual machine context
+ * @return the next thread to run, or NULL if no thread is ready
+ */
+dj_thread *dj_scheduler_dequeue(dj_vm *vm)
+{
+	dj_thread *thread = vm->readyHead;
+
+	if (thread!=NULL)
+	{
+		vm->readyHead = thread->queueNext;
+		if (vm->readyHead==NULL)
+			vm->readyTail = NULL;
+
+		thread->queueNext = NULL;
+		thread->queued &= ~DJ_THREAD_QUEUED_READY;
+		vm->nrReady--;
+	}
+
+	return thread;
+}
+
+/**
+ * Removes a thread from the middle of the ready queue. This is only needed when threads are killed, so a linear
+ * search is fine here.
+ * @param vm the virtual machine context
+ * @param thread the thread to remove
+ */
+static void dj_scheduler_removeReady(dj_vm *vm, dj_thread *thread)
+{
+	dj_thread *pre;
+
+	if (vm->readyHead==thread)
+	{
+		dj_scheduler_dequeue(vm);
+		return;
+	}
+
+	for (pre=vm->readyHead; pre!=NULL && pre->queueNext!=thread; pre=pre->queueNext);
+	if (pre==NULL)
+		return;
+
+	pre->queueNext = thread->queueNext;
+	if (vm->readyTail==thread)
+		vm->readyTail = pre;
+
+	thread->queueNext = NULL;
+	thread->queued &= ~DJ_THREAD_QUEUED_READY;
+	vm->nrReady--;
+}
+
+/**
+ * Makes a thread runnable: sets its status to THREADSTATUS_RUNNING, cancels its timeout if it has one and appends
+ * it to the ready queue.
+ * @param vm the virtual machine context
+ * @param thread the thread to wake up
+ */
+void dj_scheduler_makeReady(dj_vm *vm, dj_thread *thread)
+{
+	if (thread->queued & DJ_THREAD_QUEUED_TIMER)
+		dj_scheduler_removeTimer(vm, thread);
+
+	thread->status = THREADSTATUS_RUNNING;
+
+	// the current thread is put back in the queue by dj_vm_schedule when its time slice ends
+	if (thread!=vm->currentThread)
+		dj_scheduler_enqueue(vm, thread);
+}
+
+/**
+ * Melds two timer heaps. Both arguments must be roots, meaning that they have no siblings or parent.
+ * @return the root of the melded heap
+ */
+static dj_thread *dj_scheduler_meld(dj_thread *a, dj_thread *b)
+{
+	dj_thread *temp;
+
+	if (a==NULL) return b;
+	if (b==NULL) return a;
+
+	if (b->scheduleTime < a->scheduleTime)
+	{
+		temp = a;
+		a = b;
+		b = temp;
+	}
+
+	// make b the first child of a
+	b->heapPrev = a;
+	b->heapSibling = a->heapChild;
+	if (a->heapChild!=NULL)
+		a->heapChild->heapPrev = b;
+	a->heapChild = b;
+
+	return a;
+}
+
+/**
+ * Melds a list of sibling heaps into a single heap using the standard two-pass scheme: first meld pairs from left to
+ * right, then meld the results from right to left. This is done iteratively to keep stack usage constant.
+ * @param first the first heap in the sibling list
+ * @return the root of the melded heap
+ */
+static dj_thread *dj_scheduler_meldSiblings(dj_thread *first)
+{
+	dj_thread *a, *b, *next, *pairs = NULL, *ret = NULL;
+
+	// first pass, the melded pairs are pushed on a list that is linked through heapSibling, in reverse order
+	while (first!=NULL)
+	{
+		a = first;
+		b = a->heapSibling;
+		next = (b==NULL) ? NULL : b->heapSibling;
+
+		a->heapSibling = a->heapPrev = NULL;
+		if (b!=NULL)
+			b->heapSibling = b->heapPrev = NULL;
+
+		a = dj_scheduler_meld(a, b);
+		a->heapSibling = pairs;
+		pairs = a;
+
+		first = next;
+	}
+
+	// second pass, right to left
+	while (pairs!=NULL)
+	{
+		next = pairs->heapSibling;
+		pairs->heapSibling = NULL;
+		ret = dj_scheduler_meld(ret, pairs);
+		pairs = next;
+	}
+
+	return ret;
+}
+
+/**
+ * Adds a thread to the timer heap. The thread will be made ready by dj_scheduler_wakeExpired once its scheduleTime
+ * has passed.
+ * @param vm the virtual machine context
+ * @param thread the thread to add, with its scheduleTime set
+ */
+void dj_scheduler_addTimer(dj_vm *vm, dj_thread *thread)
+{
+	if (thread->queued & DJ_THREAD_QUEUED_TIMER)
+		dj_scheduler_removeTimer(vm, thread);
+
+	thread->heapChild = thread->heapSibling = thread->heapPrev = NULL;
+	vm->timerHeap = dj_scheduler_meld(vm->timerHeap, thread);
+	thread->queued |= DJ_THREAD_QUEUED_TIMER;
+}
+
+/**
+ * Removes a thread from the timer heap, for instance because it was notified before its timeout expired.
+ * @param vm the virtual machine context
+ * @param thread the thread to remove
+ */
+void dj_scheduler_removeTimer(dj_vm *vm, dj_thread *thread)
+{
+	dj_thread *children;
+
+	if (!(thread->queued & DJ_THREAD_QUEUED_TIMER))
+		return;
+
+	if (vm->timerHeap==thread)
+	{
+		vm->timerHeap = dj_scheduler_meldSiblings(thread->heapChild);
+	} else
+	{
+		// unlink the thread from its parent or previous sibling
+		if (thread->heapPrev->heapChild==thread)
+			thread->heapPrev->heapChild = thread->heapSibling;
+		else
+			thread->heapPrev->heapSibling = thread->heapSibling;
+
+		if (thread->heapSibling!=NULL)
+			thread->heapSibling->heapPrev = thread->heapPrev;
+
+		// meld its children back into the heap
+		children = dj_scheduler_meldSiblings(thread->heapChild);
+		vm->timerHeap = dj_scheduler_meld(vm->timerHeap, children);
+	}
+
+	thread->heapChild = thread->heapSibling = thread->heapPrev = NULL;
+	thread->queued &= ~DJ_THREAD_QUEUED_TIMER;
+}
+
+/**
+ * Makes all threads whose timeout has expired ready. Threads that were waiting on a monitor give up waiting.
+ * @param vm the virtual machine context
+ */
+void dj_scheduler_wakeExpired(dj_vm *vm)
+{
+	dj_thread *thread;
+	dj_time_t time;
+
+	// don't bother reading the clock if there are no timers
+	if (vm->timerHeap==NULL)
+		return;
+
+	time = dj_timer_getTimeMillis();
+
+	dj_monitor *monitor;
+
+	while ((thread=vm->timerHeap)!=NULL && thread->scheduleTime<=time)
+	{
+		// a thread whose wait timed out has to get the monitor back before it can run
+		if ((thread->status==THREADSTATUS_WAITING_FOR_MONITOR) &&
+				((monitor=dj_vm_findMonitor(vm, thread->monitorObject))!=NULL))
+			dj_scheduler_wakeWaiter(vm, monitor, thread);
+		else
+			dj_scheduler_makeReady(vm, thread);
+	}
+}
+
+/**
+ * @param vm the virtual machine context
+ * @return the time of the earliest timeout, or -1 if no thread is sleeping or in a timed wait
+ */
+dj_time_t dj_scheduler_getNextTimeout(dj_vm *vm)
+{
+	return (vm->timerHeap==NULL) ? -1 : vm->timerHeap->scheduleTime;
+}
+
+/**
+ * Appends a thread to a monitor queue. Monitor queues are circular lists linked through queueNext, of which only the
+ * tail is stored, so that both the head and the tail can be reached in constant time.
+ * @param tail the tail of the queue
+ * @param thread the thread to append
+ */
+static void dj_scheduler_append(dj_thread **tail, dj_thread *thread)
+{
+	if (*tail==NULL)
+	{
+		thread->queueNext = thread;
+	} else
+	{
+		thread->queueNext = (*tail)->queueNext;
+		(*tail)->queueNext = thread;
+	}
+	*tail = thread;
+}
+
+/**
+ * Takes the thread at the head of a monitor queue.
+ * @param tail the tail of the queue
+ * @return the first thread in the queue, or NULL if the queue is empty
+ */
+static dj_thread *dj_scheduler_takeFirst(dj_thread **tail)
+{
+	dj_thread *head;
+
+	if (*tail==NULL)
+		return NULL;
+
+	head = (*tail)->queueNext;
+	if (head==*tail)
+		*tail = NULL;
+	else
+		(*tail)->queueNext = head->queueNext;
+
+	head->queueNext = NULL;
+	return head;
+}
+
+/**
+ * Removes a thread from the middle of a monitor queue. This is only needed when a timed wait expires or a thread is
+ * killed, so a linear search is fine here.
+ * @param tail the tail of the queue
+ * @param thread the thread to remove
+ * @return whether the thread was found in the queue
+ */
+static bool dj_scheduler_removeFrom(dj_thread **tail, dj_thread *thread)
+{
+	dj_thread *pre = *tail;
+
+	if (pre==NULL)
+		return false;
+
+	while (pre->queueNext!=thread)
+	{
+		pre = pre->queueNext;
+		if (pre==*tail)
+			return false;
+	}
+
+	pre->queueNext = thread->queueNext;
+	if (thread==*tail)
+		*tail = (pre==thread) ? NULL : pre;
+
+	thread->queueNext = NULL;
+	return true;
+}
+
+/**
+ * Adds a thread to the tail of the entry queue of a monitor. The thread will get the monitor with a count of one.
+ * @param monitor the monitor
+ * @param thread the blocked thread
+ */
+void dj_scheduler_block(dj_monitor *monitor, dj_thread *thread)
+{
+	thread->monitorCount = 1;
+	dj_scheduler_append(&monitor->blocked, thread);
+}
+
+/**
+ * Removes a thread from the entry or wait queue of a monitor.
+ * @param monitor the monitor
+ * @param thread the thread to remove
+ */
+void dj_scheduler_unblock(dj_monitor *monitor, dj_thread *thread)
+{
+	if (dj_scheduler_removeFrom(&monitor->blocked, thread) || dj_scheduler_removeFrom(&monitor->waiting, thread))
+		monitor->waiting_threads--;
+}
+
+/**
+ * Called when a monitor has been released (its count dropped to zero). If any threads are blocked on the monitor,
+ * the monitor is handed to the one that has been blocked longest, with the count it had when it blocked or started
+ * waiting, and that thread is made ready.
+ * @param vm the virtual machine context
+ * @param monitor the monitor that was released
+ */
+void dj_scheduler_releaseMonitor(dj_vm *vm, dj_monitor *monitor)
+{
+	dj_thread *thread = dj_scheduler_takeFirst(&monitor->blocked);
+
+	if (thread==NULL)
+		return;
+
+	monitor->waiting_threads--;
+	monitor->count = thread->monitorCount;
+	monitor->owner = thread;
+	thread->monitorObject = NULL;
+
+	DEBUG_LOG(DBG_DARJEELING, "Handing monitor %p to thread %d\n", monitor, thread->id);
+
+	dj_scheduler_makeReady(vm, thread);
+}
+
+/**
+ * Makes the owner of a monitor wait on it. The thread releases the monitor, remembering its count, and is added to
+ * the tail of the wait queue. The caller sets the thread's status and timeout.
+ * @param vm the virtual machine context
+ * @param monitor the monitor, owned by the thread
+ * @param thread the thread that waits
+ */
+void dj_scheduler_wait(dj_vm *vm, dj_monitor *monitor, dj_thread *thread)
+{
+	thread->monitorCount = monitor->count;
+	dj_scheduler_append(&monitor->waiting, thread);
+	monitor->waiting_threads++;
+
+	monitor->count = 0;
+	monitor->owner = NULL;
+	dj_scheduler_releaseMonitor(vm, monitor);
+}
+
+/**
+ * Moves a thread from the wait queue of a monitor to the tail of its entry queue, because it was notified or its
+ * timeout expired. If the monitor is free the thread gets it right away.
+ * @param vm the virtual machine context
+ * @param monitor the monitor
+ * @param thread the waiting thread
+ */
+void dj_scheduler_wakeWaiter(dj_vm *vm, dj_monitor *monitor, dj_thread *thread)
+{
+	dj_scheduler_removeFrom(&monitor->waiting, thread);
+	dj_scheduler_removeTimer(vm, thread);
+
+	thread->status = THREADSTATUS_BLOCKED_FOR_MONITOR;
+	dj_scheduler_append(&monitor->blocked, thread);
+
+	if (monitor->owner==NULL)
+		dj_scheduler_releaseMonitor(vm, monitor);
+}
+
+/**
+ * Wakes the thread that has been waiting on a monitor longest, or all of them.
+ * @param vm the virtual machine context
+ * @param monitor the monitor
+ * @param all whether to wake all waiting threads
+ */
+void dj_scheduler_notify(dj_vm *vm, dj_monitor *monitor, bool all)
+{
+	dj_thread *thread;
+
+	while (monitor->waiting!=NULL)
+	{
+		thread = monitor->waiting->queueNext;
+		dj_scheduler_wakeWaiter(vm, monitor, thread);
+		if (!all) return;
+	}
+}
+
+/**
+ * Removes a thread from the ready queue and the timer heap. Used when a thread is killed or removed from the
+ * virtual machine. Threads that are queued on a monitor have to be removed with dj_scheduler_unblock.
+ * @param vm the virtual machine context
+ * @param thread the thread to remove
+ */
+void dj_scheduler_unschedule(dj_vm *vm, dj_thread *thread)
+{
+	if (thread->queued & DJ_THREAD_QUEUED_READY)
+		dj_scheduler_removeReady(vm, thread);
+
+	if (thread->queued & DJ_THREAD_QUEUED_TIMER)
+		dj_scheduler_removeTimer(vm, thread);
+}
+
+/**
+ * Calculates the number of instructions the current thread may execute before the next scheduling decision. When
+ * there are no other ready threads, a long quantum avoids needless scheduling. With more ready threads, the quantum
+ * is divided between them to keep the time before every thread gets a turn roughly constant.
+ * @param vm the virtual machine context
+ * @return the quantum to pass to dj_exec_run
+ */
+int dj_scheduler_getQuantum(dj_vm *vm)
+{
+	int quantum;
+
+	if (vm->nrReady==0)
+		return SCHEDULER_QUANTUM_MAX;
+
+	quantum = SCHEDULER_QUANTUM_MAX / (vm->nrReady + 1);
+	return (quantum<SCHEDULER_QUANTUM_MIN) ? SCHEDULER_QUANTUM_MIN : quantum;
+}
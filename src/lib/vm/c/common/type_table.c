@@ -0,0 +1,227 @@
+/*
+ * type_table.c
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Supertype displays and interface bitsets.
+ *
+ * Without these, INSTANCEOF, CHECKCAST and exception dispatch walk the superclass chain of the tested class, and for
+ * interfaces scan the interface list of every class on the way, resolving ids at each step. When VM_TYPE_DISPLAYS is
+ * defined, the ancestors of every class are stored as an array indexed on depth in the hierarchy (its display), so
+ * testing for a superclass is a single comparison at the depth of the superclass. Every class that is implemented by
+ * another class gets a bit, and every class gets a bitset of the interfaces it implements, directly, through its
+ * superclasses or through superinterfaces.
+ *
+ * The table is rebuilt whenever infusions are loaded or unloaded and is kept in a single CHUNKID_TYPE_TABLE chunk
+ * referenced from the dj_vm struct. It only holds class indices, so it needs no pointer updates after compaction. If
+ * there is not enough memory to build it, type tests fall back to walking the hierarchy.
+ */
+
+#include <string.h>
+
+#include "type_table.h"
+#include "global_id.h"
+#include "infusion.h"
+#include "parse_infusion.h"
+#include "heap.h"
+#include "debug.h"
+
+#include "config.h"
+
+#ifdef VM_TYPE_DISPLAYS
+
+// the largest table that fits in a heap chunk, which depends on the width of the chunk size field (HEAP_32BIT)
+#define TYPE_TABLE_MAX_SIZE (HEAP_MAX_CHUNK_SIZE - sizeof(heap_chunk))
+
+/**
+ * Counts the number of superclasses between a class and java.lang.Object.
+ * @param classId the class
+ * @return the depth of the class in the class hierarchy, 0 for java.lang.Object
+ */
+static uint8_t dj_type_table_getDepth(dj_global_id classId)
+{
+	uint8_t ret = 0;
+
+	while (!dj_global_id_isJavaLangObject(classId))
+	{
+		classId = dj_global_id_resolve(classId.infusion,
+				dj_di_classDefinition_getSuperClass(dj_global_id_getClassDefinition(classId)));
+		ret++;
+	}
+
+	return ret;
+}
+
+/**
+ * Fills in the display and interface bitset of a class. The superclass and the implemented interfaces are filled in
+ * first, so their displays and bitsets can be copied.
+ * @param typeTable the type table
+ * @param classId the class to add
+ * @param nextDisplay offset of the first free byte in the display area
+ */
+static void dj_type_table_addClass(dj_type_table *typeTable, dj_global_id classId, uint16_t *nextDisplay)
+{
+	int i, j;
+	uint8_t index = dj_global_id_getRuntimeClassId(classId) - CHUNKID_JAVA_START;
+	uint8_t parentIndex, interfaceIndex;
+	dj_type_table_entry *entry = &typeTable->entries[index], *parentEntry, *interfaceEntry;
+	uint8_t *displays = dj_type_table_getDisplays(typeTable);
+	uint8_t *bitsets = dj_type_table_getBitsets(typeTable);
+	uint8_t *bitset = bitsets + index * typeTable->bitset_size;
+	dj_di_pointer classDef;
+	dj_global_id parent, interface;
+
+	// already done
+	if (entry->depth!=0xff)
+		return;
+
+	classDef = dj_global_id_getClassDefinition(classId);
+
+	if (dj_global_id_isJavaLangObject(classId))
+	{
+		entry->depth = 0;
+		entry->display = *nextDisplay;
+	} else {
+		// inherit the display and interfaces of the superclass
+		parent = dj_global_id_resolve(classId.infusion, dj_di_classDefinition_getSuperClass(classDef));
+		dj_type_table_addClass(typeTable, parent, nextDisplay);
+
+		parentIndex = dj_global_id_getRuntimeClassId(parent) - CHUNKID_JAVA_START;
+		parentEntry = &typeTable->entries[parentIndex];
+
+		entry->depth = parentEntry->depth + 1;
+		entry->display = *nextDisplay;
+		memcpy(displays + entry->display, displays + parentEntry->display, entry->depth);
+		memcpy(bitset, bitsets + parentIndex * typeTable->bitset_size, typeTable->bitset_size);
+	}
+
+	displays[entry->display + entry->depth] = index;
+	*nextDisplay += entry->depth + 1;
+
+	// add the interfaces implemented by this class and their superinterfaces
+	for (i=0; i<dj_di_classDefinition_getNrInterfaces(classDef); i++)
+	{
+		interface = dj_global_id_resolve(classId.infusion, dj_di_classDefinition_getInterface(classDef, i));
+		dj_type_table_addClass(typeTable, interface, nextDisplay);
+
+		interfaceIndex = dj_global_id_getRuntimeClassId(interface) - CHUNKID_JAVA_START;
+		interfaceEntry = &typeTable->entries[interfaceIndex];
+
+		if (interfaceEntry->interface_index==0xff)
+			interfaceEntry->interface_index = typeTable->nr_interfaces++;
+
+		bitset[interfaceEntry->interface_index>>3] |= 1<<(interfaceEntry->interface_index&7);
+		for (j=0; j<typeTable->bitset_size; j++)
+			bitset[j] |= bitsets[interfaceIndex * typeTable->bitset_size + j];
+	}
+}
+
+/**
+ * (Re)builds the type table for all loaded infusions. Must be called whenever the set of loaded infusions changes,
+ * since the table is indexed on runtime class ids. If there is not enough memory, vm->typeTable is left NULL and type
+ * tests fall back to walking the class hierarchy.
+ * @param vm the virtual machine context
+ */
+void dj_type_table_build(dj_vm *vm)
+{
+	int i;
+	uint16_t nr_classes = 0, nr_listed = 0, nextDisplay;
+	uint8_t bitset_size;
+	uint32_t display_size = 0, size;
+	dj_infusion *infusion;
+	dj_global_id classId;
+	dj_type_table *typeTable;
+
+	// release the old table
+	if (vm->typeTable!=NULL)
+	{
+		dj_mem_free(vm->typeTable);
+		vm->typeTable = NULL;
+	}
+
+	// count classes, display entries, and an upper bound on the number of implemented interfaces
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		classId.infusion = infusion;
+		for (i=0; i<dj_di_parentElement_getListSize(infusion->classList); i++)
+		{
+			classId.entity_id = i;
+			display_size += dj_type_table_getDepth(classId) + 1;
+			nr_listed += dj_di_classDefinition_getNrInterfaces(dj_global_id_getClassDefinition(classId));
+			nr_classes++;
+		}
+	}
+
+	if (nr_listed>nr_classes)
+		nr_listed = nr_classes;
+	bitset_size = (nr_listed + 7) >> 3;
+
+	size = sizeof(dj_type_table)
+		+ nr_classes * sizeof(dj_type_table_entry)
+		+ display_size
+		+ nr_classes * bitset_size;
+
+	// display offsets are 16 bits
+	if (size>TYPE_TABLE_MAX_SIZE || display_size>UINT16_MAX)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "type table: %d bytes needed, too large for a single chunk\n", (int)size);
+		return;
+	}
+
+	// allocating may trigger a collection, which moves the VM and the infusions around
+	dj_mem_addSafePointer((void**)&vm);
+	typeTable = (dj_type_table*)dj_mem_alloc(size, CHUNKID_TYPE_TABLE);
+	dj_mem_removeSafePointer((void**)&vm);
+
+	if (typeTable==NULL)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "type table: not enough memory, using hierarchy walking\n");
+		return;
+	}
+
+	typeTable->nr_classes = nr_classes;
+	typeTable->display_size = display_size;
+	typeTable->nr_interfaces = 0;
+	typeTable->bitset_size = bitset_size;
+
+	for (i=0; i<nr_classes; i++)
+	{
+		typeTable->entries[i].depth = 0xff;
+		typeTable->entries[i].interface_index = 0xff;
+	}
+	memset(dj_type_table_getBitsets(typeTable), 0, nr_classes * bitset_size);
+
+	nextDisplay = 0;
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		classId.infusion = infusion;
+		for (i=0; i<dj_di_parentElement_getListSize(infusion->classList); i++)
+		{
+			classId.entity_id = i;
+			dj_type_table_addClass(typeTable, classId, &nextDisplay);
+		}
+	}
+
+	DEBUG_LOG(DBG_DARJEELING, "type table: %d classes, %d interfaces\n", typeTable->nr_classes, typeTable->nr_interfaces);
+
+	vm->typeTable = typeTable;
+}
+
+#endif
@@ -31,6 +31,12 @@
 #include "djarchive.h"
 #include "core.h"
 #include "vm_gc.h"
+#include "vtable.h"
+#include "type_table.h"
+#include "alloc_profiler.h"
+#include "opcode_profiler.h"
+#include "jstring.h"
+#include "scheduler.h"
 #include "jlib_base.h"
 #include "config.h"
 #ifndef HAS_WDT
@@ -44,6 +50,17 @@
  */
 
 
+/**
+ * Called by the main loop when no thread is ready to run. Waits until the first sleeping thread needs to wake up or,
+ * on platforms that support it, until I/O arrives, and then polls for I/O since that may make threads runnable.
+ * @param vm the virtual machine context
+ */
+static void dj_vm_idle(dj_vm *vm)
+{
+	dj_core_idle(dj_vm_getVMSleepTime(vm));
+	dj_hook_call(dj_core_pollingHook, NULL);
+}
+
 /**
  * Main function that creates the vm and runs until either all threads stop or runlevel is set to RUNLEVEL_REBOOT
  * This code was in the main() of each config before, but has been extracted to make rebooting easier.
@@ -77,18 +94,29 @@ void dj_vm_main(dj_di_pointer di_lib_infusions_archive_data,
 	DEBUG_LOG(true, "Darjeeling is go!\n\r");
 
 	// start the main execution loop
-	while (dj_vm_countLiveThreads(vm)>0)
+	while (dj_vm_hasLiveThreads(vm))
 	{
 		platform_wdt_reset();
 		dj_vm_schedule(vm);
-		if (vm->currentThread!=NULL)
-			if (vm->currentThread->status==THREADSTATUS_RUNNING)
-				dj_exec_run(RUNSIZE);
+		if ((vm->currentThread!=NULL) && (vm->currentThread->status==THREADSTATUS_RUNNING))
+			dj_exec_run(dj_scheduler_getQuantum(vm));
+		else
+			dj_vm_idle(vm);
 	}
 	DEBUG_LOG(true, "All threads terminated.\n\r");
+
+#ifdef GC_INCREMENTAL
+	dj_mem_printGCStats();
+#endif
+#ifdef ALLOC_PROFILER
+	dj_allocprof_dump();
+#endif
+#ifdef OPCODE_PROFILER
+	dj_opprof_dump();
+#endif
 }
 
-dj_vm *g_vm;
+DJ_VM_LOCAL dj_vm *g_vm;
 void dj_vm_main_init(dj_di_pointer di_lib_infusions_archive_data,
  				dj_di_pointer di_app_infusion_archive_data,
  				dj_named_native_handler handlers[],
@@ -120,11 +148,12 @@ void dj_vm_main_init(dj_di_pointer di_lib_infusions_archive_data,
 int dj_vm_loop()
 {
 	// start the main execution loop
-	if  (dj_vm_countLiveThreads(g_vm)>0) {
+	if  (dj_vm_hasLiveThreads(g_vm)) {
 		dj_vm_schedule(g_vm);
-		if (g_vm->currentThread!=NULL)
-			if (g_vm->currentThread->status==THREADSTATUS_RUNNING)
-				dj_exec_run(RUNSIZE);
+		if ((g_vm->currentThread!=NULL) && (g_vm->currentThread->status==THREADSTATUS_RUNNING))
+			dj_exec_run(dj_scheduler_getQuantum(g_vm));
+		else
+			dj_vm_idle(g_vm);
 		return 0;
 	}
 	return 1;
@@ -152,9 +181,26 @@ dj_vm * dj_vm_create()
 	ret->monitors = NULL;
 	ret->numMonitors = 0;
 
+	// nothing to schedule
+	ret->readyHead = NULL;
+	ret->readyTail = NULL;
+	ret->timerHeap = NULL;
+	ret->nrReady = 0;
+
 	// no system infusion loaded
 	ret->systemInfusion = NULL;
 
+	// no classes
+	ret->classTable = NULL;
+
+#ifdef VM_FLATTENED_VTABLES
+	ret->vtables = NULL;
+#endif
+
+#ifdef VM_TYPE_DISPLAYS
+	ret->typeTable = NULL;
+#endif
+
 	return ret;
 }
 
@@ -371,6 +417,19 @@ dj_infusion *dj_vm_loadInfusion(dj_vm *vm, dj_di_pointer di, dj_named_native_han
 	if (vm->systemInfusion == NULL)
 		vm->systemInfusion = infusion;
 
+	// rebuild the class lookup tables before any code in the new infusion runs
+	dj_mem_addSafePointer((void**)&vm);
+	dj_mem_addSafePointer((void**)&infusion);
+	dj_vm_buildClassTable(vm);
+#ifdef VM_FLATTENED_VTABLES
+	dj_vtables_build(vm);
+#endif
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table_build(vm);
+#endif
+	dj_mem_removeSafePointer((void**)&infusion);
+	dj_mem_removeSafePointer((void**)&vm);
+
 	// This code was originally in load dj_vm_loadInfusionArchive.
 	// Moved here because the application is not in an archive, but needs
 	// some of the same code (not native_handlers, but class initialisers
@@ -470,6 +529,7 @@ void dj_vm_unloadInfusion(dj_vm *vm, dj_infusion * unloadInfusion)
 			if (frame->method.infusion==unloadInfusion)
 			{
 				// kill the thread
+				dj_vm_unscheduleThread(vm, thread);
 				thread->status = THREADSTATUS_FINISHED;
 
 				break;
@@ -481,9 +541,18 @@ void dj_vm_unloadInfusion(dj_vm *vm, dj_infusion * unloadInfusion)
 		thread = thread->next;
 	}
 
+	// remove the threads that were killed, except the current one which is removed by dj_vm_schedule
+	dj_vm_checkFinishedThreads(vm);
+
 	// shift runtime IDs
 	dj_mem_shiftRuntimeIDs(unloadInfusion->class_base, dj_di_parentElement_getListSize(unloadInfusion->classList));
 
+	// cached call targets and static fields refer to the old runtime IDs and possibly to the unloaded infusion
+	dj_exec_flushCaches();
+#ifdef VM_INTERN_STRINGS
+	dj_jstring_removeInternedInfusion(unloadInfusion);
+#endif
+
 	// update other infusions
 	infusion = vm->infusions;
 	while (infusion!=NULL)
@@ -508,6 +577,17 @@ void dj_vm_unloadInfusion(dj_vm *vm, dj_infusion * unloadInfusion)
 		prev->next = unloadInfusion->next;
 	}
 
+	// the class lookup tables are indexed on runtime IDs, which have just been shifted
+	dj_mem_addSafePointer((void**)&vm);
+	dj_vm_buildClassTable(vm);
+#ifdef VM_FLATTENED_VTABLES
+	dj_vtables_build(vm);
+#endif
+#ifdef VM_TYPE_DISPLAYS
+	dj_type_table_build(vm);
+#endif
+	dj_mem_removeSafePointer((void**)&vm);
+
 }
 
 /**
@@ -597,6 +677,10 @@ void dj_vm_addThread(dj_vm *vm, dj_thread *thread)
 
 	// The new thread is the last element so its next should be NULL.
 	thread->next = NULL;
+
+	// threads that were created with a frame to run can be scheduled right away
+	if (thread->status==THREADSTATUS_RUNNING)
+		dj_scheduler_enqueue(vm, thread);
 }
 
 /**
@@ -606,6 +690,7 @@ void dj_vm_addThread(dj_vm *vm, dj_thread *thread)
  */
 void dj_vm_removeThread(dj_vm *vm, dj_thread *thread)
 {
+	dj_vm_unscheduleThread(vm, thread);
 
 	if (vm->threads==thread)
 	{
@@ -641,82 +726,63 @@ int dj_vm_countThreads(dj_vm *vm)
 }
 
 /**
- * Wakes threads that are sleeping or blocked.
+ * Removes a thread from whatever scheduler queue it is in, so that it can be killed or removed.
  * @param vm the virtual machine context
+ * @param thread the thread to remove
  */
-void dj_vm_wakeThreads(dj_vm *vm)
+void dj_vm_unscheduleThread(dj_vm *vm, dj_thread *thread)
 {
-	dj_thread *thread = vm->threads;
-	dj_monitor * monitor;
+	dj_monitor *monitor;
 
-	dj_time_t time = dj_timer_getTimeMillis();
+	dj_scheduler_unschedule(vm, thread);
 
-	while (thread!=NULL)
+	if ((thread->status==THREADSTATUS_BLOCKED_FOR_MONITOR)||(thread->status==THREADSTATUS_WAITING_FOR_MONITOR))
 	{
-		// wake sleeping threads
-		if (thread->status==THREADSTATUS_SLEEPING)
-			if (thread->scheduleTime <= time)
-				thread->status=THREADSTATUS_RUNNING;
-
-		// wake waiting threads that timed out
-		if (thread->status==THREADSTATUS_WAITING_FOR_MONITOR)
-			if ((thread->scheduleTime!=0)&&((int32_t)thread->scheduleTime <= (int32_t)time))
-			{
-				thread->status=THREADSTATUS_RUNNING;
-				thread->monitorObject=NULL;
-			}
-
-		// wake blocked threads
-		if (thread->status==THREADSTATUS_BLOCKED_FOR_MONITOR)
+		// the monitor exists as long as threads are queued on it
+		monitor = dj_vm_findMonitor(vm, thread->monitorObject);
+		if (monitor!=NULL)
 		{
-			monitor = dj_vm_getMonitor(vm, thread->monitorObject);
-			if (monitor->count==0)
-			{
-				monitor->waiting_threads--;
-
-				monitor->count = 1;
-				monitor->owner = thread;
-
-				thread->status = THREADSTATUS_RUNNING;
-			}
-
+			dj_scheduler_unblock(monitor, thread);
+			if ((monitor->count==0)&&(monitor->waiting_threads==0))
+				dj_vm_removeMonitor(vm, monitor);
 		}
-
-		thread = thread->next;
 	}
+}
 
+/**
+ * Wakes threads that are sleeping or waiting with a timeout that has expired. Threads that are blocked on a monitor
+ * are woken when the monitor is released, see dj_scheduler_releaseMonitor.
+ * @param vm the virtual machine context
+ */
+void dj_vm_wakeThreads(dj_vm *vm)
+{
+	dj_scheduler_wakeExpired(vm);
 }
 
 /**
- * Notifes one or more threads waiting for a lock.
+ * Notifes one or more threads waiting for a lock. Notified threads are moved from the wait queue of the object's
+ * monitor to its entry queue in the order in which they started waiting, and run once they get the monitor back.
  * @param vm the virtual machine context
  * @param object the lock object
  * @param all whether or not to wake all threads waiting for this lock, or just one
+ * @return false if the current thread doesn't own the object's monitor
  */
-void dj_vm_notify(dj_vm *vm, dj_object *object, bool all)
+bool dj_vm_notify(dj_vm *vm, dj_object *object, bool all)
 {
-	dj_thread *thread = vm->threads;
-	dj_thread *next;
+	dj_monitor *monitor = dj_vm_findMonitor(vm, object);
 
-	while (thread != NULL)
-	{
-		next = thread->next;
+	if ((monitor==NULL)||(monitor->owner!=vm->currentThread))
+		return false;
 
-		if ((thread->status == THREADSTATUS_WAITING_FOR_MONITOR)&&
-			(thread->monitorObject==object))
-		{
-			thread->monitorObject = NULL;
-			thread->status = THREADSTATUS_RUNNING;
-			if (!all) return;
-		}
+	dj_scheduler_notify(vm, monitor, all);
 
-		thread = next;
-	}
+	return true;
 }
 
 /**
  * Checks for any threads that have reached the THREADSTATUS_FINISHED state, and removes them from
- * the virtual machine context.
+ * the virtual machine context. The current thread is skipped because it may still be executing a
+ * native method, it is removed by dj_vm_schedule when its time slice ends.
  * @param vm the virtual machine context
  */
 void dj_vm_checkFinishedThreads(dj_vm *vm)
@@ -726,10 +792,8 @@ void dj_vm_checkFinishedThreads(dj_vm *vm)
 
 	while (thread != NULL) {
 		next = thread->next;
-		if (thread->status == THREADSTATUS_FINISHED)
+		if ((thread->status == THREADSTATUS_FINISHED) && (thread != vm->currentThread))
 		{
-			if (vm->currentThread == thread)
-				vm->currentThread = NULL;
 			dj_vm_removeThread(vm, thread);
 			dj_thread_destroy(thread);
 		}
@@ -808,25 +872,45 @@ int dj_vm_countLiveThreads(dj_vm *vm)
 	return ret;
 }
 
-dj_time_t dj_vm_getVMSleepTime(dj_vm * vm)
+/**
+ * Checks if there are any live threads, as in dj_vm_countLiveThreads, but stops at the first one it finds. This
+ * is what the main loop uses to decide whether to keep running.
+ * @param vm the virtual machine context
+ */
+bool dj_vm_hasLiveThreads(dj_vm *vm)
 {
-	dj_time_t scheduleTime, time, ret=-1;
-	dj_thread *thread = vm->threads;
+	dj_thread *thread;
 
-	time = dj_timer_getTimeMillis();
+	if (vm->readyHead!=NULL)
+		return true;
 
-	while (thread!=NULL)
-	{
-		if (thread->status==THREADSTATUS_RUNNING) ret = 0;
+	for (thread=vm->threads; thread!=NULL; thread=thread->next)
+		if ( (thread->status!=THREADSTATUS_CREATED) &&
+				(thread->status!=THREADSTATUS_FINISHED) &&
+				(thread->status!=THREADSTATUS_UNHANDLED_EXCEPTION)
+				) return true;
 
-		if (thread->status==THREADSTATUS_SLEEPING)
-		{
-			scheduleTime = thread->scheduleTime - time;
-			if (scheduleTime<0) scheduleTime = 0;
-			if (ret==-1||ret>scheduleTime) ret = scheduleTime;
-		}
+	return false;
+}
 
-		thread = thread->next;
+/**
+ * Calculates how long the VM can sleep before a thread needs to run.
+ * @param vm the virtual machine context
+ * @return 0 if a thread is ready to run, the number of milliseconds until the first timeout expires, or -1 if no
+ * thread will become ready by itself
+ */
+dj_time_t dj_vm_getVMSleepTime(dj_vm * vm)
+{
+	dj_time_t ret;
+
+	if (vm->readyHead!=NULL || (vm->currentThread!=NULL && vm->currentThread->status==THREADSTATUS_RUNNING))
+		return 0;
+
+	ret = dj_scheduler_getNextTimeout(vm);
+	if (ret!=-1)
+	{
+		ret -= dj_timer_getTimeMillis();
+		if (ret<0) ret = 0;
 	}
 
 	return ret;
@@ -835,43 +919,37 @@ dj_time_t dj_vm_getVMSleepTime(dj_vm * vm)
 
 /**
  * Wakes up any threads that need to be woken up and chooses the next thread to be started and
- * schedules it for execution. A simple round-robin scheme is used for thread selection.
+ * schedules it for execution. Threads are taken from the ready queue in round-robin order: a thread
+ * that is still runnable at the end of its time slice goes to the back of the queue.
  * @param vm the virtual machine context
  */
 char dj_vm_schedule(dj_vm *vm)
 {
-	int maxPriority;
-
-	dj_thread *thread, *selectedThread;
+	dj_thread *thread = vm->currentThread;
 
-	// prune finished threads
-	dj_vm_checkFinishedThreads(vm);
-
-	// wake up any threads that need to be woken up
-	dj_vm_wakeThreads(vm);
+#ifdef GC_INCREMENTAL
+	// do a bounded amount of garbage collection work between time slices
+	dj_mem_gcStep();
+#endif
 
-	// Simple round-robin scheduling algo:
-	// Select the thread with the highest priority and set its priority to zero, and
-	// increase the priorities of all other threads by one.
-	selectedThread = NULL;
-	thread = vm->threads;
-	maxPriority = -1;
-	while (thread!=NULL)
+	if (thread!=NULL)
 	{
-		if (thread->status==THREADSTATUS_RUNNING)
+		if (thread->status==THREADSTATUS_FINISHED)
 		{
-			thread->priority++;
-			if (maxPriority<thread->priority)
-			{
-				selectedThread=thread;
-				maxPriority=thread->priority;
-			}
+			// prune the finished thread
+			vm->currentThread = NULL;
+			dj_vm_removeThread(vm, thread);
+			dj_thread_destroy(thread);
+		} else if (thread->status==THREADSTATUS_RUNNING)
+		{
+			dj_scheduler_enqueue(vm, thread);
 		}
-		thread = thread->next;
 	}
 
-	char ret = dj_vm_activateThread(vm, selectedThread);
-	return ret;
+	// wake up any threads whose timeout expired
+	dj_vm_wakeThreads(vm);
+
+	return dj_vm_activateThread(vm, dj_scheduler_dequeue(vm));
 }
 
 /**
@@ -916,9 +994,42 @@ void dj_vm_mem_updatePointers(dj_vm *vm)
 	vm->monitors = dj_mem_getUpdatedPointer(vm->monitors);
 	vm->systemInfusion = dj_mem_getUpdatedPointer(vm->systemInfusion);
 	vm->threads = dj_mem_getUpdatedPointer(vm->threads);
+	vm->readyHead = dj_mem_getUpdatedPointer(vm->readyHead);
+	vm->readyTail = dj_mem_getUpdatedPointer(vm->readyTail);
+	vm->timerHeap = dj_mem_getUpdatedPointer(vm->timerHeap);
+	vm->classTable = dj_mem_getUpdatedPointer(vm->classTable);
+#ifdef VM_FLATTENED_VTABLES
+	vm->vtables = dj_mem_getUpdatedPointer(vm->vtables);
+#endif
+#ifdef VM_TYPE_DISPLAYS
+	vm->typeTable = dj_mem_getUpdatedPointer(vm->typeTable);
+#endif
 }
 
 
+/**
+ * Finds the monitor for the given object, without creating one.
+ * @param vm virtual machine context
+ * @param object object that acts as a lock
+ * @return the monitor, or NULL if the object has no monitor
+ */
+dj_monitor * dj_vm_findMonitor(dj_vm *vm, dj_object * object)
+{
+	uint16_t i, mask;
+	dj_monitor_table *table = vm->monitors;
+
+	if (table==NULL)
+		return NULL;
+
+	// search for the monitor along the object's probe sequence
+	mask = table->capacity - 1;
+	for (i=dj_monitor_table_hash(table, object); table->monitors[i].object!=NULL; i=(i+1)&mask)
+		if (table->monitors[i].object==object)
+			return &(table->monitors[i]);
+
+	return NULL;
+}
+
 /**
  * Finds a monitor for the given object. If no monitor exists, one is created.
  * @param vm virtual machine context
@@ -926,139 +1037,183 @@ void dj_vm_mem_updatePointers(dj_vm *vm)
  */
 dj_monitor * dj_vm_getMonitor(dj_vm *vm, dj_object * object)
 {
-	int i;
-	dj_monitor *monitor, *ret = NULL;
-	dj_monitor_block *block, *newBlock;
+	uint16_t i, mask;
+	dj_monitor_table *table, *newTable;
+	dj_monitor *monitor;
 
-	dj_mem_addSafePointer((void**)&object);
+	monitor = dj_vm_findMonitor(vm, object);
+	if (monitor!=NULL)
+		return monitor;
 
-	// search for the monitor
-	block = vm->monitors;
-	for (i=0; i<vm->numMonitors; i++)
+	// The monitor is not in the table yet. Grow the table first if this would make it more than 3/4 full.
+	table = vm->monitors;
+	if ((table==NULL)||((vm->numMonitors+1)*4 > table->capacity*3))
 	{
-		// check if the monitor applies to the given object
-		monitor = &(block->monitors[i%MONITOR_BLOCK_SIZE]);
+		dj_mem_addSafePointer((void**)&object);
+
+		// allocate the new table. This may trigger garbage collection, which moves and rehashes the old one
+		newTable = dj_monitor_table_create(table==NULL?MONITOR_TABLE_INITIAL_SIZE:table->capacity*2);
 
-		if (monitor->object==object)
+		dj_mem_removeSafePointer((void**)&object);
+
+		// check for out of memory and let the caller deal with it
+		if (newTable==NULL)
+			return NULL;
+
+		// move the existing monitors over and free the old table
+		table = vm->monitors;
+		if (table!=NULL)
 		{
-			ret = monitor;
-			break;
+			for (i=0; i<table->capacity; i++)
+				if (table->monitors[i].object!=NULL)
+					dj_monitor_table_insert(newTable, &(table->monitors[i]));
+			dj_mem_free(table);
 		}
 
-		// if we have reached the end of a block, move to the next one
-		if ((i%MONITOR_BLOCK_SIZE)==(MONITOR_BLOCK_SIZE-1))
-			block = block->next;
+		vm->monitors = table = newTable;
 	}
 
-	// If the monitor is not yet in the monitor list, add the monitor to the end of the list.
-	if (ret==NULL)
-	{
+	// Create a new monitor and add it to the table.
+	// reset the monitor to count=0, waiting_threads=0
+	mask = table->capacity - 1;
+	for (i=dj_monitor_table_hash(table, object); table->monitors[i].object!=NULL; i=(i+1)&mask);
+	monitor = &(table->monitors[i]);
+	monitor->count = 0;
+	monitor->waiting_threads = 0;
+	monitor->object = object;
+	monitor->owner = NULL;
+	monitor->blocked = NULL;
+	monitor->waiting = NULL;
+	monitor->rehashed = 0;
+	vm->numMonitors++;
+
+	return monitor;
+}
 
-		// check if we need to add a new block
-		if ((vm->numMonitors%MONITOR_BLOCK_SIZE)==0)
-		{
-			// allocate a new monitor block
-			newBlock = dj_monitor_block_create();
+/**
+ * Removes a monitor from the monitor table. The monitors that follow it on the same probe sequence are shifted back
+ * to close the gap, so this invalidates pointers to other monitors. The table itself is kept, even when it becomes
+ * empty, to avoid reallocating it each time a lock is taken.
+ * @param vm virtual machine context
+ * @param monitor the monitor to remove
+ */
+void dj_vm_removeMonitor(dj_vm *vm, dj_monitor * monitor)
+{
+	dj_monitor_table *table = vm->monitors;
+	uint16_t i, j, home, mask = table->capacity - 1;
 
-			// check for out of memory and let the caller deal with it
-			if (newBlock==NULL) {
-				dj_mem_removeSafePointer((void**)&object);
-				return NULL;
-			}
+	i = monitor - table->monitors;
+	table->monitors[i].object = NULL;
+	vm->numMonitors--;
 
-			// find the last block (do this after the allocation to make sure everything goes right
-			// in case the allocation triggers garbage collection)
-			for (block=vm->monitors; (block!=NULL)&&(block->next!=NULL); block=block->next);
-
-			// add the new monitor to the virtual machine
-			if (vm->monitors==NULL)
-				vm->monitors = newBlock;
-			else
-				block->next = newBlock;
-
-			block = newBlock;
-		} else
-			// find last block
-			for (block=vm->monitors; (block!=NULL)&&(block->next!=NULL); block=block->next);
-
-		// Create a new monitor and add it to the list.
-		// note that vm->monitors acts like a stack, so vm->monitors points to the
-		// block that was added last
-		ret = &(block->monitors[vm->numMonitors%MONITOR_BLOCK_SIZE]);
-
-		// reset the monitor to count=0, waiting_threads=0
-		ret->count = 0;
-		ret->waiting_threads = 0;
-		ret->object = object;
-		ret->owner = NULL;
-		vm->numMonitors++;
-		block->count++;
+	// backward shift deletion: move every monitor in the following cluster that may be stored in the freed slot
+	for (j=(i+1)&mask; table->monitors[j].object!=NULL; j=(j+1)&mask)
+	{
+		home = dj_monitor_table_hash(table, table->monitors[j].object);
 
+		// the monitor at j can move to i only if its home slot doesn't lie cyclically in (i, j]
+		if (((j-home)&mask) >= ((j-i)&mask))
+		{
+			table->monitors[i] = table->monitors[j];
+			table->monitors[j].object = NULL;
+			i = j;
+		}
 	}
+}
 
-	dj_mem_removeSafePointer((void**)&object);
-
-	return ret;
+/**
+ * Returns the infusion index array that follows the infusion pointers in a class table.
+ * @param classTable the class table
+ */
+static inline uint8_t * dj_vm_getClassTableIndex(dj_class_table *classTable)
+{
+	return (uint8_t*)((size_t)classTable + sizeof(dj_class_table) + classTable->nr_infusions * sizeof(dj_infusion*));
 }
 
-void dj_vm_removeMonitor(dj_vm *vm, dj_monitor * monitor)
+/**
+ * (Re)builds the table that maps runtime class ids to infusions. Must be called whenever infusions are loaded or
+ * unloaded, since that assigns or shifts runtime class ids. If there is not enough memory, vm->classTable is left
+ * NULL and dj_vm_getRuntimeClass falls back to scanning the infusion list.
+ * @param vm the virtual machine context
+ */
+void dj_vm_buildClassTable(dj_vm *vm)
 {
 	int i;
-	dj_monitor_block *block, *lastBlock;
+	uint8_t nr_infusions = 0;
+	uint16_t nr_classes = 0, id;
+	dj_infusion *infusion;
+	dj_class_table *classTable;
+	uint8_t *index;
 
-	// search for the monitor
-	block = vm->monitors;
-	for (i=0; i<vm->numMonitors; i++)
+	// release the old table. Allocating the new one may trigger a collection, which then
+	// uses the fallback path
+	if (vm->classTable!=NULL)
 	{
-		if (&(block->monitors[i%MONITOR_BLOCK_SIZE])==monitor) break;
-
-		// if we have reached the end of a block, move to the next one
-		if ((i%MONITOR_BLOCK_SIZE)==(MONITOR_BLOCK_SIZE-1))
-			block = block->next;
+		dj_mem_free(vm->classTable);
+		vm->classTable = NULL;
 	}
 
-	// find the last block
-	for (lastBlock=vm->monitors; (lastBlock!=NULL)&&(lastBlock->next!=NULL); lastBlock=lastBlock->next);
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		nr_infusions++;
+		nr_classes += dj_di_parentElement_getListSize(infusion->classList);
+	}
 
-	// reduce the monitor count
-	vm->numMonitors--;
-	lastBlock->count--;
+	dj_mem_addSafePointer((void**)&vm);
+	classTable = (dj_class_table*)dj_mem_alloc(sizeof(dj_class_table) + nr_infusions * sizeof(dj_infusion*) + nr_classes, CHUNKID_CLASS_TABLE);
+	dj_mem_removeSafePointer((void**)&vm);
 
-	if (i<vm->numMonitors)
+	if (classTable==NULL)
 	{
-		// remove the monitor by replacing it with the last monitor in the linked list
-		block->monitors[i%MONITOR_BLOCK_SIZE] = lastBlock->monitors[vm->numMonitors%MONITOR_BLOCK_SIZE];
+		DEBUG_LOG(DBG_DARJEELING, "dj_vm_buildClassTable: not enough memory, using infusion list scanning\n");
+		return;
 	}
 
-	// check if we need to dealloc the last block
-	if (vm->numMonitors%MONITOR_BLOCK_SIZE==0)
-	{
-		if (vm->numMonitors>0)
-		{
-			// find the block that comes just before the last block
-			for (block=vm->monitors; (block!=lastBlock)&&(block->next!=lastBlock); block=block->next);
-			// set its next pointer to NULL
-			block->next = NULL;
-		} else
-		{
-			vm->monitors = NULL;
-		}
+	classTable->nr_infusions = nr_infusions;
+	classTable->nr_classes = nr_classes;
+	index = dj_vm_getClassTableIndex(classTable);
 
-		// free the last block
-		dj_mem_free(lastBlock);
+	i = 0;
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		classTable->infusions[i] = infusion;
+		for (id=0; id<dj_di_parentElement_getListSize(infusion->classList); id++)
+			index[infusion->class_base - CHUNKID_JAVA_START + id] = i;
+		i++;
 	}
 
+	vm->classTable = classTable;
 }
 
+/**
+ * Updates the infusion pointers held by the class table after compaction.
+ * @param classTable the class table
+ */
+void dj_vm_classTable_updatePointers(dj_class_table *classTable)
+{
+	int i;
+
+	for (i=0; i<classTable->nr_infusions; i++)
+		classTable->infusions[i] = dj_mem_getUpdatedPointer(classTable->infusions[i]);
+}
 
 inline dj_global_id dj_vm_getRuntimeClass(dj_vm *vm, runtime_id_t id)
 {
 	dj_global_id ret;
 	dj_infusion *infusion = vm->infusions;
+	dj_class_table *classTable = vm->classTable;
 	runtime_id_t base = 0;
 
-	// TODO: optimize this! (binary search?)
-	// TODO: test for multiple loaded infusions
+	// look the class up in the class table
+	if (classTable!=NULL && id>=CHUNKID_JAVA_START && id<CHUNKID_JAVA_START + classTable->nr_classes)
+	{
+		ret.infusion = classTable->infusions[dj_vm_getClassTableIndex(classTable)[id - CHUNKID_JAVA_START]];
+		ret.entity_id = id - ret.infusion->class_base;
+
+		return ret;
+	}
+
+	// no class table (out of memory), scan the infusion list
 	while (infusion!=NULL)
 	{
 		base = infusion->class_base;
@@ -1143,7 +1298,8 @@ dj_infusion* dj_vm_runClassInitialisers(dj_vm *vm, dj_infusion *infusion)
 		{
 			// create a frame to run the initialiser in
 			methodImplId.infusion = infusion;
-			frame = dj_frame_create(methodImplId);
+			thread = dj_vm_getThreadById(dj_exec_getVM(), threadId);
+			frame = dj_thread_createFrame(thread, methodImplId);
 
 			// if we're out of memory, panic
 		    if (frame==NULL)
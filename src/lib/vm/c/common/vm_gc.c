@@ -12,9 +12,11 @@
 #include "array.h"
 #include "execution.h"
 #include "jlib_base.h"
+#include "vtable.h"
+#include "jstring.h"
 
 
-static dj_object *panicExceptionObject = NULL;
+static DJ_VM_LOCAL dj_object *panicExceptionObject = NULL;
 
 static inline void vm_mem_updateManagedReference(dj_vm * vm, heap_chunk *chunk)
 {
@@ -56,14 +58,24 @@ static inline void vm_mem_updateSystemReference(heap_chunk *chunk)
 			dj_thread_updatePointers((dj_thread*)dj_mem_getData(chunk));
 			break;
 
-		case CHUNKID_MONITOR_BLOCK:
-			dj_monitor_block_updatePointers((dj_monitor_block*)dj_mem_getData(chunk));
+		case CHUNKID_MONITOR_TABLE:
+			dj_monitor_table_updatePointers((dj_monitor_table*)dj_mem_getData(chunk));
 			break;
 
 		case CHUNKID_FRAME:
 			dj_frame_updatePointers((dj_frame*)dj_mem_getData(chunk));
 			break;
 
+		case CHUNKID_CLASS_TABLE:
+			dj_vm_classTable_updatePointers((dj_class_table*)dj_mem_getData(chunk));
+			break;
+
+#ifdef VM_FLATTENED_VTABLES
+		case CHUNKID_VTABLES:
+			dj_vtables_updatePointers((dj_vtables*)dj_mem_getData(chunk));
+			break;
+#endif
+
 		default:
 			break;
 
@@ -101,6 +113,11 @@ void vm_mem_preGC() { // This is called from vm_mem_markRootSet, which is early
 		dj_exec_deactivateThread(thread);
 }
 void vm_mem_postGC(void *data) { // This is called by the GC's dj_mem_postGCHook
+#ifdef VM_INTERN_STRINGS
+	// interned strings are held weakly
+	dj_jstring_removeCollectedInterned();
+#endif
+
 	dj_thread * thread = dj_exec_getCurrentThread();
 	if (thread && thread->frameStack)
 		dj_exec_activate_thread(thread);
@@ -117,7 +134,6 @@ void vm_mem_markRootSet(void *data)
 	dj_vm *vm = dj_exec_getVM();
 	dj_thread * thread;
 	dj_infusion * infusion;
-	dj_monitor_block * monitorBlock;
 
 	vm_mem_preGC();
 
@@ -143,13 +159,22 @@ void vm_mem_markRootSet(void *data)
 
 	DEBUG_LOG(DBG_DARJEELING, "\t\tmark monitors\n");
 
-	// Mark monitor blocks
-	monitorBlock = vm->monitors;
-	while (monitorBlock!=NULL)
-	{
-		dj_monitor_markRootSet(monitorBlock);
-		monitorBlock = monitorBlock->next;
-	}
+	// Mark the monitor table
+	if (vm->monitors!=NULL)
+		dj_monitor_markRootSet(vm->monitors);
+
+	// mark the class table
+	dj_mem_setPointerGrayIfWhite(vm->classTable);
+
+#ifdef VM_FLATTENED_VTABLES
+	// mark the flattened method tables
+	dj_mem_setPointerGrayIfWhite(vm->vtables);
+#endif
+
+#ifdef VM_TYPE_DISPLAYS
+	// mark the type table
+	dj_mem_setPointerGrayIfWhite(vm->typeTable);
+#endif
 
 	// mark the panic exception object
 	if (panicExceptionObject!=nullref)
@@ -222,6 +247,10 @@ void vm_mem_updatePointers(void *data) {
 	// update the pointer to the panic exception object, if any
 	if (panicExceptionObject!=nullref)
 		panicExceptionObject = dj_mem_getUpdatedPointer(panicExceptionObject);
+
+#ifdef VM_INTERN_STRINGS
+	dj_jstring_updateInternedPointers();
+#endif
 }
 ////// End hooks from GC
 
@@ -249,12 +278,17 @@ void vm_mem_dumpMemUsage()
 		{
 			total = dj_mem_getChunkSize(thread) - (4 * 2);
 
+#ifdef THREAD_FRAME_STACK
+			if (thread->frameSegment!=NULL)
+				total += dj_mem_getChunkSize(thread->frameSegment);
+#else
 			frame = thread->frameStack;
 			while (frame!=NULL)
 			{
 				total += dj_mem_getChunkSize(frame) - (2 * 2);
 				frame = frame->parent;
 			}
+#endif
 
 		} else
 			total = 0;
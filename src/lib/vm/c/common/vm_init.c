@@ -1,11 +1,21 @@
 #include "hooks.h"
 #include "heap.h"
 #include "vm_gc.h"
+#include "core.h"
+#include "alloc_profiler.h"
+#include "opcode_profiler.h"
 
-dj_hook vm_markRootSetHook;
-dj_hook vm_markObjectHook;
-dj_hook vm_updatePointersHook;
-dj_hook vm_postGCHook;
+DJ_VM_LOCAL dj_hook vm_markRootSetHook;
+DJ_VM_LOCAL dj_hook vm_markObjectHook;
+DJ_VM_LOCAL dj_hook vm_updatePointersHook;
+DJ_VM_LOCAL dj_hook vm_postGCHook;
+#ifdef ALLOC_PROFILER
+DJ_VM_LOCAL dj_hook vm_allocHook;
+DJ_VM_LOCAL dj_hook vm_allocProfilerShutdownHook;
+#endif
+#ifdef OPCODE_PROFILER
+DJ_VM_LOCAL dj_hook vm_opcodeProfilerShutdownHook;
+#endif
 
 void vm_init() {
 	vm_markRootSetHook.function = vm_mem_markRootSet;
@@ -19,5 +29,18 @@ void vm_init() {
 
 	vm_postGCHook.function = vm_mem_postGC;
 	dj_hook_add(&dj_mem_postGCHook, &vm_postGCHook);
+
+#ifdef ALLOC_PROFILER
+	vm_allocHook.function = dj_allocprof_recordChunk;
+	dj_hook_add(&dj_mem_allocHook, &vm_allocHook);
+
+	vm_allocProfilerShutdownHook.function = dj_allocprof_shutdown;
+	dj_hook_add(&dj_core_shutdownHook, &vm_allocProfilerShutdownHook);
+#endif
+
+#ifdef OPCODE_PROFILER
+	vm_opcodeProfilerShutdownHook.function = dj_opprof_shutdown;
+	dj_hook_add(&dj_core_shutdownHook, &vm_opcodeProfilerShutdownHook);
+#endif
 }
 
@@ -35,6 +35,7 @@
 
 // generated by the infuser
 #include "jlib_base.h"
+#include "scheduler.h"
 
 /**
  * Creates a new dj_thread object, and constructs a new frame for the given infusion and
@@ -46,35 +47,43 @@
  */
 dj_thread *dj_thread_create_and_run(dj_global_id methodImplId)
 {
-	// create the top frame for the given method
-	dj_frame *frame = dj_frame_create(methodImplId);
+	dj_thread *ret;
+	dj_frame *frame;
+	dj_infusion *infusion = methodImplId.infusion;
+
+	// create a thread to execute the method in. This may trigger a collection, so keep the infusion
+	// pointer up to date
+	dj_mem_addSafePointer((void**)&infusion);
+	ret = dj_thread_create();
+	dj_mem_removeSafePointer((void**)&infusion);
+	methodImplId.infusion = infusion;
 
 	// if we're out of memory, let the caller deal with it
-    if (frame==NULL)
-    {
-        DEBUG_LOG(DBG_DARJEELING, "dj_thread_create_and_run: could not create top frame. Returning null\n");
-        return NULL;
-    }
+	if (ret==NULL)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "dj_thread_create_and_run: could not create Thread object. Returning null\n");
+		return NULL;
+	}
 
-    dj_mem_addSafePointer((void**)&frame);
+	dj_mem_addSafePointer((void**)&ret);
 
-	// create a thread to execute the method in
-	dj_thread *ret = dj_thread_create();
+	// create the top frame for the given method
+	frame = dj_thread_createFrame(ret, methodImplId);
 
 	// if we're out of memory, let the caller deal with it
-    if (ret==NULL)
-    {
-        // free the frame object (if we get here, its allocation was successful)
-        DEBUG_LOG(DBG_DARJEELING, "dj_thread_create_and_run: could create the top frame but not the Thread object. Aborting\n");
-        dj_mem_free(frame);
-
-    } else
-    {
-    	ret->frameStack = frame;
-    	ret->status = THREADSTATUS_RUNNING;
-    }
+	if (frame==NULL)
+	{
+		// free the thread object (if we get here, its allocation was successful)
+		DEBUG_LOG(DBG_DARJEELING, "dj_thread_create_and_run: could create the Thread object but not the top frame. Aborting\n");
+		dj_thread_destroy(ret);
+		ret = NULL;
+	} else
+	{
+		ret->frameStack = frame;
+		ret->status = THREADSTATUS_RUNNING;
+	}
 
-	dj_mem_removeSafePointer((void**)&frame);
+	dj_mem_removeSafePointer((void**)&ret);
 
 	return ret;
 }
@@ -103,12 +112,25 @@ dj_thread *dj_thread_create()
 	ret->priority = 0;
 	ret->runnable = NULL;
 	ret->monitorObject = NULL;
+	ret->queueNext = NULL;
+	ret->heapChild = NULL;
+	ret->heapSibling = NULL;
+	ret->heapPrev = NULL;
+	ret->queued = 0;
+	ret->monitorCount = 0;
+#ifdef THREAD_FRAME_STACK
+	ret->frameSegment = NULL;
+#endif
 
 	return ret;
 }
 
 void dj_thread_destroy(dj_thread *thread)
 {
+#ifdef THREAD_FRAME_STACK
+	if (thread->frameSegment!=NULL)
+		dj_mem_free(thread->frameSegment);
+#endif
 	dj_mem_free(thread);
 }
 
@@ -141,8 +163,10 @@ void dj_frame_markRootSet(dj_frame *frame)
 	int i;
 	ref_t *stack, *locals;
 
+#ifndef THREAD_FRAME_STACK
 	// Mark the frame object as BLACK (don't collect, don't inspect further)
 	dj_mem_setChunkColor(frame, TCM_BLACK);
+#endif
 
 	// Mark every object on the reference stack
 	stack = dj_frame_getReferenceStack(frame);
@@ -151,12 +175,16 @@ void dj_frame_markRootSet(dj_frame *frame)
 
 	// Mark every object in the local variables
 	locals = dj_frame_getLocalReferenceVariables(frame);
-	for (i=0; i<dj_di_methodImplementation_getReferenceLocalVariableCount(dj_global_id_getMethodImplementation(frame->method)); i++)
+	for (i=0; i<dj_frame_getNrLocalReferences(frame); i++)
 		dj_mem_setRefGrayIfWhite(locals[i]);
 
 }
 
-void dj_frame_updatePointers(dj_frame * frame)
+/**
+ * Updates the references held by a frame, and the pointer to its infusion.
+ * @param frame the frame to update
+ */
+static inline void dj_frame_updateReferences(dj_frame * frame)
 {
 	int i;
 	ref_t *stack, *locals;
@@ -168,12 +196,19 @@ void dj_frame_updatePointers(dj_frame * frame)
 
 	// Update the local variables
 	locals = dj_frame_getLocalReferenceVariables(frame);
-	for (i=0; i<dj_di_methodImplementation_getReferenceLocalVariableCount(dj_global_id_getMethodImplementation(frame->method)); i++)
+	for (i=0; i<dj_frame_getNrLocalReferences(frame); i++)
 		locals[i] = dj_mem_getUpdatedReference(locals[i]);
 
-	// update pointers to the infusion and parent frame
-	// NOTE these have to be updated AFTER the stack and local variable frame
+	// update pointer to the infusion
+	// NOTE this has to be updated AFTER the stack and local variable frame
 	frame->method.infusion = dj_mem_getUpdatedPointer(frame->method.infusion);
+}
+
+void dj_frame_updatePointers(dj_frame * frame)
+{
+	dj_frame_updateReferences(frame);
+
+	// update pointer to the parent frame
 	DEBUG_LOG(DBG_DARJEELING, "parent is changed from %p to %p\n", frame->parent, dj_mem_getUpdatedPointer(frame->parent));
 	frame->parent = dj_mem_getUpdatedPointer(frame->parent);
 
@@ -188,6 +223,12 @@ void dj_thread_markRootSet(dj_thread *thread)
 	if (thread->status!=THREADSTATUS_FINISHED)
 		dj_mem_setChunkColor(thread, TCM_BLACK);
 
+#ifdef THREAD_FRAME_STACK
+	// the frame segment is freed together with the thread
+	if (thread->frameSegment!=NULL)
+		dj_mem_setChunkColor(thread->frameSegment, TCM_BLACK);
+#endif
+
 	// mark the thread's monitor object and name string as GRAY
 	if (thread->monitorObject!=NULL) dj_mem_setRefGrayIfWhite(VOIDP_TO_REF(thread->monitorObject));
 	if (thread->runnable!=NULL) dj_mem_setRefGrayIfWhite(VOIDP_TO_REF(thread->runnable));
@@ -203,9 +244,39 @@ void dj_thread_markRootSet(dj_thread *thread)
 
 void dj_thread_updatePointers(dj_thread * thread)
 {
+#ifdef THREAD_FRAME_STACK
+	dj_frame *frame, *parent;
+	heap_size_t shift;
+
+	// Frames live inside the segment chunk, so the heap walk doesn't visit them. Update them here,
+	// and move the frame links along with the segment.
+	if (thread->frameSegment!=NULL)
+	{
+		shift = dj_mem_getChunkShift(thread->frameSegment);
+
+		frame = thread->frameStack;
+		while (frame!=NULL)
+		{
+			parent = frame->parent;
+			dj_frame_updateReferences(frame);
+			if (parent!=NULL)
+				frame->parent = (dj_frame*)((char*)parent - shift);
+			frame = parent;
+		}
+
+		if (thread->frameStack!=NULL)
+			thread->frameStack = (dj_frame*)((char*)thread->frameStack - shift);
+		thread->frameSegment = dj_mem_getUpdatedPointer(thread->frameSegment);
+	}
+#else
 	thread->frameStack = dj_mem_getUpdatedPointer(thread->frameStack);
+#endif
 	thread->monitorObject = dj_mem_getUpdatedPointer(thread->monitorObject);
 	thread->next = dj_mem_getUpdatedPointer(thread->next);
+	thread->queueNext = dj_mem_getUpdatedPointer(thread->queueNext);
+	thread->heapChild = dj_mem_getUpdatedPointer(thread->heapChild);
+	thread->heapSibling = dj_mem_getUpdatedPointer(thread->heapSibling);
+	thread->heapPrev = dj_mem_getUpdatedPointer(thread->heapPrev);
 	thread->runnable = dj_mem_getUpdatedPointer(thread->runnable);
 }
 
@@ -221,15 +292,111 @@ void dj_thread_sleep(dj_thread *thread, dj_time_t time)
 	dj_time_t sleepTime = dj_timer_getTimeMillis() + time;
 	thread->status = THREADSTATUS_SLEEPING;
 	thread->scheduleTime = sleepTime;
+	dj_scheduler_addTimer(dj_exec_getVM(), thread);
 }
 
-void dj_thread_wait(dj_thread * thread, dj_object * object, dj_time_t time)
+/**
+ * Makes a thread wait on an object. The thread releases the object's monitor and joins its wait queue until it is
+ * notified or the timeout expires, after which it has to reacquire the monitor before it can run again.
+ * @param thread the thread that waits, this must be the current thread
+ * @param object the object to wait on
+ * @param time the maximum number of milliseconds to wait, or 0 to wait until notified
+ * @return false if the thread doesn't own the object's monitor, in which case it doesn't wait
+ */
+bool dj_thread_wait(dj_thread * thread, dj_object * object, dj_time_t time)
 {
+	dj_vm *vm = dj_exec_getVM();
+	dj_monitor *monitor = dj_vm_findMonitor(vm, object);
+
+	if ((monitor==NULL)||(monitor->owner!=thread))
+		return false;
+
 	thread->status = THREADSTATUS_WAITING_FOR_MONITOR;
 	thread->scheduleTime = time==0?0:(dj_timer_getTimeMillis() + time);
 	thread->monitorObject = object;
+	if (time!=0)
+		dj_scheduler_addTimer(vm, thread);
+
+	dj_scheduler_wait(vm, monitor, thread);
+
+	return true;
+}
+
+
+/**
+ * Calculates the size of the local reference variables of a frame. With EXECUTION_32BIT_SLOTS this is padded so
+ * that the local integer variables after them are aligned. The padding is zeroed, so it reads as a null reference.
+ * @param methodImpl the method implementation the frame is executing
+ */
+static inline uint16_t dj_frame_getLocalReferencesSize(dj_di_pointer methodImpl)
+{
+	uint16_t size = dj_di_methodImplementation_getReferenceLocalVariableCount(methodImpl) * sizeof(ref_t);
+
+#ifdef EXECUTION_32BIT_SLOTS
+	size = (size + sizeof(dj_int_slot) - 1) & ~(sizeof(dj_int_slot) - 1);
+#endif
+
+	return size;
 }
 
+/**
+ * Calculates the size of the local variable area of a frame.
+ * @param methodImpl the method implementation the frame is executing
+ */
+static inline uint16_t dj_frame_getLocalVariablesSize(dj_di_pointer methodImpl)
+{
+	return
+		dj_frame_getLocalReferencesSize(methodImpl) +
+		(dj_di_methodImplementation_getIntegerLocalVariableCount(methodImpl) * sizeof(dj_int_slot));
+}
+
+/**
+ * Calculates the size of a frame, including the operand stack and local variables.
+ * @param methodImpl the method implementation the frame is executing
+ */
+static inline uint16_t dj_frame_getSize(dj_di_pointer methodImpl)
+{
+	uint16_t size =
+		sizeof(dj_frame) +
+		(dj_di_methodImplementation_getMaxStack(methodImpl) * DJ_FRAME_STACK_SLOT_SIZE) +
+		dj_frame_getLocalVariablesSize(methodImpl)
+		;
+
+#ifdef ALIGN_16
+	if (size&1) size++;
+#endif
+
+#ifdef EXECUTION_32BIT_SLOTS
+	// keep the slots of the next frame in a frame segment aligned too
+	size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+#endif
+
+	return size;
+}
+
+/**
+ * Initialises a newly allocated frame.
+ * @param frame the frame to initialise
+ * @param methodImplId the method implementation the frame will be executing
+ */
+static inline void dj_frame_init(dj_frame *frame, dj_global_id methodImplId)
+{
+	dj_di_pointer methodImpl = dj_global_id_getMethodImplementation(methodImplId);
+
+	frame->method = methodImplId;
+	frame->methodImplementation = methodImpl;
+	frame->parent = NULL;
+	frame->pc = 0;
+	frame->nr_int_stack = 0;
+	frame->nr_ref_stack = 0;
+
+	// precompute the frame layout
+	frame->local_ref_offset = sizeof(dj_frame) + dj_di_methodImplementation_getMaxStack(methodImpl) * DJ_FRAME_STACK_SLOT_SIZE;
+	frame->local_int_offset = frame->local_ref_offset + dj_frame_getLocalReferencesSize(methodImpl);
+
+	// set local variables to 0/null
+	memset(dj_frame_getLocalReferenceVariables(frame), 0, dj_frame_getLocalVariablesSize(methodImpl));
+}
 
 /**
  * Creates a new dj_frame object for a given method implementation.
@@ -244,15 +411,7 @@ dj_frame *dj_frame_create(dj_global_id methodImplId)
 	dj_di_pointer methodImpl = dj_global_id_getMethodImplementation(methodImplId);
 
 	// calculate the size of the frame to create
-	int localVariablesSize =
-		(dj_di_methodImplementation_getReferenceLocalVariableCount(methodImpl) * sizeof(ref_t)) +
-		(dj_di_methodImplementation_getIntegerLocalVariableCount(methodImpl) * sizeof(int16_t));
-
-	int size =
-		sizeof(dj_frame) +
-		(dj_di_methodImplementation_getMaxStack(methodImpl) * sizeof(int16_t)) +
-		localVariablesSize
-		;
+	int size = dj_frame_getSize(methodImpl);
 
 	dj_frame *ret = (dj_frame*)dj_mem_alloc(size, CHUNKID_FRAME);
 
@@ -266,14 +425,7 @@ dj_frame *dj_frame_create(dj_global_id methodImplId)
     	methodImplId.infusion = infusion;
 
 		// init the frame
-		ret->method = methodImplId;
-		ret->parent = NULL;
-		ret->pc = 0;
-		ret->nr_int_stack = 0;
-		ret->nr_ref_stack = 0;
-
-		// set local variables to 0/null
-		memset(dj_frame_getLocalReferenceVariables(ret), 0, localVariablesSize);
+		dj_frame_init(ret, methodImplId);
     }
 
 	dj_mem_removeSafePointer((void**)&infusion);
@@ -281,40 +433,231 @@ dj_frame *dj_frame_create(dj_global_id methodImplId)
 	return ret;
 }
 
+#ifdef THREAD_FRAME_STACK
+
+// the largest frame segment that fits in a heap chunk, which depends on the width of the chunk size field (HEAP_32BIT)
+#define FRAME_SEGMENT_MAX_SIZE (HEAP_MAX_CHUNK_SIZE - sizeof(heap_chunk))
+
+/**
+ * Returns the offset of the first free byte in a thread's frame segment.
+ * @param thread the thread
+ */
+static inline heap_size_t dj_thread_getFrameSegmentTop(dj_thread *thread)
+{
+	if (thread->frameStack==NULL)
+		return 0;
+
+	return ((char*)thread->frameStack - (char*)thread->frameSegment) +
+		dj_frame_getSize(dj_frame_getMethodImplementation(thread->frameStack));
+}
+
+/**
+ * Replaces the frame segment of a thread by a larger one, and moves the frames over. Allocating the new segment
+ * may trigger a collection, so the thread and infusion pointers are passed by reference and kept up to date.
+ * @param thread pointer to the thread whose segment should grow
+ * @param infusion pointer to an infusion pointer the caller needs to keep valid
+ * @param minSize the minimum size of the new segment in bytes
+ * @return true if successful, false if out of memory
+ */
+static bool dj_thread_growFrameSegment(dj_thread **thread, dj_infusion **infusion, uint32_t minSize)
+{
+	void *segment, *oldSegment;
+	heap_size_t used, capacity;
+	uint32_t size;
+	dj_frame *frame;
+	bool active;
+
+	capacity = ((*thread)->frameSegment==NULL) ? 0 : dj_mem_getChunkSize((*thread)->frameSegment) - sizeof(heap_chunk);
+
+	size = capacity * 2;
+	if (size<THREAD_FRAME_STACK_SIZE) size = THREAD_FRAME_STACK_SIZE;
+	if (size<minSize) size = minSize;
+	if (size>FRAME_SEGMENT_MAX_SIZE) size = FRAME_SEGMENT_MAX_SIZE;
+	if (size<minSize) return false;
+
+	// the execution engine caches pointers into the top frame, write them back before the frames move
+	active = (*thread==dj_exec_getCurrentThread()) && ((*thread)->frameStack!=NULL);
+	if (active)
+		dj_exec_deactivateThread(*thread);
+
+	dj_mem_addSafePointer((void**)thread);
+	dj_mem_addSafePointer((void**)infusion);
+	segment = dj_mem_alloc(size, CHUNKID_FRAME_STACK);
+	dj_mem_removeSafePointer((void**)infusion);
+	dj_mem_removeSafePointer((void**)thread);
+
+	if (segment!=NULL)
+	{
+		oldSegment = (*thread)->frameSegment;
+		if (oldSegment!=NULL)
+		{
+			// move the frames and fix up the frame links
+			used = dj_thread_getFrameSegmentTop(*thread);
+			memcpy(segment, oldSegment, used);
+
+			if ((*thread)->frameStack!=NULL)
+			{
+				(*thread)->frameStack = (dj_frame*)((char*)segment + ((char*)(*thread)->frameStack - (char*)oldSegment));
+				for (frame=(*thread)->frameStack; frame->parent!=NULL; frame=frame->parent)
+					frame->parent = (dj_frame*)((char*)segment + ((char*)frame->parent - (char*)oldSegment));
+			}
+
+			dj_mem_free(oldSegment);
+		}
+
+		(*thread)->frameSegment = segment;
+
+		DEBUG_LOG(DBG_DARJEELING, "dj_thread_growFrameSegment: thread %d now has a %d byte frame segment\n", (*thread)->id, (int)size);
+	}
+
+	if (active)
+		dj_exec_activate_thread(*thread);
+
+	return segment!=NULL;
+}
+
+#endif
+
+/**
+ * Creates a new frame for a method that is going to be executed by the given thread. The frame is not pushed onto the
+ * thread's frame stack. With THREAD_FRAME_STACK the frame is allocated on top of the thread's frame segment, which
+ * is grown if needed, otherwise it is allocated on the heap.
+ * @param thread the thread that will execute the frame
+ * @param methodImplId the method implementation this frame will be executing
+ * @return a newly created dj_frame object, or null if fail (out of memory)
+ */
+dj_frame *dj_thread_createFrame(dj_thread *thread, dj_global_id methodImplId)
+{
+#ifdef THREAD_FRAME_STACK
+	dj_frame *ret;
+	dj_infusion *infusion;
+	heap_size_t top, capacity;
+	uint16_t size;
+
+	size = dj_frame_getSize(dj_global_id_getMethodImplementation(methodImplId));
+	top = dj_thread_getFrameSegmentTop(thread);
+	capacity = (thread->frameSegment==NULL) ? 0 : dj_mem_getChunkSize(thread->frameSegment) - sizeof(heap_chunk);
+
+	if ((uint32_t)top + size > capacity)
+	{
+		infusion = methodImplId.infusion;
+		if (!dj_thread_growFrameSegment(&thread, &infusion, (uint32_t)top + size))
+		{
+			DEBUG_LOG(DBG_DARJEELING, "dj_thread_createFrame: could not grow frame segment. Returning null\n");
+			return NULL;
+		}
+		methodImplId.infusion = infusion;
+	}
+
+	// bump-allocate the frame on top of the segment
+	ret = (dj_frame*)((char*)thread->frameSegment + top);
+	dj_frame_init(ret, methodImplId);
+
+	return ret;
+#else
+	return dj_frame_create(methodImplId);
+#endif
+}
+
 /**
- * Creates a new monitor block.
- * @return a newly created monitor block, or null if failed (out of memory)
+ * Creates a new, empty monitor table.
+ * @param capacity the number of slots in the table, must be a power of two
+ * @return a newly created monitor table, or null if failed (out of memory)
  */
-dj_monitor_block * dj_monitor_block_create()
+dj_monitor_table * dj_monitor_table_create(uint16_t capacity)
 {
-	dj_monitor_block * ret = (dj_monitor_block *)dj_mem_alloc(sizeof(dj_monitor_block), CHUNKID_MONITOR_BLOCK);
+	size_t size = sizeof(dj_monitor_table) + capacity * sizeof(dj_monitor);
+	dj_monitor_table * ret = (dj_monitor_table *)dj_mem_alloc(size, CHUNKID_MONITOR_TABLE);
 	if (ret==NULL) return NULL;
 
-    memset(ret, 0, sizeof(dj_monitor_block));
+	memset(ret, 0, size);
+	ret->capacity = capacity;
 
 	return ret;
 }
 
-void dj_monitor_block_updatePointers(dj_monitor_block * monitor_block)
+/**
+ * Copies a monitor into the first free slot of its probe sequence. The table must have at least one free slot and
+ * must not already contain a monitor for the same object.
+ * @param table the monitor table
+ * @param monitor the monitor to insert
+ */
+void dj_monitor_table_insert(dj_monitor_table * table, dj_monitor * monitor)
 {
-	int i;
-	monitor_block->next = dj_mem_getUpdatedPointer(monitor_block->next);
-	for (i=0; i<monitor_block->count; i++)
+	uint16_t i = dj_monitor_table_hash(table, monitor->object);
+
+	while (table->monitors[i].object!=NULL)
+		i = (i + 1) & (table->capacity - 1);
+
+	table->monitors[i] = *monitor;
+}
+
+/**
+ * Updates the pointers in the monitor table and rehashes it, since the lock objects the monitors are keyed on may
+ * have moved. Memory can't be allocated during compaction, so this is done in place: every monitor is moved to the
+ * first slot of its new probe sequence that is empty or holds a monitor that hasn't been rehashed yet, swapping it
+ * with the monitor found there, which is then rehashed in turn. Monitors that have been rehashed are never moved
+ * again, so the probe sequences they lie on remain intact.
+ * @param table the monitor table
+ */
+void dj_monitor_table_updatePointers(dj_monitor_table * table)
+{
+	uint16_t i, j, mask = table->capacity - 1;
+	dj_monitor *slot, monitor, swap;
+
+	for (i=0; i<table->capacity; i++)
+	{
+		slot = &(table->monitors[i]);
+		if (slot->object==NULL) continue;
+
+		slot->object = dj_mem_getUpdatedPointer(slot->object);
+		slot->owner = dj_mem_getUpdatedPointer(slot->owner);
+		slot->blocked = dj_mem_getUpdatedPointer(slot->blocked);
+		slot->waiting = dj_mem_getUpdatedPointer(slot->waiting);
+		slot->rehashed = 0;
+	}
+
+	for (i=0; i<table->capacity; i++)
 	{
-		monitor_block->monitors[i].object = dj_mem_getUpdatedPointer(monitor_block->monitors[i].object);
-		monitor_block->monitors[i].owner = dj_mem_getUpdatedPointer(monitor_block->monitors[i].owner);
+		if ((table->monitors[i].object==NULL)||(table->monitors[i].rehashed)) continue;
+
+		// take the monitor out of its slot and carry it to its new one
+		monitor = table->monitors[i];
+		table->monitors[i].object = NULL;
+
+		while (true)
+		{
+			j = dj_monitor_table_hash(table, monitor.object);
+			while ((table->monitors[j].object!=NULL)&&(table->monitors[j].rehashed))
+				j = (j + 1) & mask;
+
+			slot = &(table->monitors[j]);
+			if (slot->object==NULL)
+			{
+				*slot = monitor;
+				slot->rehashed = 1;
+				break;
+			}
+
+			// the slot holds a monitor that hasn't been rehashed yet, carry that one on instead
+			swap = *slot;
+			*slot = monitor;
+			slot->rehashed = 1;
+			monitor = swap;
+		}
 	}
 }
 
-void dj_monitor_markRootSet(dj_monitor_block * monitor_block)
+void dj_monitor_markRootSet(dj_monitor_table * table)
 {
 	int i;
 
-	// Mark the monitor object as BLACK (don't collect, don't inspect further)
-	dj_mem_setChunkColor(monitor_block, TCM_BLACK);
+	// Mark the monitor table as BLACK (don't collect, don't inspect further)
+	dj_mem_setChunkColor(table, TCM_BLACK);
 
-	for (i=0; i<monitor_block->count; i++)
-		dj_mem_setRefGrayIfWhite(VOIDP_TO_REF(monitor_block->monitors[i].object));
+	for (i=0; i<table->capacity; i++)
+		if (table->monitors[i].object!=NULL)
+			dj_mem_setRefGrayIfWhite(VOIDP_TO_REF(table->monitors[i].object));
 
 }
 
@@ -0,0 +1,276 @@
+/*
+ * vtable.c
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Flattened virtual method tables.
+ *
+ * Without these, INVOKEVIRTUAL finds the method implementation by scanning the method table of the receiver's class,
+ * and then that of each of its superclasses, remapping the method definition id into the context of each infusion on
+ * the way. When VM_FLATTENED_VTABLES is defined, the method tables of every class and its superclasses are merged
+ * into one table per class when an infusion is loaded or unloaded. Each entry is keyed on a dense number for the method
+ * definition, so a lookup is a bisection within a single table.
+ *
+ * Method definitions are shared between unrelated classes (interface methods for instance), so one slot layout per
+ * hierarchy is not possible without help from the infuser. This is why entries are keyed rather than indexed.
+ *
+ * All tables are kept in a single CHUNKID_VTABLES chunk that is referenced from the dj_vm struct. If there is not
+ * enough memory to build them, lookups fall back to scanning.
+ */
+
+#include <string.h>
+
+#include "vtable.h"
+#include "global_id.h"
+#include "infusion.h"
+#include "parse_infusion.h"
+#include "heap.h"
+#include "debug.h"
+
+#include "config.h"
+
+#ifdef VM_FLATTENED_VTABLES
+
+// the largest tables that fit in a heap chunk, which depends on the width of the chunk size field (HEAP_32BIT)
+#define VTABLES_MAX_SIZE (HEAP_MAX_CHUNK_SIZE - sizeof(heap_chunk))
+
+/**
+ * Counts the method table entries of a class and all its superclasses. This is an upper bound on the number of
+ * entries in the flattened table of the class.
+ * @param classId the class to count entries for
+ * @return number of method table entries along the inheritance chain
+ */
+static uint16_t dj_vtables_countEntries(dj_global_id classId)
+{
+	uint16_t ret = 0;
+	dj_di_pointer classDef;
+
+	while (true)
+	{
+		classDef = dj_global_id_getClassDefinition(classId);
+		ret += dj_di_methodTable_getSize(dj_di_classDefinition_getMethodTable(classDef));
+
+		if (dj_global_id_isJavaLangObject(classId))
+			break;
+		else
+			classId = dj_global_id_resolve(classId.infusion, dj_di_classDefinition_getSuperClass(classDef));
+	}
+
+	return ret;
+}
+
+/**
+ * Appends the flattened method table of a class to the entry array. Classes are visited from the class up to
+ * java.lang.Object, and a method definition that is already in the table is overridden by a subclass, so it is skipped.
+ * The entries of the class are then sorted on their definition key.
+ * @param entries the entry array
+ * @param start index of the first entry for this class
+ * @param classId the class to flatten
+ * @return index one past the last entry for this class
+ */
+static uint16_t dj_vtables_flatten(dj_vtable_entry *entries, uint16_t start, dj_global_id classId)
+{
+	int i, j;
+	uint16_t end = start;
+	dj_di_pointer classDef, methodTable, methodTableEntry;
+	dj_global_id definition, implementation;
+	dj_vtable_entry entry;
+
+	while (true)
+	{
+		classDef = dj_global_id_getClassDefinition(classId);
+		methodTable = dj_di_classDefinition_getMethodTable(classDef);
+
+		for (i=0; i<dj_di_methodTable_getSize(methodTable); i++)
+		{
+			methodTableEntry = dj_di_methodTable_getEntry(methodTable, i);
+			definition = dj_global_id_resolve(classId.infusion, dj_di_methodTableEntry_getDefinition(methodTableEntry));
+			implementation = dj_global_id_resolve(classId.infusion, dj_di_methodTableEntry_getImplementation(methodTableEntry));
+
+			entry.definition = (definition.infusion->vtable_index<<8) | definition.entity_id;
+			entry.implementation_infusion = implementation.infusion->vtable_index;
+			entry.implementation_entity = implementation.entity_id;
+
+			// insert in sorted position, unless a subclass already defined this method
+			for (j=end; j>start && entries[j-1].definition>entry.definition; j--);
+			if (j>start && entries[j-1].definition==entry.definition)
+				continue;
+
+			memmove(&entries[j+1], &entries[j], (end-j) * sizeof(dj_vtable_entry));
+			entries[j] = entry;
+			end++;
+		}
+
+		if (dj_global_id_isJavaLangObject(classId))
+			break;
+		else
+			classId = dj_global_id_resolve(classId.infusion, dj_di_classDefinition_getSuperClass(classDef));
+	}
+
+	return end;
+}
+
+/**
+ * (Re)builds the flattened method tables for all loaded infusions. Must be called whenever the set of loaded infusions
+ * changes, since the tables are indexed on runtime class ids. If there is not enough memory, vm->vtables is left NULL
+ * and virtual method lookup falls back to scanning.
+ * @param vm the virtual machine context
+ */
+void dj_vtables_build(dj_vm *vm)
+{
+	int i;
+	uint8_t nr_infusions = 0;
+	uint16_t nr_classes = 0, index;
+	uint32_t nr_entries = 0, size;
+	dj_infusion *infusion;
+	dj_global_id classId;
+	dj_vtables *vtables;
+	uint16_t *classIndex;
+	dj_vtable_entry *entries;
+
+	// release the old tables
+	if (vm->vtables!=NULL)
+	{
+		dj_mem_free(vm->vtables);
+		vm->vtables = NULL;
+	}
+
+	// count infusions, classes and an upper bound on the number of entries
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		infusion->vtable_index = nr_infusions++;
+		classId.infusion = infusion;
+		for (i=0; i<dj_di_parentElement_getListSize(infusion->classList); i++)
+		{
+			classId.entity_id = i;
+			nr_entries += dj_vtables_countEntries(classId);
+			nr_classes++;
+		}
+	}
+
+	size = sizeof(dj_vtables)
+		+ nr_infusions * sizeof(dj_infusion*)
+		+ (nr_classes + 1) * sizeof(uint16_t)
+		+ nr_entries * sizeof(dj_vtable_entry);
+
+	// the class index holds 16 bit entry indices
+	if (size>VTABLES_MAX_SIZE || nr_entries>UINT16_MAX)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "vtables: %d bytes needed, too large for a single chunk\n", (int)size);
+		return;
+	}
+
+	// allocating may trigger a collection, which moves the VM and the infusions around
+	dj_mem_addSafePointer((void**)&vm);
+	vtables = (dj_vtables*)dj_mem_alloc(size, CHUNKID_VTABLES);
+	dj_mem_removeSafePointer((void**)&vm);
+
+	if (vtables==NULL)
+	{
+		DEBUG_LOG(DBG_DARJEELING, "vtables: not enough memory, using method table scanning\n");
+		return;
+	}
+
+	vtables->nr_infusions = nr_infusions;
+	vtables->nr_classes = nr_classes;
+
+	i = 0;
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+		vtables->infusions[i++] = infusion;
+
+	classIndex = dj_vtables_getIndex(vtables);
+	entries = dj_vtables_getEntries(vtables);
+
+	// flatten the classes in runtime id order
+	index = 0;
+	nr_classes = 0;
+	for (infusion=vm->infusions; infusion!=NULL; infusion=infusion->next)
+	{
+		classId.infusion = infusion;
+		for (i=0; i<dj_di_parentElement_getListSize(infusion->classList); i++)
+		{
+			classId.entity_id = i;
+			classIndex[nr_classes++] = index;
+			index = dj_vtables_flatten(entries, index, classId);
+		}
+	}
+	classIndex[nr_classes] = index;
+	vtables->nr_entries = index;
+
+	DEBUG_LOG(DBG_DARJEELING, "vtables: %d classes, %d entries\n", vtables->nr_classes, vtables->nr_entries);
+
+	vm->vtables = vtables;
+}
+
+/**
+ * Looks up the implementation of a virtual method in the flattened method table of a class. The entries of a class
+ * are sorted on their definition key, so this is a bisection, O(log n) in the number of entries of the class, rather
+ * than an index into a fixed slot.
+ * @param vtables the flattened method tables
+ * @param resolvedMethodDefId the method definition to look up
+ * @param classId the runtime class id of the receiver object
+ * @return the global id of the method implementation, or an id with a NULL infusion if not found
+ */
+dj_global_id dj_vtables_lookup(dj_vtables *vtables, dj_global_id resolvedMethodDefId, runtime_id_t classId)
+{
+	dj_global_id ret;
+	uint16_t *classIndex = dj_vtables_getIndex(vtables);
+	dj_vtable_entry *entries = dj_vtables_getEntries(vtables);
+	uint16_t key = (resolvedMethodDefId.infusion->vtable_index<<8) | resolvedMethodDefId.entity_id;
+	uint16_t low, high, mid;
+
+	// mark not found
+	ret.infusion = NULL;
+
+	classId -= CHUNKID_JAVA_START;
+	low = classIndex[classId];
+	high = classIndex[classId + 1];
+
+	while (low<high)
+	{
+		mid = (low + high) >> 1;
+		if (entries[mid].definition<key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low<classIndex[classId + 1] && entries[low].definition==key)
+	{
+		ret.infusion = vtables->infusions[entries[low].implementation_infusion];
+		ret.entity_id = entries[low].implementation_entity;
+	}
+
+	return ret;
+}
+
+/**
+ * Updates the infusion pointers held by the flattened method tables after compaction.
+ * @param vtables the flattened method tables
+ */
+void dj_vtables_updatePointers(dj_vtables *vtables)
+{
+	int i;
+
+	for (i=0; i<vtables->nr_infusions; i++)
+		vtables->infusions[i] = dj_mem_getUpdatedPointer(vtables->infusions[i]);
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * alloc_profiler.h
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __alloc_profiler__
+#define __alloc_profiler__
+
+#include "types.h"
+
+#include "config.h"
+
+#ifdef ALLOC_PROFILER
+
+// kinds of allocations counted per type
+#define DJ_ALLOCPROF_CHUNK 0			// non-Java heap chunk, keyed on chunk id
+#define DJ_ALLOCPROF_OBJECT 1			// Java object, keyed on class
+#define DJ_ALLOCPROF_INT_ARRAY 2		// integer array, keyed on element type
+#define DJ_ALLOCPROF_REF_ARRAY 3		// reference array, keyed on element class
+#define DJ_ALLOCPROF_METHOD 4			// allocation site, keyed on the allocating method
+
+void dj_allocprof_recordChunk(void *data);
+void dj_allocprof_recordType(uint8_t kind, runtime_id_t id, void *ptr);
+void dj_allocprof_dump();
+void dj_allocprof_reset();
+void dj_allocprof_shutdown(void *data);
+
+#endif
+
+#endif
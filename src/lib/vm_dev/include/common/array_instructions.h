@@ -272,7 +272,12 @@ static inline void AASTORE()
 		dj_exec_createAndThrow(BASE_CDEF_java_lang_NullPointerException);
 	else
 		if ((index>=0) && (index<((dj_array*)arr)->length))
+		{
+#ifdef GC_INCREMENTAL
+			dj_mem_writeBarrier(value);
+#endif
 			arr->refs[index] = value;
+		}
 		else
 			dj_exec_createAndThrow(BASE_CDEF_java_lang_IndexOutOfBoundsException);
 
@@ -341,6 +341,58 @@ static inline void SIFLE()
 		branch(offset-3);
 }
 
+#ifdef EXECUTION_SUPERINSTRUCTIONS
+
+/**
+ * Executes the fused SLOAD, SIFEQ instruction. Branches to [offset of the instruction] + [immediate S16] if
+ * short local variable [immediate U8] == 0
+ */
+static inline void SLOAD_SIFEQ()
+{
+	int16_t value = getLocalShort(fetch());
+	uint16_t offset = fetch16();
+	if (value==0)
+		branch(offset-4);
+}
+
+/**
+ * Executes the fused SLOAD, SIFNE instruction. Branches to [offset of the instruction] + [immediate S16] if
+ * short local variable [immediate U8] != 0
+ */
+static inline void SLOAD_SIFNE()
+{
+	int16_t value = getLocalShort(fetch());
+	uint16_t offset = fetch16();
+	if (value!=0)
+		branch(offset-4);
+}
+
+/**
+ * Executes the fused ILOAD, IIFEQ instruction. Branches to [offset of the instruction] + [immediate S16] if
+ * int local variable [immediate U8] == 0
+ */
+static inline void ILOAD_IIFEQ()
+{
+	int32_t value = getLocalInt(fetch());
+	uint16_t offset = fetch16();
+	if (value==0)
+		branch(offset-4);
+}
+
+/**
+ * Executes the fused ILOAD, IIFNE instruction. Branches to [offset of the instruction] + [immediate S16] if
+ * int local variable [immediate U8] != 0
+ */
+static inline void ILOAD_IIFNE()
+{
+	int32_t value = getLocalInt(fetch());
+	uint16_t offset = fetch16();
+	if (value!=0)
+		branch(offset-4);
+}
+
+#endif
+
 
 /**
  * Executes the IFNULL instruction. Branches to [offset of the GOTO instruction] + [immediate S16] if
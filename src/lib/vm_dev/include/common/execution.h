@@ -60,6 +60,63 @@ void dj_exec_setVM(dj_vm *_vm);
 dj_vm *dj_exec_getVM();
 
 void dj_exec_updatePointers();
+void dj_exec_flushCaches();
+
+extern DJ_VM_LOCAL bool dj_exec_use_rtc;
+
+#ifdef EXECUTION_AOT
+#include "array.h"
+
+// Exceptions that C code generated by the infuser for a compiled method can raise
+enum CompiledMethodException
+{
+	COMPILED_NULL_POINTER = 0,
+	COMPILED_CLASS_UNLOADED = 1,
+	COMPILED_INDEX_OUT_OF_BOUNDS = 2,
+	COMPILED_ARITHMETIC = 3
+};
+
+void dj_exec_throwCompiled(uint8_t exception);
+
+/**
+ * Checks an object reference before a compiled method accesses one of its fields.
+ * @param ref the object reference
+ * @return the object, or NULL if an exception has been thrown, in which case the compiled method must return
+ */
+static inline dj_object *dj_exec_compiledCheckObject(ref_t ref)
+{
+	dj_object *object = REF_TO_VOIDP(ref);
+
+	if (object==NULL)
+		dj_exec_throwCompiled(COMPILED_NULL_POINTER);
+	else if (dj_object_getRuntimeId(object)==CHUNKID_INVALID)
+		dj_exec_throwCompiled(COMPILED_CLASS_UNLOADED);
+	else
+		return object;
+
+	return NULL;
+}
+
+/**
+ * Checks an array reference and index before a compiled method accesses an array element.
+ * @param ref the array reference
+ * @param index the element index
+ * @return the array, or NULL if an exception has been thrown, in which case the compiled method must return
+ */
+static inline void *dj_exec_compiledCheckArray(ref_t ref, int32_t index)
+{
+	dj_array *array = REF_TO_VOIDP(ref);
+
+	if (array==NULL)
+		dj_exec_throwCompiled(COMPILED_NULL_POINTER);
+	else if ((index<0) || (index>=array->length))
+		dj_exec_throwCompiled(COMPILED_INDEX_OUT_OF_BOUNDS);
+	else
+		return array;
+
+	return NULL;
+}
+#endif
 
 #ifdef DARJEELING_DEBUG_FRAME
 void dj_exec_dumpFrame( dj_frame *frame );
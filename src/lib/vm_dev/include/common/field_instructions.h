@@ -22,11 +22,56 @@
 #include "config.h"
 
 
+/**
+ * Fetches the operands of a GETSTATIC or PUTSTATIC instruction and returns the address of the static field. With
+ * EXECUTION_QUICKENING the address is recorded in the quickening table, so later executions of the same instruction
+ * skip resolving the infusion.
+ * @param type the JTID_ type of the field, which selects the static field array
+ */
+static inline void * fetchStaticField(int type)
+{
+	uint8_t infusion_id, index;
+	dj_infusion *infusion;
+	void *ret;
+
+#ifdef EXECUTION_QUICKENING
+	dj_di_pointer site = code + pc;
+	dj_exec_quickEntry *quickEntry = dj_exec_getQuickEntry(site);
+
+	if (quickEntry->site==site)
+	{
+		pc += 2;
+		return quickEntry->resolved.field;
+	}
+#endif
+
+	infusion_id = fetch();
+	infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
+	index = fetch();
+
+	switch (type)
+	{
+		case JTID_BYTE: ret = &infusion->staticByteFields[index]; break;
+		case JTID_SHORT: ret = &infusion->staticShortFields[index]; break;
+		case JTID_INT: ret = &infusion->staticIntFields[index]; break;
+		case JTID_LONG: ret = &infusion->staticLongFields[index]; break;
+		default: ret = &infusion->staticReferenceFields[index]; break;
+	}
+
+#ifdef EXECUTION_QUICKENING
+	quickEntry->site = site;
+	quickEntry->target.infusion = infusion;
+	quickEntry->target.entity_id = index;
+	quickEntry->resolved.field = ret;
+	quickEntry->isStaticField = true;
+#endif
+
+	return ret;
+}
+
 static inline void GETSTATIC_B()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	pushShort((int8_t)infusion->staticByteFields[fetch()]);
+	pushShort(*(int8_t*)fetchStaticField(JTID_BYTE));
 }
 
 static inline void GETSTATIC_C()
@@ -36,37 +81,28 @@ static inline void GETSTATIC_C()
 
 static inline void GETSTATIC_S()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	pushShort((int16_t)infusion->staticShortFields[fetch()]);
+	pushShort(*(int16_t*)fetchStaticField(JTID_SHORT));
 }
 
 static inline void GETSTATIC_I()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	pushInt(infusion->staticIntFields[fetch()]);
+	pushInt(*(uint32_t*)fetchStaticField(JTID_INT));
 }
 
 static inline void GETSTATIC_L()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	pushLong(infusion->staticLongFields[fetch()]);
+	pushLong(*(uint64_t*)fetchStaticField(JTID_LONG));
 }
 
 static inline void GETSTATIC_A()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	pushRef(infusion->staticReferenceFields[fetch()]);
+	pushRef(*(ref_t*)fetchStaticField(JTID_REF));
 }
 
 static inline void PUTSTATIC_B()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	infusion->staticByteFields[fetch()] = (int8_t)popShort();
+	uint8_t *field = fetchStaticField(JTID_BYTE);
+	*field = (int8_t)popShort();
 }
 
 static inline void PUTSTATIC_C()
@@ -76,30 +112,29 @@ static inline void PUTSTATIC_C()
 
 static inline void PUTSTATIC_S()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	infusion->staticShortFields[fetch()] = (int16_t)popShort();
+	uint16_t *field = fetchStaticField(JTID_SHORT);
+	*field = (int16_t)popShort();
 }
 
 static inline void PUTSTATIC_I()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	infusion->staticIntFields[fetch()] = popInt();
+	uint32_t *field = fetchStaticField(JTID_INT);
+	*field = popInt();
 }
 
 static inline void PUTSTATIC_L()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	infusion->staticLongFields[fetch()] = popLong();
+	uint64_t *field = fetchStaticField(JTID_LONG);
+	*field = popLong();
 }
 
 static inline void PUTSTATIC_A()
 {
-	uint8_t infusion_id = fetch();
-	dj_infusion *infusion = dj_infusion_resolve(dj_exec_getCurrentInfusion(), infusion_id);
-	infusion->staticReferenceFields[fetch()] = popRef();
+	ref_t *field = fetchStaticField(JTID_REF);
+	*field = popRef();
+#ifdef GC_INCREMENTAL
+	dj_mem_writeBarrier(*field);
+#endif
 }
 
 static inline void GETFIELD_B()
@@ -302,6 +337,9 @@ static inline void PUTFIELD_A()
 	else
 	{
 		uint16_t index = (fetch()<<8) + fetch();
+#ifdef GC_INCREMENTAL
+		dj_mem_writeBarrier(value);
+#endif
 		dj_object_getReferences(object)[index] = value;
 	}
 
@@ -91,24 +91,59 @@ static inline void ARETURN()
 }
 
 
-static inline void INVOKESTATIC()
+/**
+ * Resolves the method referenced by an INVOKESTATIC or INVOKESPECIAL instruction and calls it. With
+ * EXECUTION_QUICKENING the resolved method is recorded in the quickening table, so later executions of the same
+ * instruction skip resolution.
+ * @param virtualCall 1 for INVOKESPECIAL, 0 for INVOKESTATIC
+ */
+static inline void invokeNonVirtual(int virtualCall)
 {
+#ifdef EXECUTION_QUICKENING
+	dj_di_pointer site = code + pc;
+	dj_exec_quickEntry *quickEntry = dj_exec_getQuickEntry(site);
+
+	if (quickEntry->site==site)
+	{
+		pc += 2;
+		callResolvedMethod(quickEntry->target, quickEntry->resolved.methodImpl, virtualCall);
+		return;
+	}
+#endif
+
 	dj_local_id localId = dj_fetchLocalId();
 	dj_global_id globalId = dj_global_id_resolve(dj_exec_getCurrentInfusion(),  localId);
-	callMethod(globalId, false);
+	dj_di_pointer methodImpl = dj_global_id_getMethodImplementation(globalId);
+
+#ifdef EXECUTION_QUICKENING
+	quickEntry->site = site;
+	quickEntry->target = globalId;
+	quickEntry->resolved.methodImpl = methodImpl;
+	quickEntry->isStaticField = false;
+#endif
+
+	callResolvedMethod(globalId, methodImpl, virtualCall);
+}
+
+static inline void INVOKESTATIC()
+{
+	invokeNonVirtual(false);
 }
 
 
 static inline void INVOKESPECIAL()
 {
-	dj_local_id localId = dj_fetchLocalId();
-	dj_global_id globalId = dj_global_id_resolve(dj_exec_getCurrentInfusion(),  localId);
-
-	callMethod(globalId, true);
+	invokeNonVirtual(true);
 }
 
 static inline void INVOKEVIRTUAL()
 {
+#ifdef EXECUTION_INLINE_CACHE
+	// the address of the operands identifies the call site
+	dj_di_pointer site = code + pc;
+	dj_exec_invokeCacheEntry *cacheEntry = dj_exec_getInvokeCacheEntry(site);
+#endif
+
 	// fetch the method definition's global id and resolve it
 	dj_local_id dj_local_id = dj_fetchLocalId();
 
@@ -132,6 +167,16 @@ static inline void INVOKEVIRTUAL()
 		return;
 	}
 
+#ifdef EXECUTION_INLINE_CACHE
+	// inline cache hit: same call site, a receiver class seen there before
+	dj_exec_invokeCacheWay *cacheWay = dj_exec_findInvokeCacheWay(cacheEntry, site, dj_object_getRuntimeId(object));
+	if (cacheWay!=NULL)
+	{
+		callResolvedMethod(cacheWay->methodImplId, cacheWay->methodImpl, true);
+		return;
+	}
+#endif
+
 	dj_global_id resolvedMethodDefId = dj_global_id_resolve(dj_exec_getCurrentInfusion(), dj_local_id);
 
 	DEBUG_LOG(DBG_DARJEELING, ">>>>> invokevirtual METHOD DEF %p.%d\n", resolvedMethodDefId.infusion, resolvedMethodDefId.entity_id);
@@ -149,7 +194,15 @@ static inline void INVOKEVIRTUAL()
 		dj_exec_throwHere(dj_vm_createSysLibObject(dj_exec_getVM(), BASE_CDEF_java_lang_VirtualMachineError));
 	} else
 	{
+#ifdef EXECUTION_INLINE_CACHE
+		// add the receiver class to the cache for this call site
+		cacheWay = dj_exec_addInvokeCacheWay(cacheEntry, site, dj_object_getRuntimeId(object));
+		cacheWay->methodImplId = methodImplId;
+		cacheWay->methodImpl = dj_global_id_getMethodImplementation(methodImplId);
+		callResolvedMethod(methodImplId, cacheWay->methodImpl, true);
+#else
 		callMethod(methodImplId, true);
+#endif
 	}
 }
 
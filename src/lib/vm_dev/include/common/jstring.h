@@ -33,4 +33,11 @@
 dj_object * dj_jstring_createFromStr(dj_vm *vm, char * str);
 dj_object * dj_jstring_createFromGlobalId(dj_vm *vm, dj_global_id stringId);
 
+#ifdef VM_INTERN_STRINGS
+dj_object * dj_jstring_intern(dj_vm *vm, dj_global_id stringId);
+void dj_jstring_removeCollectedInterned();
+void dj_jstring_updateInternedPointers();
+void dj_jstring_removeInternedInfusion(dj_infusion *infusion);
+#endif
+
 #endif
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "jstring.h"
+#include "scheduler.h"
 
 #include "jlib_base.h"
 
@@ -37,7 +38,11 @@ static inline void LDS()
 	dj_local_id localStringId = dj_fetchLocalId();
 	dj_global_id globalStringId = dj_global_id_resolve(dj_exec_getCurrentInfusion(), localStringId);
 
+#ifdef VM_INTERN_STRINGS
+	string = dj_jstring_intern(dj_exec_getVM(), globalStringId);
+#else
 	string = dj_jstring_createFromGlobalId(dj_exec_getVM(), globalStringId);
+#endif
 
 	if (string==NULL)
 		dj_exec_createAndThrow(BASE_CDEF_java_lang_OutOfMemoryError);
@@ -172,10 +177,11 @@ static inline void MONITORENTER()
 			} else
 			{
 
-				// we can't enter, so just block
+				// we can't enter, so just block until the owner hands us the monitor
 				dj_exec_getCurrentThread()->status = THREADSTATUS_BLOCKED_FOR_MONITOR;
 				dj_exec_getCurrentThread()->monitorObject = obj;
 				monitor->waiting_threads++;
+				dj_scheduler_block(monitor, dj_exec_getCurrentThread());
 				DEBUG_LOG(DBG_DARJEELING, "monitor is already held by someone. let's block\n");
 
 				dj_exec_breakExecution();
@@ -232,9 +238,13 @@ static inline void MONITOREXIT()
 
 	dj_thread * thread = dj_exec_getCurrentThread();
 
-	// exit the monitor
+	// exit the monitor, and hand it to a blocked thread if it's free now
 	monitor->count--;
-	monitor->owner = NULL;
+	if (monitor->count==0)
+	{
+		monitor->owner = NULL;
+		dj_scheduler_releaseMonitor(dj_exec_getVM(), monitor);
+	}
 
     DEBUG_LOG(DBG_DARJEELING, "Exiting monitor %p, count is now %d\n", monitor, monitor->count);
 
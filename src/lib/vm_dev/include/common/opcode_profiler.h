@@ -0,0 +1,42 @@
+/*
+ * opcode_profiler.h
+ *
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ *
+ * This file is part of Darjeeling.
+ *
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __opcode_profiler__
+#define __opcode_profiler__
+
+#include "types.h"
+
+#include "config.h"
+
+#ifdef OPCODE_PROFILER
+
+void dj_opprof_record(uint8_t opcode);
+void dj_opprof_break();
+void dj_opprof_dump();
+void dj_opprof_reset();
+void dj_opprof_shutdown(void *data);
+
+// implemented in execution.c, which holds the opcode name table
+const char *dj_exec_getOpcodeName(uint8_t opcode);
+
+#endif
+
+#endif
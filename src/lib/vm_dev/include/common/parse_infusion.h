@@ -26,7 +26,12 @@
 #include "program_mem.h"
 
 
-#define INFUSION_FORMAT_VERSION 3 // 1: original, 2: RTC, 3: 32 bit addresses
+// 1: original, 2: RTC, 3: 32 bit addresses, 4: 3 with 32 bit operand slots (EXECUTION_32BIT_SLOTS)
+#ifdef EXECUTION_32BIT_SLOTS
+#define INFUSION_FORMAT_VERSION 4
+#else
+#define INFUSION_FORMAT_VERSION 3
+#endif
 
 enum ElementType
 {
@@ -42,7 +47,8 @@ enum ElementType
 enum MethodImplementationFlags
 {
 	FLAGS_NATIVE = 1,
-	FLAGS_STATIC = 2
+	FLAGS_STATIC = 2,
+	FLAGS_COMPILED = 4
 };
 
 enum JavaTypeID
@@ -0,0 +1,61 @@
+/*
+ * scheduler.h
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __scheduler__
+#define __scheduler__
+
+#include "types.h"
+
+#include "config.h"
+
+// bits in dj_thread.queued
+#define DJ_THREAD_QUEUED_READY 1
+#define DJ_THREAD_QUEUED_TIMER 2
+
+// Bounds of the adaptive quantum, in the units of dj_exec_run. A thread that runs alone gets the largest quantum,
+// with more ready threads the quantum shrinks so that every thread still gets a turn quickly.
+#ifndef SCHEDULER_QUANTUM_MAX
+#define SCHEDULER_QUANTUM_MAX (RUNSIZE * 4)
+#endif
+#ifndef SCHEDULER_QUANTUM_MIN
+#define SCHEDULER_QUANTUM_MIN (RUNSIZE / 2)
+#endif
+
+void dj_scheduler_enqueue(dj_vm *vm, dj_thread *thread);
+dj_thread *dj_scheduler_dequeue(dj_vm *vm);
+void dj_scheduler_makeReady(dj_vm *vm, dj_thread *thread);
+
+void dj_scheduler_addTimer(dj_vm *vm, dj_thread *thread);
+void dj_scheduler_removeTimer(dj_vm *vm, dj_thread *thread);
+void dj_scheduler_wakeExpired(dj_vm *vm);
+dj_time_t dj_scheduler_getNextTimeout(dj_vm *vm);
+
+void dj_scheduler_block(dj_monitor *monitor, dj_thread *thread);
+void dj_scheduler_unblock(dj_monitor *monitor, dj_thread *thread);
+void dj_scheduler_releaseMonitor(dj_vm *vm, dj_monitor *monitor);
+void dj_scheduler_wait(dj_vm *vm, dj_monitor *monitor, dj_thread *thread);
+void dj_scheduler_wakeWaiter(dj_vm *vm, dj_monitor *monitor, dj_thread *thread);
+void dj_scheduler_notify(dj_vm *vm, dj_monitor *monitor, bool all);
+
+void dj_scheduler_unschedule(dj_vm *vm, dj_thread *thread);
+int dj_scheduler_getQuantum(dj_vm *vm);
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * threaded_dispatch.h
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Initialiser entries for the computed-goto dispatch table in dj_exec_run. This file is included
+ * inside the table definition when EXECUTION_THREADED_DISPATCH is defined. Every opcode that has a
+ * CASE(...) handler in execution.c needs an entry here; opcodes without one fall through to op_default.
+ */
+
+	[JVM_SADD] = &&op_JVM_SADD,
+	[JVM_SSUB] = &&op_JVM_SSUB,
+	[JVM_SMUL] = &&op_JVM_SMUL,
+	[JVM_SDIV] = &&op_JVM_SDIV,
+	[JVM_SNEG] = &&op_JVM_SNEG,
+	[JVM_SSHR] = &&op_JVM_SSHR,
+	[JVM_SUSHR] = &&op_JVM_SUSHR,
+	[JVM_SSHL] = &&op_JVM_SSHL,
+	[JVM_SREM] = &&op_JVM_SREM,
+	[JVM_SAND] = &&op_JVM_SAND,
+	[JVM_SOR] = &&op_JVM_SOR,
+	[JVM_SXOR] = &&op_JVM_SXOR,
+	[JVM_IADD] = &&op_JVM_IADD,
+	[JVM_ISUB] = &&op_JVM_ISUB,
+	[JVM_IMUL] = &&op_JVM_IMUL,
+	[JVM_IDIV] = &&op_JVM_IDIV,
+	[JVM_INEG] = &&op_JVM_INEG,
+	[JVM_ISHR] = &&op_JVM_ISHR,
+	[JVM_IUSHR] = &&op_JVM_IUSHR,
+	[JVM_ISHL] = &&op_JVM_ISHL,
+	[JVM_IREM] = &&op_JVM_IREM,
+	[JVM_IAND] = &&op_JVM_IAND,
+	[JVM_IOR] = &&op_JVM_IOR,
+	[JVM_IXOR] = &&op_JVM_IXOR,
+	[JVM_LADD] = &&op_JVM_LADD,
+	[JVM_LSUB] = &&op_JVM_LSUB,
+	[JVM_LMUL] = &&op_JVM_LMUL,
+	[JVM_LDIV] = &&op_JVM_LDIV,
+	[JVM_LNEG] = &&op_JVM_LNEG,
+	[JVM_LSHR] = &&op_JVM_LSHR,
+	[JVM_LUSHR] = &&op_JVM_LUSHR,
+	[JVM_LSHL] = &&op_JVM_LSHL,
+	[JVM_LREM] = &&op_JVM_LREM,
+	[JVM_LAND] = &&op_JVM_LAND,
+	[JVM_LOR] = &&op_JVM_LOR,
+	[JVM_LXOR] = &&op_JVM_LXOR,
+	[JVM_S2B] = &&op_JVM_S2B,
+	[JVM_S2C] = &&op_JVM_S2C,
+	[JVM_S2I] = &&op_JVM_S2I,
+	[JVM_S2L] = &&op_JVM_S2L,
+	[JVM_I2B] = &&op_JVM_I2B,
+	[JVM_I2C] = &&op_JVM_I2C,
+	[JVM_I2S] = &&op_JVM_I2S,
+	[JVM_I2L] = &&op_JVM_I2L,
+	[JVM_L2I] = &&op_JVM_L2I,
+	[JVM_L2S] = &&op_JVM_L2S,
+	[JVM_B2C] = &&op_JVM_B2C,
+	[JVM_IINC] = &&op_JVM_IINC,
+	[JVM_IINC_W] = &&op_JVM_IINC_W,
+	[JVM_SINC] = &&op_JVM_SINC,
+	[JVM_SINC_W] = &&op_JVM_SINC_W,
+	[JVM_SCONST_M1] = &&op_JVM_SCONST_M1,
+	[JVM_SCONST_0] = &&op_JVM_SCONST_0,
+	[JVM_SCONST_1] = &&op_JVM_SCONST_1,
+	[JVM_SCONST_2] = &&op_JVM_SCONST_2,
+	[JVM_SCONST_3] = &&op_JVM_SCONST_3,
+	[JVM_SCONST_4] = &&op_JVM_SCONST_4,
+	[JVM_SCONST_5] = &&op_JVM_SCONST_5,
+	[JVM_ICONST_M1] = &&op_JVM_ICONST_M1,
+	[JVM_ICONST_0] = &&op_JVM_ICONST_0,
+	[JVM_ICONST_1] = &&op_JVM_ICONST_1,
+	[JVM_ICONST_2] = &&op_JVM_ICONST_2,
+	[JVM_ICONST_3] = &&op_JVM_ICONST_3,
+	[JVM_ICONST_4] = &&op_JVM_ICONST_4,
+	[JVM_ICONST_5] = &&op_JVM_ICONST_5,
+	[JVM_LCONST_0] = &&op_JVM_LCONST_0,
+	[JVM_LCONST_1] = &&op_JVM_LCONST_1,
+	[JVM_BIPUSH] = &&op_JVM_BIPUSH,
+	[JVM_BSPUSH] = &&op_JVM_BSPUSH,
+	[JVM_SIPUSH] = &&op_JVM_SIPUSH,
+	[JVM_SSPUSH] = &&op_JVM_SSPUSH,
+	[JVM_IIPUSH] = &&op_JVM_IIPUSH,
+	[JVM_LLPUSH] = &&op_JVM_LLPUSH,
+	[JVM_LDS] = &&op_JVM_LDS,
+	[JVM_SLOAD] = &&op_JVM_SLOAD,
+	[JVM_SLOAD_0] = &&op_JVM_SLOAD_0,
+	[JVM_SLOAD_1] = &&op_JVM_SLOAD_1,
+	[JVM_SLOAD_2] = &&op_JVM_SLOAD_2,
+	[JVM_SLOAD_3] = &&op_JVM_SLOAD_3,
+	[JVM_ILOAD] = &&op_JVM_ILOAD,
+	[JVM_ILOAD_0] = &&op_JVM_ILOAD_0,
+	[JVM_ILOAD_1] = &&op_JVM_ILOAD_1,
+	[JVM_ILOAD_2] = &&op_JVM_ILOAD_2,
+	[JVM_ILOAD_3] = &&op_JVM_ILOAD_3,
+	[JVM_LLOAD] = &&op_JVM_LLOAD,
+	[JVM_LLOAD_0] = &&op_JVM_LLOAD_0,
+	[JVM_LLOAD_1] = &&op_JVM_LLOAD_1,
+	[JVM_LLOAD_2] = &&op_JVM_LLOAD_2,
+	[JVM_LLOAD_3] = &&op_JVM_LLOAD_3,
+	[JVM_ACONST_NULL] = &&op_JVM_ACONST_NULL,
+	[JVM_ALOAD] = &&op_JVM_ALOAD,
+	[JVM_ALOAD_0] = &&op_JVM_ALOAD_0,
+	[JVM_ALOAD_1] = &&op_JVM_ALOAD_1,
+	[JVM_ALOAD_2] = &&op_JVM_ALOAD_2,
+	[JVM_ALOAD_3] = &&op_JVM_ALOAD_3,
+	[JVM_SSTORE] = &&op_JVM_SSTORE,
+	[JVM_SSTORE_0] = &&op_JVM_SSTORE_0,
+	[JVM_SSTORE_1] = &&op_JVM_SSTORE_1,
+	[JVM_SSTORE_2] = &&op_JVM_SSTORE_2,
+	[JVM_SSTORE_3] = &&op_JVM_SSTORE_3,
+	[JVM_ISTORE] = &&op_JVM_ISTORE,
+	[JVM_ISTORE_0] = &&op_JVM_ISTORE_0,
+	[JVM_ISTORE_1] = &&op_JVM_ISTORE_1,
+	[JVM_ISTORE_2] = &&op_JVM_ISTORE_2,
+	[JVM_ISTORE_3] = &&op_JVM_ISTORE_3,
+	[JVM_LSTORE] = &&op_JVM_LSTORE,
+	[JVM_LSTORE_0] = &&op_JVM_LSTORE_0,
+	[JVM_LSTORE_1] = &&op_JVM_LSTORE_1,
+	[JVM_LSTORE_2] = &&op_JVM_LSTORE_2,
+	[JVM_LSTORE_3] = &&op_JVM_LSTORE_3,
+	[JVM_ASTORE] = &&op_JVM_ASTORE,
+	[JVM_ASTORE_0] = &&op_JVM_ASTORE_0,
+	[JVM_ASTORE_1] = &&op_JVM_ASTORE_1,
+	[JVM_ASTORE_2] = &&op_JVM_ASTORE_2,
+	[JVM_ASTORE_3] = &&op_JVM_ASTORE_3,
+	[JVM_IPOP] = &&op_JVM_IPOP,
+	[JVM_IPOP2] = &&op_JVM_IPOP2,
+	[JVM_IDUP] = &&op_JVM_IDUP,
+	[JVM_IDUP2] = &&op_JVM_IDUP2,
+	[JVM_IDUP_X] = &&op_JVM_IDUP_X,
+	[JVM_IDUP_X1] = &&op_JVM_IDUP_X1,
+	[JVM_IDUP_X2] = &&op_JVM_IDUP_X2,
+	[JVM_APOP] = &&op_JVM_APOP,
+	[JVM_APOP2] = &&op_JVM_APOP2,
+	[JVM_ADUP] = &&op_JVM_ADUP,
+	[JVM_ADUP2] = &&op_JVM_ADUP2,
+	[JVM_ADUP_X1] = &&op_JVM_ADUP_X1,
+	[JVM_ADUP_X2] = &&op_JVM_ADUP_X2,
+	[JVM_GOTO] = &&op_JVM_GOTO,
+	[JVM_IF_ICMPEQ] = &&op_JVM_IF_ICMPEQ,
+	[JVM_IF_ICMPNE] = &&op_JVM_IF_ICMPNE,
+	[JVM_IF_ICMPLT] = &&op_JVM_IF_ICMPLT,
+	[JVM_IF_ICMPGE] = &&op_JVM_IF_ICMPGE,
+	[JVM_IF_ICMPGT] = &&op_JVM_IF_ICMPGT,
+	[JVM_IF_ICMPLE] = &&op_JVM_IF_ICMPLE,
+	[JVM_IF_SCMPEQ] = &&op_JVM_IF_SCMPEQ,
+	[JVM_IF_SCMPNE] = &&op_JVM_IF_SCMPNE,
+	[JVM_IF_SCMPLT] = &&op_JVM_IF_SCMPLT,
+	[JVM_IF_SCMPGE] = &&op_JVM_IF_SCMPGE,
+	[JVM_IF_SCMPGT] = &&op_JVM_IF_SCMPGT,
+	[JVM_IF_SCMPLE] = &&op_JVM_IF_SCMPLE,
+	[JVM_IIFEQ] = &&op_JVM_IIFEQ,
+	[JVM_IIFNE] = &&op_JVM_IIFNE,
+	[JVM_IIFLT] = &&op_JVM_IIFLT,
+	[JVM_IIFGE] = &&op_JVM_IIFGE,
+	[JVM_IIFGT] = &&op_JVM_IIFGT,
+	[JVM_IIFLE] = &&op_JVM_IIFLE,
+	[JVM_SIFEQ] = &&op_JVM_SIFEQ,
+	[JVM_SIFNE] = &&op_JVM_SIFNE,
+	[JVM_SIFLT] = &&op_JVM_SIFLT,
+	[JVM_SIFGE] = &&op_JVM_SIFGE,
+	[JVM_SIFGT] = &&op_JVM_SIFGT,
+	[JVM_SIFLE] = &&op_JVM_SIFLE,
+	[JVM_IF_ACMPEQ] = &&op_JVM_IF_ACMPEQ,
+	[JVM_IF_ACMPNE] = &&op_JVM_IF_ACMPNE,
+	[JVM_IFNULL] = &&op_JVM_IFNULL,
+	[JVM_IFNONNULL] = &&op_JVM_IFNONNULL,
+	[JVM_RETURN] = &&op_JVM_RETURN,
+	[JVM_SRETURN] = &&op_JVM_SRETURN,
+	[JVM_IRETURN] = &&op_JVM_IRETURN,
+	[JVM_LRETURN] = &&op_JVM_LRETURN,
+	[JVM_ARETURN] = &&op_JVM_ARETURN,
+	[JVM_INVOKESTATIC] = &&op_JVM_INVOKESTATIC,
+	[JVM_INVOKESPECIAL] = &&op_JVM_INVOKESPECIAL,
+	[JVM_INVOKEVIRTUAL] = &&op_JVM_INVOKEVIRTUAL,
+	[JVM_INVOKEINTERFACE] = &&op_JVM_INVOKEINTERFACE,
+	[JVM_MONITORENTER] = &&op_JVM_MONITORENTER,
+	[JVM_MONITOREXIT] = &&op_JVM_MONITOREXIT,
+	[JVM_NEW] = &&op_JVM_NEW,
+	[JVM_INSTANCEOF] = &&op_JVM_INSTANCEOF,
+	[JVM_CHECKCAST] = &&op_JVM_CHECKCAST,
+	[JVM_NEWARRAY] = &&op_JVM_NEWARRAY,
+	[JVM_ANEWARRAY] = &&op_JVM_ANEWARRAY,
+	[JVM_ARRAYLENGTH] = &&op_JVM_ARRAYLENGTH,
+	[JVM_BASTORE] = &&op_JVM_BASTORE,
+	[JVM_CASTORE] = &&op_JVM_CASTORE,
+	[JVM_SASTORE] = &&op_JVM_SASTORE,
+	[JVM_IASTORE] = &&op_JVM_IASTORE,
+	[JVM_LASTORE] = &&op_JVM_LASTORE,
+	[JVM_AASTORE] = &&op_JVM_AASTORE,
+	[JVM_BALOAD] = &&op_JVM_BALOAD,
+	[JVM_CALOAD] = &&op_JVM_CALOAD,
+	[JVM_SALOAD] = &&op_JVM_SALOAD,
+	[JVM_IALOAD] = &&op_JVM_IALOAD,
+	[JVM_LALOAD] = &&op_JVM_LALOAD,
+	[JVM_AALOAD] = &&op_JVM_AALOAD,
+	[JVM_GETSTATIC_B] = &&op_JVM_GETSTATIC_B,
+	[JVM_GETSTATIC_C] = &&op_JVM_GETSTATIC_C,
+	[JVM_GETSTATIC_S] = &&op_JVM_GETSTATIC_S,
+	[JVM_GETSTATIC_I] = &&op_JVM_GETSTATIC_I,
+	[JVM_GETSTATIC_L] = &&op_JVM_GETSTATIC_L,
+	[JVM_GETSTATIC_A] = &&op_JVM_GETSTATIC_A,
+	[JVM_PUTSTATIC_B] = &&op_JVM_PUTSTATIC_B,
+	[JVM_PUTSTATIC_C] = &&op_JVM_PUTSTATIC_C,
+	[JVM_PUTSTATIC_S] = &&op_JVM_PUTSTATIC_S,
+	[JVM_PUTSTATIC_I] = &&op_JVM_PUTSTATIC_I,
+	[JVM_PUTSTATIC_L] = &&op_JVM_PUTSTATIC_L,
+	[JVM_PUTSTATIC_A] = &&op_JVM_PUTSTATIC_A,
+	[JVM_GETFIELD_B] = &&op_JVM_GETFIELD_B,
+	[JVM_GETFIELD_C] = &&op_JVM_GETFIELD_C,
+	[JVM_GETFIELD_S] = &&op_JVM_GETFIELD_S,
+	[JVM_GETFIELD_I] = &&op_JVM_GETFIELD_I,
+	[JVM_GETFIELD_L] = &&op_JVM_GETFIELD_L,
+	[JVM_GETFIELD_A] = &&op_JVM_GETFIELD_A,
+	[JVM_PUTFIELD_B] = &&op_JVM_PUTFIELD_B,
+	[JVM_PUTFIELD_C] = &&op_JVM_PUTFIELD_C,
+	[JVM_PUTFIELD_S] = &&op_JVM_PUTFIELD_S,
+	[JVM_PUTFIELD_I] = &&op_JVM_PUTFIELD_I,
+	[JVM_PUTFIELD_L] = &&op_JVM_PUTFIELD_L,
+	[JVM_PUTFIELD_A] = &&op_JVM_PUTFIELD_A,
+	[JVM_TABLESWITCH] = &&op_JVM_TABLESWITCH,
+	[JVM_LOOKUPSWITCH] = &&op_JVM_LOOKUPSWITCH,
+	[JVM_ATHROW] = &&op_JVM_ATHROW,
+	[JVM_LCMP] = &&op_JVM_LCMP,
+	[JVM_NOP] = &&op_JVM_NOP,
+#ifdef EXECUTION_SUPERINSTRUCTIONS
+	[JVM_SLOAD_SIFEQ] = &&op_JVM_SLOAD_SIFEQ,
+	[JVM_SLOAD_SIFNE] = &&op_JVM_SLOAD_SIFNE,
+	[JVM_ILOAD_IIFEQ] = &&op_JVM_ILOAD_IIFEQ,
+	[JVM_ILOAD_IIFNE] = &&op_JVM_ILOAD_IIFNE,
+	[JVM_ALOAD_0_GETFIELD_B] = &&op_JVM_ALOAD_0_GETFIELD_B,
+	[JVM_ALOAD_0_GETFIELD_S] = &&op_JVM_ALOAD_0_GETFIELD_S,
+	[JVM_ALOAD_0_GETFIELD_I] = &&op_JVM_ALOAD_0_GETFIELD_I,
+	[JVM_ALOAD_0_GETFIELD_A] = &&op_JVM_ALOAD_0_GETFIELD_A,
+#endif
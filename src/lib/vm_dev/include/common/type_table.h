@@ -0,0 +1,103 @@
+/*
+ * type_table.h
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __type_table__
+#define __type_table__
+
+#include "types.h"
+#include "heap.h"
+
+#include "config.h"
+
+#ifdef VM_TYPE_DISPLAYS
+
+void dj_type_table_build(dj_vm *vm);
+
+static inline uint8_t * dj_type_table_getDisplays(dj_type_table *typeTable)
+{
+	return (uint8_t*)((size_t)typeTable + sizeof(dj_type_table) + typeTable->nr_classes * sizeof(dj_type_table_entry));
+}
+
+static inline uint8_t * dj_type_table_getBitsets(dj_type_table *typeTable)
+{
+	return dj_type_table_getDisplays(typeTable) + typeTable->display_size;
+}
+
+/**
+ * Checks whether a runtime class id is described by the type table. Classes of an infusion that is being loaded
+ * are not, until the table has been rebuilt.
+ * @param typeTable the type table
+ * @param classId a runtime class id
+ */
+static inline char dj_type_table_contains(dj_type_table *typeTable, runtime_id_t classId)
+{
+	return (classId>=CHUNKID_JAVA_START) && (classId<CHUNKID_JAVA_START + typeTable->nr_classes);
+}
+
+/**
+ * Tests if a class is equal to, or a subclass of another class by checking the display of the child at the depth of
+ * the parent.
+ * @param typeTable the type table
+ * @param child runtime class id of the child class
+ * @param parent runtime class id of the parent class
+ */
+static inline char dj_type_table_isEqualToOrChildOf(dj_type_table *typeTable, runtime_id_t child, runtime_id_t parent)
+{
+	dj_type_table_entry *childEntry = &typeTable->entries[child - CHUNKID_JAVA_START];
+	uint8_t parentDepth = typeTable->entries[parent - CHUNKID_JAVA_START].depth;
+
+	return (parentDepth<=childEntry->depth)
+		&& (dj_type_table_getDisplays(typeTable)[childEntry->display + parentDepth]==parent - CHUNKID_JAVA_START);
+}
+
+/**
+ * Tests if a class, or one of its superclasses, implements an interface.
+ * @param typeTable the type table
+ * @param class runtime class id of the class
+ * @param interface runtime class id of the interface
+ */
+static inline char dj_type_table_implements(dj_type_table *typeTable, runtime_id_t class, runtime_id_t interface)
+{
+	uint8_t index = typeTable->entries[interface - CHUNKID_JAVA_START].interface_index;
+	uint8_t *bitset;
+
+	if (index==0xff)
+		return 0;
+
+	bitset = dj_type_table_getBitsets(typeTable) + (class - CHUNKID_JAVA_START) * typeTable->bitset_size;
+	return (bitset[index>>3] & (1<<(index&7)))!=0;
+}
+
+/**
+ * Tests if a class is of the given type, as in dj_global_id_testClassType.
+ * @param typeTable the type table
+ * @param refClass runtime class id of the class to test
+ * @param testType runtime class id of the class or interface to test against
+ */
+static inline char dj_type_table_testClassType(dj_type_table *typeTable, runtime_id_t refClass, runtime_id_t testType)
+{
+	return dj_type_table_isEqualToOrChildOf(typeTable, refClass, testType)
+		|| dj_type_table_implements(typeTable, refClass, testType);
+}
+
+#endif
+
+#endif
@@ -50,14 +50,18 @@ dj_infusion* dj_vm_runClassInitialisers(dj_vm * vm, dj_infusion * infusion);
 void dj_vm_addThread(dj_vm * vm, dj_thread * thread);
 int dj_vm_countThreads(dj_vm * vm);
 int dj_vm_countLiveThreads(dj_vm * vm);
+bool dj_vm_hasLiveThreads(dj_vm * vm);
 void dj_vm_checkFinishedThreads(dj_vm * vm);
-void dj_vm_notify(dj_vm *vm, dj_object *object, bool all);
+bool dj_vm_notify(dj_vm *vm, dj_object *object, bool all);
 dj_thread *dj_vm_getThread(dj_vm * vm, int index);
 dj_thread *dj_vm_getThreadById(dj_vm * vm, int id);
 void dj_vm_removeThread(dj_vm * vm, dj_thread * thread);
+void dj_vm_unscheduleThread(dj_vm * vm, dj_thread * thread);
+void dj_vm_wakeThreads(dj_vm * vm);
 char dj_vm_activateThread(dj_vm * vm, dj_thread * selectedThread);
 dj_time_t dj_vm_getVMSleepTime(dj_vm * vm);
 
+dj_monitor * dj_vm_findMonitor(dj_vm * vm, dj_object * object);
 dj_monitor * dj_vm_getMonitor(dj_vm * vm, dj_object * object);
 void dj_vm_removeMonitor(dj_vm * vm, dj_monitor * monitor);
 void dj_monitor_updatePointers(dj_monitor * monitor);
@@ -69,6 +73,8 @@ char dj_vm_schedule(dj_vm * vm);
 
 dj_di_pointer dj_vm_getRuntimeClassDefinition(dj_vm * vm, runtime_id_t id);
 dj_global_id dj_vm_getRuntimeClass(dj_vm * vm, runtime_id_t id);
+void dj_vm_buildClassTable(dj_vm *vm);
+void dj_vm_classTable_updatePointers(dj_class_table *classTable);
 
 uint8_t dj_vm_getSysLibClassRuntimeId(dj_vm * vm, uint8_t entity_id);
 dj_object * dj_vm_createSysLibObject(dj_vm * vm, uint8_t entity_id);
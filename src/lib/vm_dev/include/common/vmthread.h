@@ -51,31 +51,65 @@ void dj_thread_pushFrame(dj_thread *thread, dj_frame *frame);
 dj_frame *dj_thread_popFrame(dj_thread *thread);
 char dj_thread_scanRootSetForRef(dj_thread *thread, ref_t ref);
 void dj_thread_sleep(dj_thread *thread, dj_time_t time);
-void dj_thread_wait(dj_thread * thread, dj_object * object, dj_time_t time);
+bool dj_thread_wait(dj_thread * thread, dj_object * object, dj_time_t time);
 
 void dj_thread_markRootSet(dj_thread *thread);
 void dj_frame_updatePointers(dj_frame *frame);
 void dj_thread_updatePointers(dj_thread *thread);
 
 dj_frame *dj_frame_create(dj_global_id methodImpl);
+dj_frame *dj_thread_createFrame(dj_thread *thread, dj_global_id methodImplId);
+
+dj_monitor_table * dj_monitor_table_create(uint16_t capacity);
+void dj_monitor_table_insert(dj_monitor_table * table, dj_monitor * monitor);
+void dj_monitor_table_updatePointers(dj_monitor_table * table);
+void dj_monitor_markRootSet(dj_monitor_table * table);
+
+// Home slot of a lock object in the monitor table. Objects are at least 2-byte aligned, so the lowest bit of the
+// reference is dropped before it is scrambled with a multiplicative hash.
+#define dj_monitor_table_hash(table, object) \
+	((uint16_t)(((uint32_t)(VOIDP_TO_REF(object) >> 1) * 40503u) >> 3) & ((table)->capacity - 1))
+
+// The method implementation and the layout offsets are cached in the frame header when the frame is created,
+// so these don't have to read the method header from program memory.
+#define dj_frame_getMethodImplementation(frame) ((frame)->methodImplementation)
+#define dj_frame_getNrLocalReferences(frame) (((frame)->local_int_offset - (frame)->local_ref_offset) / sizeof(ref_t))
+
+// Slots of the integer operand stack and local variables. The infuser counts them in 16-bit units, so an int takes two
+// slots and a long four. With EXECUTION_32BIT_SLOTS the infusions are built with -slotwidth=32 instead: an int takes
+// one slot and a long two, and both are 32-bit aligned in the frame.
+#ifdef EXECUTION_32BIT_SLOTS
+typedef int32_t dj_int_slot;
+#else
+typedef int16_t dj_int_slot;
+#endif
+
+// Number of integer slots taken by an int and a long value
+#define DJ_INT_SLOTS (sizeof(int32_t) / sizeof(dj_int_slot))
+#define DJ_LONG_SLOTS (sizeof(int64_t) / sizeof(dj_int_slot))
 
-dj_monitor_block * dj_monitor_block_create();
-void dj_monitor_block_updatePointers(dj_monitor_block * monitor_block);
-void dj_monitor_markRootSet(dj_monitor_block * monitor_block);
+// A reference takes one operand stack slot too, so a slot has to be as wide as a ref_t when references are 32 bits
+// (HEAP_32BIT).
+#define DJ_FRAME_STACK_SLOT_SIZE (sizeof(ref_t)>sizeof(dj_int_slot) ? sizeof(ref_t) : sizeof(dj_int_slot))
 
 #define dj_frame_stackStartOffset(frame) ((char*)frame + sizeof(dj_frame))
-#define dj_frame_stackEndOffset(frame) (dj_frame_stackStartOffset(frame) + (sizeof(int16_t) * dj_di_methodImplementation_getMaxStack(dj_global_id_getMethodImplementation(frame->method))))
-#define dj_frame_stackLocalIntegerOffset(frame) (dj_frame_stackEndOffset(frame) + (sizeof(ref_t) * dj_di_methodImplementation_getReferenceLocalVariableCount(dj_global_id_getMethodImplementation(frame->method))))
+#define dj_frame_stackEndOffset(frame) ((char*)frame + (frame)->local_ref_offset)
+#define dj_frame_stackLocalIntegerOffset(frame) ((char*)frame + (frame)->local_int_offset)
 
 #define dj_frame_getStackStart(frame) ((void*)dj_frame_stackStartOffset(frame))
 #define dj_frame_getStackEnd(frame) ((void*)dj_frame_stackEndOffset(frame))
 
 #define dj_frame_getReferenceStack(frame) ((ref_t*)(dj_frame_stackEndOffset(frame) - frame->nr_ref_stack * sizeof(ref_t)))
-#define dj_frame_getIntegerStack(frame) ((int16_t*)(dj_frame_stackStartOffset(frame) + frame->nr_int_stack * sizeof(int16_t)))
+#define dj_frame_getIntegerStack(frame) ((dj_int_slot*)(dj_frame_stackStartOffset(frame) + frame->nr_int_stack * sizeof(dj_int_slot)))
 
 #define dj_frame_getLocalReferenceVariables(frame) ((ref_t*)(dj_frame_stackEndOffset(frame)))
-#define dj_frame_getLocalIntegerVariables(frame) ((int16_t*)(dj_frame_stackLocalIntegerOffset(frame)))
+#define dj_frame_getLocalIntegerVariables(frame) ((dj_int_slot*)(dj_frame_stackLocalIntegerOffset(frame)))
 
+#ifdef THREAD_FRAME_STACK
+// frames are popped off the thread's frame segment, there's nothing to free
+#define dj_frame_destroy(frame) ((void)(frame))
+#else
 #define dj_frame_destroy(frame) dj_mem_free(frame)
+#endif
 
 #endif
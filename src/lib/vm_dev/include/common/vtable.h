@@ -0,0 +1,47 @@
+/*
+ * vtable.h
+ * 
+ * Copyright (c) 2008-2010 CSIRO, Delft University of Technology.
+ * 
+ * This file is part of Darjeeling.
+ * 
+ * Darjeeling is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Darjeeling is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Darjeeling.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __vtable__
+#define __vtable__
+
+#include "types.h"
+
+#include "config.h"
+
+#ifdef VM_FLATTENED_VTABLES
+
+void dj_vtables_build(dj_vm *vm);
+dj_global_id dj_vtables_lookup(dj_vtables *vtables, dj_global_id resolvedMethodDefId, runtime_id_t classId);
+void dj_vtables_updatePointers(dj_vtables *vtables);
+
+static inline uint16_t * dj_vtables_getIndex(dj_vtables *vtables)
+{
+	return (uint16_t*)((size_t)vtables + sizeof(dj_vtables) + vtables->nr_infusions * sizeof(dj_infusion*));
+}
+
+static inline dj_vtable_entry * dj_vtables_getEntries(dj_vtables *vtables)
+{
+	return (dj_vtable_entry*)(dj_vtables_getIndex(vtables) + vtables->nr_classes + 1);
+}
+
+#endif
+
+#endif
@@ -7,6 +7,13 @@
 #include "config.h"
 #include "wkcomm.h"
 
+#ifdef DJ_MULTI_VM
+// Only the state of routing_none and the network server radio is kept per VM
+#if !defined(ROUTING_USE_NONE) || defined(RADIO_USE_ZWAVE) || defined(RADIO_USE_XBEE) || defined(RADIO_USE_WIFI)
+#error DJ_MULTI_VM requires ROUTING_USE_NONE and RADIO_USE_NETWORKSERVER
+#endif
+#endif
+
 extern void routing_init(void);
 
 // This will be frequently called by Darjeeling to receive messages
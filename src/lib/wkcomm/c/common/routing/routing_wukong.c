@@ -9,6 +9,7 @@
 #include "../../../../wkpf/include/common/wkpf_config.h"
 #include "../wkcomm.h"
 #include "djtimer.h"
+#include "core.h"
 
 
 #define NETWORK_MAX_SIZE                 10
@@ -444,6 +445,7 @@ void routing_poll() {
         period_update();
         check_time = dj_timer_getTimeMillis()+RT_PERIOD_CHECK;
     }
+    dj_core_requestWakeup(check_time + 1);
 #ifdef RADIO_USE_ZWAVE
     radio_zwave_poll();
 #endif
@@ -3,25 +3,23 @@
 #include "debug.h"
 #include "config.h"
 #include "hooks.h"
+#include "core.h"
 #include "djtimer.h"
 
 #include "routing/routing.h"
 #include "wkcomm.h"
 
-// Periodically call wkcomm_poll to receive messages
-dj_hook wkcomm_pollingHook;
-
 // Keep track of sequence numbers
-uint16_t wkcomm_last_seqnr = 0;
+DJ_VM_LOCAL uint16_t wkcomm_last_seqnr = 0;
 
 // Some variables to wait for a reply
-uint8_t *wkcomm_wait_reply_commands;
-uint8_t wkcomm_wait_reply_number_of_commands;
-uint16_t wkcomm_wait_reply_seqnr;
-wkcomm_received_msg wkcomm_received_reply;
+DJ_VM_LOCAL uint8_t *wkcomm_wait_reply_commands;
+DJ_VM_LOCAL uint8_t wkcomm_wait_reply_number_of_commands;
+DJ_VM_LOCAL uint16_t wkcomm_wait_reply_seqnr;
+DJ_VM_LOCAL wkcomm_received_msg wkcomm_received_reply;
 
 // To allow other libraries to listen to received messages
-dj_hook *wkcomm_handle_message_hook = NULL;
+DJ_VM_LOCAL dj_hook *wkcomm_handle_message_hook = NULL;
 
 // Send length bytes to dest
 int wkcomm_send_raw(wkcomm_address_t dest, uint8_t *payload, uint8_t length) {
@@ -77,6 +75,10 @@ int wkcomm_send_and_wait_for_reply(wkcomm_address_t dest, uint8_t command, uint8
 			wkcomm_wait_reply_number_of_commands = 0;
 			return WKCOMM_SEND_OK;
 		}
+		// Sleep until a message arrives or the deadline passes
+		dj_time_t now = dj_timer_getTimeMillis();
+		if (deadline > now)
+			dj_core_idle(deadline - now);
 	} while(deadline > dj_timer_getTimeMillis());
 	return WKCOMM_SEND_ERR_NO_REPLY;
 }
@@ -3,7 +3,7 @@
 #include "wkcomm.h"
 #include "routing/routing.h"
 
-dj_hook wkcomm_pollingHook;
+DJ_VM_LOCAL dj_hook wkcomm_pollingHook;
 
 void wkcomm_init() {
 	wkcomm_pollingHook.function = wkcomm_poll;
@@ -15,6 +15,7 @@
 #include "djtimer.h"
 #include "radio_networkserver.h"
 #include "posix_utils.h"
+#include "posix_poll.h"
 
 // Here we have a circular dependency between radio_X and routing.
 // Bit of a code smell, but since the two are supposed to be used together I'm leaving it like this for now.
@@ -27,12 +28,12 @@
 #define MODE_MESSAGE 1
 #define MODE_DISCOVERY 2
 
-bool radio_networkserver_connected = false;
-int radio_networkserver_sockfd;
-uint8_t radio_networkserver_receive_buffer[WKCOMM_MESSAGE_PAYLOAD_SIZE+11]; // 8 for local network overhead, 3 for wkcomm overhead
-dj_hook radio_networkserver_shutdownHook;
+DJ_VM_LOCAL bool radio_networkserver_connected = false;
+DJ_VM_LOCAL int radio_networkserver_sockfd;
+DJ_VM_LOCAL uint8_t radio_networkserver_receive_buffer[WKCOMM_MESSAGE_PAYLOAD_SIZE+11]; // 8 for local network overhead, 3 for wkcomm overhead
+DJ_VM_LOCAL dj_hook radio_networkserver_shutdownHook;
 
-dj_time_t radio_networkserver_last_heartbeat = 0;
+DJ_VM_LOCAL dj_time_t radio_networkserver_last_heartbeat = 0;
 
 void open_connection() {
 	fprintf(stderr, "Opening connection to network server\n");
@@ -74,10 +75,12 @@ void open_connection() {
 	}
 	fprintf(stderr, "CONNECTED\n");
 
+	posix_poll_register(radio_networkserver_sockfd);
 	radio_networkserver_connected = true;
 }
 
 void radio_networkserver_shutdown(void *data) {
+	posix_poll_unregister(radio_networkserver_sockfd);
 	close(radio_networkserver_sockfd);
 }
 
@@ -91,14 +94,6 @@ radio_networkserver_address_t radio_networkserver_get_node_id() {
 }
 
 void radio_networkserver_poll(void) {
-	// TMP CODE TO PREVENT THE BUSY LOOP FROM GOING TO 100% CPU LOAD
-	// THIS IS OBVIOUSLY NOT THE BEST WAY TO DO IT...
-	struct timespec tim, tim2;
-	tim.tv_sec = 0;
-	tim.tv_nsec = 1000000L; // 1 millisecond
-	nanosleep(&tim , &tim2);
-	// END TMP CODE
-
 	// fprintf(stderr, "poll %lld %lld\n", dj_timer_getTimeMillis(), radio_networkserver_last_heartbeat);
 	if ((dj_timer_getTimeMillis() - radio_networkserver_last_heartbeat) > 1000) {
 		radio_networkserver_last_heartbeat = dj_timer_getTimeMillis();
@@ -113,6 +108,8 @@ void radio_networkserver_poll(void) {
 			write(radio_networkserver_sockfd, send_buffer, 1);
 		}
 	}
+	// Make sure the idle loop wakes up in time for the next heartbeat
+	dj_core_requestWakeup(radio_networkserver_last_heartbeat + 1001);
 
 	uint8_t length;
 	int retval = recv(radio_networkserver_sockfd, &length, 1, MSG_DONTWAIT);
@@ -128,6 +125,7 @@ void radio_networkserver_poll(void) {
 		routing_handle_local_message(src, radio_networkserver_receive_buffer, length-9);
 	} else if (retval == 0) {
 		fprintf(stderr, "Connection to network server lost.\n");
+		posix_poll_unregister(radio_networkserver_sockfd);
 		close(radio_networkserver_sockfd);
 		radio_networkserver_connected = false;
 	}
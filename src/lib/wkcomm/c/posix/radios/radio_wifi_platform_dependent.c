@@ -20,6 +20,7 @@
 #include "djtimer.h"
 #include "../../common/routing/routing.h"
 #include "posix_utils.h"
+#include "posix_poll.h"
 #include "../../../../wkpf/include/common/wkpf_config.h"
 
 // Here we have a circular dependency between radio_X and routing.
@@ -52,6 +53,7 @@ uint8_t radio_wifi_receive_buffer[BUF_SIZE+1]; // 3 for wkcomm overhead
 dj_hook radio_wifi_shutdownHook;
 
 void radio_wifi_shutdown(void *data) {
+    posix_poll_unregister(radio_wifi_sockfd);
     close(radio_wifi_sockfd);
 }
 
@@ -154,6 +156,7 @@ void radio_wifi_platform_dependent_init(void) {
         return;
     }
     radio_wifi_sockfd = fd;
+    posix_poll_register(fd);
 
     if (posix_arg_addnode){
         radio_wifi_platform_dependent_gateway_discovery();
@@ -169,14 +172,6 @@ radio_wifi_address_t radio_wifi_platform_dependent_get_prefix_mask(){
 }
 
 void radio_wifi_platform_dependent_poll(void) {
-    // TMP CODE TO PREVENT THE BUSY LOOP FROM GOING TO 100% CPU LOAD
-    // THIS IS OBVIOUSLY NOT THE BEST WAY TO DO IT...
-    struct timespec tim, tim2;
-    tim.tv_sec = 0;
-    tim.tv_nsec = 1000000L; // 1 millisecond
-    nanosleep(&tim , &tim2);
-    // END TMP CODE
-
     struct sockaddr_in si_other;
     int slen = sizeof(si_other);
     int retval = recvfrom(radio_wifi_sockfd, radio_wifi_receive_buffer, BUF_SIZE, MSG_DONTWAIT, (struct sockaddr *) &si_other, (socklen_t *)&slen);
@@ -215,6 +210,8 @@ void radio_wifi_platform_dependent_poll(void) {
 
     if (posix_arg_addnode){
         radio_wifi_platform_dependent_gateway_discovery();
+        // Make sure the idle loop wakes up in time for the next discovery message
+        dj_core_requestWakeup(wifi_time_init + 501);
     }
 }
 
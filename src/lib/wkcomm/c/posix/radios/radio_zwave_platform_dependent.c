@@ -1,4 +1,5 @@
 #include "config.h" // To get RADIO_USE_ZWAVE
+#include "core.h"
 #include "djtimer.h"
 #include "posix_utils.h"
 
@@ -9,6 +10,11 @@ extern uint32_t zwave_time_btn_release;
 extern bool zwave_btn_is_push;
 extern bool zwave_btn_is_release;
 extern bool radio_zwave_my_address_loaded;
+extern bool zwave_learn_on;
+extern uint8_t zwave_mode;
+
+// How often to poll the radio while a timed action is pending, in milliseconds
+#define ZWAVE_TIMED_POLL_INTERVAL 100
 
 dj_time_t zwave_time_init = 0;
 
@@ -39,6 +45,11 @@ void radio_zwave_platform_dependent_poll(void) {
 			}
 		}
 	}
+
+	// The button presses above and the learn mode timeout are driven by time, not by data from the UART, so
+	// keep the main loop from sleeping in poll() until data arrives while any of them is pending.
+	if (posix_arg_addnode || zwave_btn_is_push || zwave_btn_is_release || zwave_learn_on || zwave_mode != 0)
+		dj_core_requestWakeup(dj_timer_getTimeMillis() + ZWAVE_TIMED_POLL_INTERVAL);
 }
 
 #endif // RADIO_USE_ZWAVE
\ No newline at end of file
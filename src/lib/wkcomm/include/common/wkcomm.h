@@ -34,7 +34,7 @@ typedef struct wkcomm_received_msg {
 } wkcomm_received_msg;
 
 // To allow other libraries to listen to received messages
-extern dj_hook *wkcomm_handle_message_hook;
+extern DJ_VM_LOCAL dj_hook *wkcomm_handle_message_hook;
 
 // Message handling. This function is called from the routing library, checks for replies we may be waiting for, or passes on the handling to one of the other libs.
 extern void wkcomm_handle_message(wkcomm_address_t addr, uint8_t *payload, uint8_t length);
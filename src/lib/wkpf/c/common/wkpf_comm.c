@@ -9,10 +9,13 @@
 #include "wkpf_wuclasses.h"
 #include "wkpf_wuobjects.h"
 #include "wkpf_properties.h"
+#include "wkpf_gc.h"
 
 #define SIZE_OF_COMPONENT_ID 2
 #define NUMBER_OF_WUCLASSES_PER_MESSAGE ((WKCOMM_MESSAGE_PAYLOAD_SIZE-3)/3)
 #define NUMBER_OF_WUOBJECTS_PER_MESSAGE ((WKCOMM_MESSAGE_PAYLOAD_SIZE-3)/4)
+// GC statistics are sent as 16 bit values, larger values (with HEAP_32BIT) are clamped
+#define WKPF_GC_STAT(x) ((x) > 0xffff ? 0xffff : (uint16_t)(x))
 
 
 uint8_t send_message(wkcomm_address_t dest_node_id, uint8_t command, uint8_t *payload, uint8_t length) {
@@ -696,6 +699,50 @@ void wkpf_comm_handle_message(void *data) {
 			response_size = 1;
 		}
 		break;
+		case WKPF_COMM_CMD_GET_GC_STATS: {
+			// Request format: payload[0] index of the requested collection, 0 being the most recent one
+			// Response format: payload[0..1] total number of collections since startup
+			// Response format: payload[2] number of collections for which statistics are kept
+			// Response format: payload[3..4] heap size
+			// Response format: payload[5..6] number of bytes currently free
+			// If statistics are kept for the requested collection:
+			// Response format: payload[7] index of the collection
+			// Response format: payload[8..21] pause (ms), bytes reclaimed, live bytes, live chunks, free bytes, largest free block, chunks moved
+			// Response format: payload[22] flags (1: heap was compacted, 2: incremental collection)
+			if (msg->length < 1) {
+				payload[0] = WKPF_ERR_MESSAGE_TOO_SHORT;
+				response_cmd = WKPF_COMM_CMD_ERROR_R;
+				response_size = 1;
+				break;
+			}
+			uint8_t index = payload[0];
+			uint16_t count = wkpf_get_gc_telemetry_size();
+			uint16_t total = wkpf_get_gc_telemetry_count();
+			uint16_t heap_size = WKPF_GC_STAT(dj_mem_getSize());
+			uint16_t free = WKPF_GC_STAT(dj_mem_getFree());
+			dj_mem_gc_info *info = wkpf_get_gc_telemetry(index);
+			payload[0] = (uint8_t)(total >> 8);
+			payload[1] = (uint8_t)(total);
+			payload[2] = (uint8_t)(count);
+			payload[3] = (uint8_t)(heap_size >> 8);
+			payload[4] = (uint8_t)(heap_size);
+			payload[5] = (uint8_t)(free >> 8);
+			payload[6] = (uint8_t)(free);
+			response_size = 7;
+			if (info != NULL) {
+				uint16_t values[] = { info->pause, WKPF_GC_STAT(info->reclaimed), WKPF_GC_STAT(info->live), WKPF_GC_STAT(info->nr_chunks),
+										WKPF_GC_STAT(info->free), WKPF_GC_STAT(info->largest_free), WKPF_GC_STAT(info->nr_moved) };
+				payload[7] = index;
+				for (int i=0; i<7; i++) {
+					payload[8+2*i] = (uint8_t)(values[i] >> 8);
+					payload[9+2*i] = (uint8_t)(values[i]);
+				}
+				payload[22] = info->flags;
+				response_size = 23;
+			}
+			response_cmd = WKPF_COMM_CMD_GET_GC_STATS_R;
+		}
+		break;
 	}
 	if (response_cmd != 0)
 		wkcomm_send_reply(msg, response_cmd, payload, response_size);
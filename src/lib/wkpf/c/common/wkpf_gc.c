@@ -2,9 +2,14 @@
 #include "debug.h"
 #include "wkpf_wuclasses.h"
 #include "wkpf_wuobjects.h"
+#include "wkpf_gc.h"
 
-extern wuclass_t *wuclasses_list;
-extern wuobject_t *wuobjects_list;
+extern DJ_VM_LOCAL wuclass_t *wuclasses_list;
+extern DJ_VM_LOCAL wuobject_t *wuobjects_list;
+
+// Ring buffer with the statistics of the last WKPF_GC_TELEMETRY_SIZE collections, which the master can retrieve using WKPF_COMM_CMD_GET_GC_STATS
+static DJ_VM_LOCAL dj_mem_gc_info wkpf_gc_telemetry[WKPF_GC_TELEMETRY_SIZE];
+static DJ_VM_LOCAL uint16_t wkpf_gc_telemetry_count = 0; // Total number of collections since startup
 
 void wkpf_markRootSet(void *data) {
 #ifdef DARJEELING_DEBUG
@@ -26,7 +31,7 @@ void wkpf_markRootSet(void *data) {
 	while (wuobject) {
 		dj_mem_setChunkColor(wuobject, TCM_BLACK);
 		if (wuobject->java_instance_reference)
-			dj_mem_setChunkColor(wuobject->java_instance_reference, TCM_GRAY);
+			dj_mem_setPointerGrayIfWhite(wuobject->java_instance_reference);
 		// WuObject also containts a pointer to the wuclass, but that's already been taken care of above.
 		wuobject = wuobject->next;
 	}
@@ -67,3 +72,30 @@ void wkpf_updatePointers(void *data) {
 		wuobject = next;
 	}
 }
+
+void wkpf_postGC(void *data) {
+	dj_mem_gc_info *info = (dj_mem_gc_info *)data;
+
+	// Called with NULL if the heap didn't provide any statistics
+	if (info == NULL)
+		return;
+
+	DEBUG_LOG(DBG_WKPFGC, "WKPF: (GC) Collection %d took %d ms, reclaimed %d bytes, moved %d chunks\n", wkpf_gc_telemetry_count, info->pause, info->reclaimed, info->nr_moved);
+	wkpf_gc_telemetry[wkpf_gc_telemetry_count % WKPF_GC_TELEMETRY_SIZE] = *info;
+	wkpf_gc_telemetry_count++;
+}
+
+dj_mem_gc_info *wkpf_get_gc_telemetry(uint8_t index) {
+	// Index 0 is the most recent collection
+	if (index >= wkpf_get_gc_telemetry_size())
+		return NULL;
+	return &wkpf_gc_telemetry[(uint16_t)(wkpf_gc_telemetry_count - 1 - index) % WKPF_GC_TELEMETRY_SIZE];
+}
+
+uint8_t wkpf_get_gc_telemetry_size() {
+	return wkpf_gc_telemetry_count < WKPF_GC_TELEMETRY_SIZE ? wkpf_gc_telemetry_count : WKPF_GC_TELEMETRY_SIZE;
+}
+
+uint16_t wkpf_get_gc_telemetry_count() {
+	return wkpf_gc_telemetry_count;
+}
@@ -11,9 +11,10 @@
 #endif
 // see issue 115 #include <avr/io.h>
 
-dj_hook wkpf_markRootSetHook;
-dj_hook wkpf_updatePointersHook;
-dj_hook wkpf_comm_handleMessageHook;
+DJ_VM_LOCAL dj_hook wkpf_markRootSetHook;
+DJ_VM_LOCAL dj_hook wkpf_updatePointersHook;
+DJ_VM_LOCAL dj_hook wkpf_postGCHook;
+DJ_VM_LOCAL dj_hook wkpf_comm_handleMessageHook;
 
 #define output_low(port, pin) port &= ~(1<<pin)
 #define output_high(port, pin) port |= (1<<pin)
@@ -40,6 +41,9 @@ void wkpf_init() {
 	wkpf_updatePointersHook.function = wkpf_updatePointers;
 	dj_hook_add(&dj_mem_updateReferenceHook, &wkpf_updatePointersHook);
 
+	wkpf_postGCHook.function = wkpf_postGC;
+	dj_hook_add(&dj_mem_postGCHook, &wkpf_postGCHook);
+
 	wkpf_comm_handleMessageHook.function = wkpf_comm_handle_message;
 	dj_hook_add(&wkcomm_handle_message_hook, &wkpf_comm_handleMessageHook);
 
@@ -16,20 +16,20 @@
 #define TOKEN_NO_COMPONENT 32767
 #define MAX_LINK_NUMBER 256
 
-dj_di_pointer wkpf_links_store = 0;
-dj_di_pointer wkpf_component_map_store = 0;
-uint16_t wkpf_number_of_links = 0; // To be set when we load the table
-uint16_t wkpf_number_of_components = 0; // To be set when we load the map
-bool stable_state =true;    //to be set after init value, reset to false when links change
+DJ_VM_LOCAL dj_di_pointer wkpf_links_store = 0;
+DJ_VM_LOCAL dj_di_pointer wkpf_component_map_store = 0;
+DJ_VM_LOCAL uint16_t wkpf_number_of_links = 0; // To be set when we load the table
+DJ_VM_LOCAL uint16_t wkpf_number_of_components = 0; // To be set when we load the map
+DJ_VM_LOCAL bool stable_state =true;    //to be set after init value, reset to false when links change
 
 //links may be changing, though components ids are changing, but the token is always passed down through the same link id
-uint16_t wkpf_token_id[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //locks identified by their initiator id
-uint16_t wkpf_token_setter_link[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //link id, from which the token is set
-uint16_t wkpf_token_dest_component[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //component to be locked
-uint16_t wkpf_token_src_component[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};    //locks are set by which upstream components, 0 means self
+DJ_VM_LOCAL uint16_t wkpf_token_id[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //locks identified by their initiator id
+DJ_VM_LOCAL uint16_t wkpf_token_setter_link[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //link id, from which the token is set
+DJ_VM_LOCAL uint16_t wkpf_token_dest_component[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};        //component to be locked
+DJ_VM_LOCAL uint16_t wkpf_token_src_component[WKPF_MAX_NUM_OF_TOKENS] = {TOKEN_NO_COMPONENT};    //locks are set by which upstream components, 0 means self
 
 // Link counter in memory
-uint16_t link_counter[MAX_LINK_NUMBER];
+DJ_VM_LOCAL uint16_t link_counter[MAX_LINK_NUMBER];
 
 // Link table format
 // 2 bytes: number of links
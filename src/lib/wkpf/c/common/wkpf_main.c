@@ -4,6 +4,7 @@
 #include "djarchive.h"
 #include "hooks.h"
 #include "core.h"
+#include "djtimer.h"
 #include "wkpf.h"
 #include "wkpf_wuobjects.h"
 #include "wkpf_links.h"
@@ -12,6 +13,10 @@
 #define platform_wdt_init()
 #define platform_wdt_reset()
 #endif
+
+// How long to wait before trying again when propagating a dirty property failed.
+#define WKPF_PROPAGATE_RETRY_MSEC 1
+
 void wkpf_initLinkTableAndComponentMap(dj_di_pointer archive) {
 	bool found_linktable = false, found_componentmap = false;
 	wkpf_init_token();
@@ -52,21 +57,34 @@ void wkpf_initLocalObjectAndInitValues(dj_di_pointer archive) {
 
 wuobject_t *wkpf_mainloop() {
 	wuobject_t *wuobject = NULL;
+	dj_time_t timeout;
 	platform_wdt_init();
 	while(true) {
 		// Process any incoming messages
 		platform_wdt_reset();
 		dj_hook_call(dj_core_pollingHook, NULL);
+		timeout = -1;
 		if (dj_exec_getRunlevel() == RUNLEVEL_RUNNING) {
 			// Propagate any dirty properties
-			wkpf_propagate_dirty_properties();
+			if (wkpf_propagate_dirty_properties() != WKPF_OK)
+				timeout = WKPF_PROPAGATE_RETRY_MSEC;
 			// Check if any wuobjects need updates
 			// Will call update() for native profiles directly,
 			// and return only true for virtual profiles requiring an update.
 			if(wkpf_get_next_wuobject_to_update(&wuobject)) {
 				return wuobject;
 			}
+			// Wait for the next scheduled update, or until a message arrives
+			dj_time_t next = wkpf_get_next_update_time();
+			if (next != -1) {
+				next -= dj_timer_getTimeMillis();
+				if (next < 0)
+					next = 0;
+				if (timeout == -1 || next < timeout)
+					timeout = next;
+			}
 		}
+		dj_core_idle(timeout);
 	}
 }
 
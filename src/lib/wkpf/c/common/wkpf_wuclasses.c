@@ -4,7 +4,7 @@
 #include "wkpf.h"
 #include "wkpf_wuclasses.h"
 
-wuclass_t *wuclasses_list = NULL;
+DJ_VM_LOCAL wuclass_t *wuclasses_list = NULL;
 
 void wkpf_register_wuclass(wuclass_t *wuclass) {
 	wuclass_t *dummy;
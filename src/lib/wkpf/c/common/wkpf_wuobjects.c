@@ -8,9 +8,9 @@
 #include "wkpf_properties.h"
 #include "wkpf_links.h"
 
-wuobject_t *wuobjects_list = NULL;
-uint16_t last_updated_wuobject_index = 0;
-uint16_t last_propagated_property_wuobject_index = 0;
+DJ_VM_LOCAL wuobject_t *wuobjects_list = NULL;
+DJ_VM_LOCAL uint16_t last_updated_wuobject_index = 0;
+DJ_VM_LOCAL uint16_t last_propagated_property_wuobject_index = 0;
 
 // Careful: this needs to match the IDs for the datatypes as defined in wkpf.h!
 // The size is 1 for the status byte, plus the size of the property, so for instance a 16bit short takes up 3 bytes.
@@ -238,6 +238,26 @@ void wkpf_schedule_next_update_for_wuobject(wuobject_t *wuobject) {
 	}
 }
 
+// Returns the time at which wkpf_mainloop next has something to do: the current time if a wuobject needs an update
+// or has a dirty property, the earliest scheduled update otherwise, or -1 if nothing is scheduled.
+dj_time_t wkpf_get_next_update_time() {
+	dj_time_t next = -1;
+	for (wuobject_t *wuobject = wuobjects_list; wuobject != NULL; wuobject = wuobject->next) {
+		if (wuobject->need_to_call_update)
+			return dj_timer_getTimeMillis();
+		uint8_t offset = 0;
+		for (int i=0; i<wuobject->wuclass->number_of_properties; i++) {
+			wuobject_property_t *property = (wuobject_property_t *)&(wuobject->properties_store[offset]);
+			if (wkpf_property_status_is_dirty(property->status))
+				return dj_timer_getTimeMillis();
+			offset += WKPF_GET_PROPERTY_DATASIZE(wuobject->wuclass->properties[i]);
+		}
+		if (wuobject->next_scheduled_update > 0 && (next == -1 || wuobject->next_scheduled_update < next))
+			next = wuobject->next_scheduled_update;
+	}
+	return next;
+}
+
 // This is here instead of in wkpf_properties so we can directly access the wuobjects list.
 bool wkpf_get_next_dirty_property(wuobject_t **dirty_wuobject, uint8_t *dirty_property_number) {
 	if (wuobjects_list == NULL)
@@ -16,8 +16,8 @@ typedef struct features_t {
 	wkcomm_address_t gwid;
 } features_t;
 
-features_t features;
-bool features_loaded = false;
+DJ_VM_LOCAL features_t features;
+DJ_VM_LOCAL bool features_loaded = false;
 
 #define CONFIG_FILE_LOCATION_STRING "Location (in raw bytes on the next line):\n"
 #define CONFIG_FILE_UUID_STRING "UUID: \n"
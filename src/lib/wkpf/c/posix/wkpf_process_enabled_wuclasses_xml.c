@@ -45,10 +45,10 @@ int wkpf_process_enabled_wuclasses_readfile (char* sFileName, char** psData, lon
 void* wkpf_process_enabled_wuclasses_handler (SimpleXmlParser parser, SimpleXmlEvent event, 
     const char* szName, const char* szAttribute, const char* szValue)
 {
-    static int next_free_port = 1;
-    static char wuclassname[1024];
-    static bool appCanCreateInstances;
-    static wuclass_t *wuclass;
+    static DJ_VM_LOCAL int next_free_port = 1;
+    static DJ_VM_LOCAL char wuclassname[1024];
+    static DJ_VM_LOCAL bool appCanCreateInstances;
+    static DJ_VM_LOCAL wuclass_t *wuclass;
 
     uint8_t retval;
 
@@ -40,6 +40,7 @@ typedef int16_t   wkpf_refresh_rate_t; // TODONR: should be changed later when I
 #define WKPF_ERR_LOCK_FAIL                                   21
 #define WKPF_ERR_UNLOCK_FAIL                                 22
 #define WKPF_LOCKED                                          23
+#define WKPF_ERR_MESSAGE_TOO_SHORT                           24
 #define WKPF_ERR_SHOULDNT_HAPPEN                           0xFF
 
 // Need to make sure these codes don't overlap with other libs or the definitions in panic.h
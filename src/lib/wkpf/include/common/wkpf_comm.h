@@ -66,6 +66,9 @@ extern void wkpf_comm_handle_message(void *msg); // Will be called with a pointe
 #define WUKONG_MONITOR_PROPERTY                   0xB5
 #define WUKONG_MONITOR_SERVER_ID				  1
 
+#define WKPF_COMM_CMD_GET_GC_STATS                0xB6
+#define WKPF_COMM_CMD_GET_GC_STATS_R              0xB7
+
 
 
 #define DEVICE_NATIVE_ZWAVE_SWITCH1 64
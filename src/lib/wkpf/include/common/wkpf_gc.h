@@ -1,7 +1,17 @@
 #ifndef WKPF_GCH
 #define WKPF_GCH
 
+#include "heap.h"
+
+// Number of collections for which the node keeps statistics
+#define WKPF_GC_TELEMETRY_SIZE 8
+
 extern void wkpf_markRootSet(void *data);
 extern void wkpf_updatePointers(void *data);
+extern void wkpf_postGC(void *data); // Will be called with a pointer to a dj_mem_gc_info
+
+extern dj_mem_gc_info *wkpf_get_gc_telemetry(uint8_t index); // Returns NULL if no statistics are kept for this collection
+extern uint8_t wkpf_get_gc_telemetry_size(); // Number of collections for which statistics are kept
+extern uint16_t wkpf_get_gc_telemetry_count(); // Total number of collections since startup
 
 #endif // WKPF_GCH
\ No newline at end of file
@@ -35,6 +35,7 @@ extern uint8_t wkpf_get_number_of_wuobjects();
 extern void wkpf_set_need_to_call_update_for_wuobject(wuobject_t *wuobject);
 extern bool wkpf_get_next_wuobject_to_update(wuobject_t **wuobject);
 extern void wkpf_schedule_next_update_for_wuobject(wuobject_t *wuobject);
+extern dj_time_t wkpf_get_next_update_time();
 
 // Access to the properties
 extern wuobject_property_t* wkpf_get_property(wuobject_t *wuobject, uint8_t property_number);
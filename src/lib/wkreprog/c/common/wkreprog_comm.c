@@ -6,7 +6,7 @@
 #include "wkreprog_comm.h"
 #include "wkreprog_impl.h"
 
-static uint16_t wkreprog_pos;
+static DJ_VM_LOCAL uint16_t wkreprog_pos;
 
 void wkreprog_comm_handle_message(void *data) {
 	wkcomm_received_msg *msg = (wkcomm_received_msg *)data;
@@ -3,7 +3,7 @@
 #include "wkcomm.h"
 #include "wkreprog_comm.h"
 
-dj_hook wkreprog_comm_handleMessageHook;
+DJ_VM_LOCAL dj_hook wkreprog_comm_handleMessageHook;
 
 void wkreprog_init() {
 	wkreprog_comm_handleMessageHook.function = wkreprog_comm_handle_message;
@@ -18,8 +18,8 @@
 // app_infusion.dja loaded in main memory. Writing to
 // this makes the changes immediately available to the
 // application.
-FILE *fp;
-void *in_memory_pointer;
+DJ_VM_LOCAL FILE *fp;
+DJ_VM_LOCAL void *in_memory_pointer;
 
 uint16_t wkreprog_impl_get_page_size() {
 	return 256;
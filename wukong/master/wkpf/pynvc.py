@@ -64,6 +64,8 @@ DEBUG_TRACE_PART             = 0xB0
 DEBUG_TRACE_FINAL            = 0xB2
 LOGGING                      = 0xB4
 MONITORING                   = 0xB5
+WKPF_GET_GC_STATS            = 0xB6
+WKPF_GET_GC_STATS_R          = 0xB7
 
 APPMSG_STATUS_WAIT_ACK       = 0x00
 APPMSG_STATUS_ACK            = 0x01
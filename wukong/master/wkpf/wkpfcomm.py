@@ -327,6 +327,35 @@ class Communication:
         return False
       return True
 
+    def getGCStats(self, destination, index=0):
+      # index 0 is the most recent collection, the node keeps statistics for the last few collections
+      print '[wkpfcomm] getGCStats', destination, index
+
+      reply = self.agent.send(destination, pynvc.WKPF_GET_GC_STATS, [index], [pynvc.WKPF_GET_GC_STATS_R, pynvc.WKPF_ERROR_R])
+
+      if reply == None:
+        return None
+
+      if reply.command == pynvc.WKPF_ERROR_R:
+        print "[wkpfcomm] WKPF RETURNED ERROR ", reply.payload
+        return None
+
+      payload = reply.payload[2:] # without the seq numbers
+      word = lambda offset: (payload[offset] << 8) + payload[offset+1]
+      stats = {'collections': word(0), 'records': payload[2], 'heap_size': word(3), 'free': word(5)}
+      if len(payload) >= 23:
+        stats['record'] = {'index': payload[7],
+                           'pause': word(8),
+                           'reclaimed': word(10),
+                           'live': word(12),
+                           'chunks': word(14),
+                           'free': word(16),
+                           'largest_free': word(18),
+                           'moved': word(20),
+                           'compacted': (payload[22] & 1) != 0,
+                           'incremental': (payload[22] & 2) != 0}
+      return stats
+
     def getWuClassList(self, destination):
       print '[wkpfcomm] getWuClassList'
 